@@ -0,0 +1,142 @@
+// Measures what batching saves on small tasks: one submit() per item
+// against submit_batched() and post_batched() with several batch sizes,
+// across several submitting threads. The hand-batched rows submit one
+// task per batch_size items gathered by the submitter itself, the floor
+// for what the collector costs. Each item adds its value to a shared sum.
+//
+//   batching_benchmark [items-per-thread] [submit-threads] [workers]
+
+#include "taskscheduler/thread_pool.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <thread>
+#include <vector>
+
+using namespace taskscheduler;
+
+namespace {
+
+constexpr TaskClassId BATCHED_CLASS = 1;
+
+enum class Mode {
+    UNBATCHED,     // One submit() per item
+    SUBMITTED,     // submit_batched(), a future per item
+    POSTED,        // post_batched(), no future
+    HAND_BATCHED   // One submit() per batch_size items, gathered by the caller
+};
+
+struct Result {
+    double total_ms;
+    double per_item_ns;
+    size_t batches;
+};
+
+Result run(Mode mode, size_t batch_size, size_t items_per_thread, size_t submit_threads, size_t workers) {
+    ThreadPool pool(workers);
+    std::atomic<uint64_t> sum{0};
+    std::atomic<size_t> batches{0};
+    if (mode == Mode::SUBMITTED || mode == Mode::POSTED) {
+        BatchOptions options;
+        options.max_items = batch_size;
+        options.max_delay = std::chrono::microseconds(100);
+        pool.register_batch_handler<uint64_t, void>(BATCHED_CLASS, options,
+                                                    [&sum, &batches](std::vector<uint64_t>& items) {
+            uint64_t batch_sum = 0;
+            for (uint64_t item : items) {
+                batch_sum += item;
+            }
+            sum.fetch_add(batch_sum, std::memory_order_relaxed);
+            batches.fetch_add(1, std::memory_order_relaxed);
+        });
+    }
+    pool.start();
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> submitters;
+    for (size_t t = 0; t < submit_threads; ++t) {
+        submitters.emplace_back([&pool, &sum, &batches, mode, batch_size, items_per_thread] {
+            std::vector<std::future<void>> futures;
+            futures.reserve(items_per_thread);
+            std::vector<uint64_t> gathered;
+            auto submit_gathered = [&] {
+                futures.push_back(pool.submit([&sum, &batches, items = std::move(gathered)] {
+                    uint64_t batch_sum = 0;
+                    for (uint64_t item : items) {
+                        batch_sum += item;
+                    }
+                    sum.fetch_add(batch_sum, std::memory_order_relaxed);
+                    batches.fetch_add(1, std::memory_order_relaxed);
+                }));
+                gathered = {};
+                gathered.reserve(batch_size);
+            };
+            gathered.reserve(batch_size);
+
+            for (uint64_t i = 0; i < items_per_thread; ++i) {
+                switch (mode) {
+                    case Mode::UNBATCHED:
+                        futures.push_back(pool.submit([&sum, i] { sum.fetch_add(i, std::memory_order_relaxed); }));
+                        break;
+                    case Mode::SUBMITTED:
+                        futures.push_back(pool.submit_batched<void>(BATCHED_CLASS, i));
+                        break;
+                    case Mode::POSTED:
+                        pool.post_batched<void>(BATCHED_CLASS, i);
+                        break;
+                    case Mode::HAND_BATCHED:
+                        gathered.push_back(i);
+                        if (gathered.size() >= batch_size) {
+                            submit_gathered();
+                        }
+                        break;
+                }
+            }
+            if (!gathered.empty()) {
+                submit_gathered();
+            }
+            for (auto& future : futures) {
+                future.wait();
+            }
+        });
+    }
+    for (auto& submitter : submitters) {
+        submitter.join();
+    }
+    if (mode == Mode::POSTED) {
+        pool.flush_batches();
+        pool.wait_idle();
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    pool.shutdown_graceful();
+
+    double items = static_cast<double>(items_per_thread * submit_threads);
+    return {elapsed.count(), elapsed.count() * 1e6 / items, batches.load()};
+}
+
+void report(const char* name, const Result& result) {
+    std::printf("%-16s %10.2f ms %10.1f ns/item %8zu batches\n",
+                name, result.total_ms, result.per_item_ns, result.batches);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t items_per_thread = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    size_t submit_threads = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 4;
+    size_t workers = (argc > 3) ? std::strtoul(argv[3], nullptr, 10) : 2;
+
+    report("unbatched", run(Mode::UNBATCHED, 1, items_per_thread, submit_threads, workers));
+    for (size_t batch_size : {8, 64, 512}) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "batches of %zu", batch_size);
+        report(name, run(Mode::SUBMITTED, batch_size, items_per_thread, submit_threads, workers));
+        std::snprintf(name, sizeof(name), "posted %zu", batch_size);
+        report(name, run(Mode::POSTED, batch_size, items_per_thread, submit_threads, workers));
+        std::snprintf(name, sizeof(name), "hand-batched %zu", batch_size);
+        report(name, run(Mode::HAND_BATCHED, batch_size, items_per_thread, submit_threads, workers));
+    }
+    return 0;
+}
@@ -0,0 +1,95 @@
+// Measures the cost of recording completions for tasks nobody depends on:
+// DependencyTracker::complete() called from several threads at once, and
+// independent no-op tasks submitted to and run by a pool, across worker
+// counts.
+//
+//   completion_benchmark [tasks-per-thread] [max-threads]
+
+#include "taskscheduler/dependency_tracker.hpp"
+#include "taskscheduler/thread_pool.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace taskscheduler;
+
+namespace {
+
+struct Result {
+    double total_ms;
+    double per_task_ns;
+};
+
+Result result_of(std::chrono::steady_clock::time_point start, size_t tasks) {
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return {elapsed.count(), elapsed.count() * 1e6 / static_cast<double>(tasks)};
+}
+
+// Each thread completes its own interleaved share of the ids
+Result run_complete(size_t tasks_per_thread, size_t threads) {
+    DependencyTracker tracker;
+    std::vector<TaskId> ids;
+    for (size_t i = 0; i < tasks_per_thread * threads; ++i) {
+        auto task = std::make_unique<Task>([]() {});
+        ids.push_back(tracker.assign_id(task));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> completers;
+    for (size_t t = 0; t < threads; ++t) {
+        completers.emplace_back([&tracker, &ids, t, threads] {
+            for (size_t i = t; i < ids.size(); i += threads) {
+                tracker.complete(ids[i]);
+            }
+        });
+    }
+    for (auto& completer : completers) {
+        completer.join();
+    }
+    return result_of(start, ids.size());
+}
+
+Result run_pool(size_t tasks_per_thread, size_t threads) {
+    ThreadPool pool(threads);
+    pool.start();
+    std::atomic<size_t> ran{0};
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> submitters;
+    for (size_t t = 0; t < threads; ++t) {
+        submitters.emplace_back([&pool, &ran, tasks_per_thread] {
+            for (size_t i = 0; i < tasks_per_thread; ++i) {
+                pool.submit([&ran]() { ran.fetch_add(1, std::memory_order_relaxed); });
+            }
+        });
+    }
+    for (auto& submitter : submitters) {
+        submitter.join();
+    }
+    pool.shutdown_graceful();
+    return result_of(start, ran.load());
+}
+
+void report(const char* name, size_t threads, const Result& result) {
+    std::printf("%-16s %2zu threads %10.2f ms %10.1f ns/task\n",
+                name, threads, result.total_ms, result.per_task_ns);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t tasks_per_thread = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 200000;
+    size_t max_threads = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 8;
+
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        report("tracker complete", threads, run_complete(tasks_per_thread, threads));
+    }
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        report("pool submit+run", threads, run_pool(tasks_per_thread / 4, threads));
+    }
+    return 0;
+}
@@ -0,0 +1,101 @@
+// Measures what the task journal adds to the submit path: plain
+// submit_registered() without a journal, with a journal that does not wait
+// for the fsync, and with one that waits for group commit, across several
+// submitting threads.
+//
+//   journal_benchmark [tasks-per-thread] [submit-threads] [journal-dir]
+
+#include "taskscheduler/thread_pool.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace taskscheduler;
+
+namespace {
+
+constexpr TaskTypeId NOOP_TASK = 1;
+
+struct Result {
+    double total_ms;
+    double per_submit_us;
+    size_t commits;
+};
+
+Result run(const TaskRegistry& registry, Journal* journal, size_t tasks_per_thread, size_t submit_threads) {
+    ThreadPool pool(2);
+    pool.set_task_registry(&registry);
+    if (journal != nullptr) {
+        pool.attach_journal(*journal);
+    }
+    pool.start();
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> submitters;
+    for (size_t t = 0; t < submit_threads; ++t) {
+        submitters.emplace_back([&pool, tasks_per_thread] {
+            TaskSpec spec;
+            spec.type = NOOP_TASK;
+            spec.arguments = std::string(64, 'x');
+            for (size_t i = 0; i < tasks_per_thread; ++i) {
+                pool.submit_registered(spec);
+            }
+        });
+    }
+    for (auto& submitter : submitters) {
+        submitter.join();
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    pool.shutdown_graceful();
+
+    double submits = static_cast<double>(tasks_per_thread * submit_threads);
+    return {elapsed.count(), elapsed.count() * 1000.0 / submits,
+            journal != nullptr ? journal->commit_count() : 0};
+}
+
+void report(const char* name, const Result& result) {
+    std::printf("%-22s %10.2f ms %10.3f us/submit %8zu fsyncs\n",
+                name, result.total_ms, result.per_submit_us, result.commits);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t tasks_per_thread = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 20000;
+    size_t submit_threads = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 4;
+    std::string directory = (argc > 3) ? argv[3] : "/tmp";
+    std::string path = directory + "/journal_benchmark." + std::to_string(::getpid()) + ".log";
+
+    TaskRegistry registry;
+    registry.register_type(NOOP_TASK, [](std::string_view) {});
+
+    report("no journal", run(registry, nullptr, tasks_per_thread, submit_threads));
+
+    {
+        JournalOptions options;
+        options.wait_for_commit = false;
+        Journal journal(options);
+        if (!journal.open(path)) {
+            std::fprintf(stderr, "cannot open journal %s\n", path.c_str());
+            return 1;
+        }
+        report("journal, no wait", run(registry, &journal, tasks_per_thread, submit_threads));
+    }
+    ::unlink(path.c_str());
+
+    {
+        // Fewer tasks: every submit waits for an fsync it shares with others
+        Journal journal;
+        if (!journal.open(path)) {
+            std::fprintf(stderr, "cannot open journal %s\n", path.c_str());
+            return 1;
+        }
+        report("journal, group commit", run(registry, &journal, tasks_per_thread / 10, submit_threads));
+    }
+    ::unlink(path.c_str());
+    return 0;
+}
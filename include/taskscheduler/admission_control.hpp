@@ -0,0 +1,72 @@
+#ifndef TASKSCHEDULER_ADMISSION_CONTROL_HPP
+#define TASKSCHEDULER_ADMISSION_CONTROL_HPP
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+
+namespace taskscheduler {
+
+enum class OverflowPolicy {
+    BLOCK = 0,                  // Submitter waits until capacity frees up
+    REJECT = 1,                 // Submission fails immediately
+    SHED_LOWEST_PRIORITY = 2    // Drop queued lower-priority work to make room
+};
+
+// Limits on work held by a pool, both queued and waiting on dependencies.
+// A limit of zero means unbounded.
+struct AdmissionLimits {
+    size_t max_pending_tasks = 0;
+    size_t max_pending_bytes = 0;
+    OverflowPolicy overflow_policy = OverflowPolicy::REJECT;
+};
+
+// Without limits, admitting and releasing a task only touches the pending
+// counters; the lock is taken by blocking submitters and by whoever wakes
+// them.
+class AdmissionController {
+public:
+    AdmissionController() = default;
+    ~AdmissionController() = default;
+
+    AdmissionController(const AdmissionController&) = delete;
+    AdmissionController& operator=(const AdmissionController&) = delete;
+
+    void set_limits(const AdmissionLimits& limits);
+    AdmissionLimits limits() const;
+
+    // Reserves room for one task of `bytes` if it fits within the limits.
+    bool try_acquire(size_t bytes);
+
+    // Blocks until room for one task of `bytes` is available. Returns false
+    // if the controller is closed while waiting.
+    bool acquire(size_t bytes);
+
+    // Returns the number of tasks still holding room afterwards.
+    size_t release(size_t bytes);
+    void close();
+
+    size_t pending_tasks() const;
+    size_t pending_bytes() const;
+
+private:
+    // Reserves room if it fits. `locked` tells whether the caller holds
+    // mutex_; only a lock-free reservation can hide room from a waiter.
+    bool reserve(size_t bytes, bool locked);
+    void wake_waiters();
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    AdmissionLimits limits_;
+    std::atomic<size_t> max_pending_tasks_{0};  // Copies of limits_ for reserve()
+    std::atomic<size_t> max_pending_bytes_{0};
+    std::atomic<size_t> pending_tasks_{0};
+    std::atomic<size_t> pending_bytes_{0};
+    std::atomic<size_t> waiters_{0};
+    std::atomic<bool> closed_{false};
+};
+
+} // namespace taskscheduler
+
+#endif // TASKSCHEDULER_ADMISSION_CONTROL_HPP
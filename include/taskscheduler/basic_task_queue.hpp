@@ -0,0 +1,123 @@
+#ifndef TASKSCHEDULER_BASIC_TASK_QUEUE_HPP
+#define TASKSCHEDULER_BASIC_TASK_QUEUE_HPP
+
+#include "task.hpp"
+#include "pool_policies.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <type_traits>
+#include <vector>
+
+namespace taskscheduler {
+
+/**
+ * Blocking task queue whose ordering is fixed at compile time by an
+ * Ordering policy (see pool_policies.hpp). FIFO queues are a plain deque;
+ * the others are a heap keyed only on what the policy compares.
+ *
+ * Unlike TaskQueue this supports no cancellation, re-keying or shedding.
+ */
+template<typename Ordering>
+class BasicTaskQueue {
+public:
+    BasicTaskQueue() = default;
+
+    BasicTaskQueue(const BasicTaskQueue&) = delete;
+    BasicTaskQueue& operator=(const BasicTaskQueue&) = delete;
+
+    // Returns false (leaving `task` untouched) if the queue is closed.
+    bool try_push(std::unique_ptr<Task>& task);
+
+    // Blocks until a task is available; returns nullptr once the queue is
+    // closed and empty.
+    std::unique_ptr<Task> pop();
+
+    size_t size() const { return size_.load(std::memory_order_relaxed); }
+    bool empty() const { return size() == 0; }
+    void close();
+    bool is_closed() const { return closed_.load(std::memory_order_acquire); }
+
+private:
+    struct Entry {
+        mutable std::unique_ptr<Task> task;
+        size_t sequence;
+
+        bool operator<(const Entry& other) const {
+            if (Ordering::precedes(*other.task, *task)) {
+                return true;
+            }
+            if (Ordering::precedes(*task, *other.task)) {
+                return false;
+            }
+            return sequence > other.sequence;  // FIFO for otherwise equal tasks
+        }
+    };
+
+    using Container = std::conditional_t<Ordering::FIFO,
+                                         std::deque<std::unique_ptr<Task>>,
+                                         std::priority_queue<Entry>>;
+
+    Container queue_;
+    size_t sequence_counter_ = 0;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::atomic<size_t> size_{0};
+    std::atomic<bool> closed_{false};
+};
+
+// Template implementation
+template<typename Ordering>
+bool BasicTaskQueue<Ordering>::try_push(std::unique_ptr<Task>& task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_) {
+            return false;
+        }
+        if constexpr (Ordering::FIFO) {
+            queue_.push_back(std::move(task));
+        } else {
+            queue_.push(Entry{std::move(task), sequence_counter_++});
+        }
+        size_.store(queue_.size(), std::memory_order_relaxed);
+    }
+    cv_.notify_one();
+    return true;
+}
+
+template<typename Ordering>
+std::unique_ptr<Task> BasicTaskQueue<Ordering>::pop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return !queue_.empty() || closed_; });
+
+    if (queue_.empty()) {
+        return nullptr;
+    }
+
+    std::unique_ptr<Task> task;
+    if constexpr (Ordering::FIFO) {
+        task = std::move(queue_.front());
+        queue_.pop_front();
+    } else {
+        task = std::move(queue_.top().task);
+        queue_.pop();
+    }
+    size_.store(queue_.size(), std::memory_order_relaxed);
+    return task;
+}
+
+template<typename Ordering>
+void BasicTaskQueue<Ordering>::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_.store(true, std::memory_order_release);
+    }
+    cv_.notify_all();
+}
+
+} // namespace taskscheduler
+
+#endif // TASKSCHEDULER_BASIC_TASK_QUEUE_HPP
@@ -0,0 +1,252 @@
+#ifndef TASKSCHEDULER_BASIC_THREAD_POOL_HPP
+#define TASKSCHEDULER_BASIC_THREAD_POOL_HPP
+
+#include "basic_task_queue.hpp"
+#include "pool_policies.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace taskscheduler {
+
+/**
+ * Thread pool whose ordering, dependency support and statistics are chosen
+ * at compile time (see pool_policies.hpp). Features a configuration does
+ * not select cost nothing: a FIFO pool never compares tasks, a pool without
+ * dependencies never touches a DependencyTracker, and a pool without timed
+ * statistics never reads the clock.
+ *
+ * ThreadPool remains the fully-featured pool; admission control, priority
+ * inheritance, cancellation and the shutdown variants exist only there.
+ * stop() drains queued work, and the dependents it releases, before joining
+ * the workers.
+ */
+template<typename Ordering = policy::PriorityOrder,
+         typename Dependencies = policy::WithDependencies,
+         typename StatisticsPolicy = policy::FullStatistics>
+class BasicThreadPool {
+public:
+    explicit BasicThreadPool(size_t num_threads = std::thread::hardware_concurrency());
+    ~BasicThreadPool();
+
+    BasicThreadPool(const BasicThreadPool&) = delete;
+    BasicThreadPool& operator=(const BasicThreadPool&) = delete;
+
+    void start();
+    void stop();
+
+    void submit(std::unique_ptr<Task> task);
+
+    // Returns INVALID_TASK_ID after stop(), if the task declares
+    // dependencies and the pool was built without them, or if it depends
+    // on an id the pool never assigned.
+    TaskId submit_with_id(std::unique_ptr<Task> task);
+
+    template<typename F, typename... Args>
+    auto submit(F&& f, Args&&... args) -> std::future<typename std::invoke_result<F, Args...>::type>;
+
+    size_t thread_count() const { return threads_.size(); }
+    size_t pending_tasks() const { return task_queue_.size(); }
+    bool is_running() const { return running_; }
+
+    // Fields the statistics policy does not track read as zero.
+    StatisticsSnapshot get_statistics() const;
+    void reset_statistics() { statistics_.reset(); }
+
+private:
+    void worker_loop();
+    void run_task(std::unique_ptr<Task> task);
+    void enqueue(std::unique_ptr<Task> task);
+
+    // Forgets a cancelled task and drops its waiting dependents.
+    void drop(TaskId id);
+
+    BasicTaskQueue<Ordering> task_queue_;
+    Dependencies dependencies_;
+    StatisticsPolicy statistics_;
+    std::vector<std::thread> threads_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> stopping_{false};
+    size_t num_threads_;
+
+    // Submitted tasks that have not finished, including those waiting on
+    // dependencies; stop() drains until only the latter remain.
+    std::atomic<size_t> outstanding_{0};
+    std::mutex drain_mutex_;
+    std::condition_variable drain_cv_;
+};
+
+// Template implementation
+template<typename O, typename D, typename S>
+BasicThreadPool<O, D, S>::BasicThreadPool(size_t num_threads) : num_threads_(num_threads) {
+    threads_.reserve(num_threads_);
+}
+
+template<typename O, typename D, typename S>
+BasicThreadPool<O, D, S>::~BasicThreadPool() {
+    stop();
+}
+
+template<typename O, typename D, typename S>
+void BasicThreadPool<O, D, S>::start() {
+    if (running_ || task_queue_.is_closed()) {
+        return;
+    }
+
+    running_ = true;
+    for (size_t i = 0; i < num_threads_; ++i) {
+        threads_.emplace_back(&BasicThreadPool::worker_loop, this);
+    }
+}
+
+template<typename O, typename D, typename S>
+void BasicThreadPool<O, D, S>::stop() {
+    if (!running_) {
+        return;
+    }
+
+    stopping_ = true;
+    {
+        // Whatever still waits on dependencies can no longer be released
+        std::unique_lock<std::mutex> lock(drain_mutex_);
+        drain_cv_.wait(lock, [this] {
+            return outstanding_.load() == dependencies_.pending_count();
+        });
+    }
+
+    running_ = false;
+    task_queue_.close();
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    threads_.clear();
+}
+
+template<typename O, typename D, typename S>
+void BasicThreadPool<O, D, S>::submit(std::unique_ptr<Task> task) {
+    submit_with_id(std::move(task));
+}
+
+template<typename O, typename D, typename S>
+TaskId BasicThreadPool<O, D, S>::submit_with_id(std::unique_ptr<Task> task) {
+    if (!running_) {
+        start();
+    }
+
+    if (stopping_ || task_queue_.is_closed()) {
+        return INVALID_TASK_ID;
+    }
+
+    if constexpr (!D::ENABLED) {
+        if (!task->dependency_list().empty()) {
+            return INVALID_TASK_ID;
+        }
+    }
+
+    TaskId task_id = dependencies_.assign_id(task);
+    outstanding_.fetch_add(1, std::memory_order_relaxed);
+    if (auto ready = dependencies_.admit(std::move(task))) {
+        if (ready->is_cancelled()) {
+            drop(task_id);
+            return INVALID_TASK_ID;
+        }
+        enqueue(std::move(ready));
+    }
+    return task_id;
+}
+
+template<typename O, typename D, typename S>
+template<typename F, typename... Args>
+auto BasicThreadPool<O, D, S>::submit(F&& f, Args&&... args)
+    -> std::future<typename std::invoke_result<F, Args...>::type> {
+    using return_type = typename std::invoke_result<F, Args...>::type;
+
+    auto task = std::make_shared<std::packaged_task<return_type()>>(
+        std::bind(std::forward<F>(f), std::forward<Args>(args)...)
+    );
+
+    std::future<return_type> result = task->get_future();
+    submit(std::make_unique<Task>([task]() { (*task)(); }));
+    return result;
+}
+
+template<typename O, typename D, typename S>
+StatisticsSnapshot BasicThreadPool<O, D, S>::get_statistics() const {
+    StatisticsSnapshot snapshot = statistics_.snapshot();
+    snapshot.queue_depth = task_queue_.size();
+    snapshot.pending_dependencies = dependencies_.pending_count();
+    return snapshot;
+}
+
+template<typename O, typename D, typename S>
+void BasicThreadPool<O, D, S>::enqueue(std::unique_ptr<Task> task) {
+    // The queue only closes after the drain, when nothing can be pushed
+    task_queue_.try_push(task);
+}
+
+template<typename O, typename D, typename S>
+void BasicThreadPool<O, D, S>::worker_loop() {
+    while (auto task = task_queue_.pop()) {
+        run_task(std::move(task));
+
+        if (stopping_) {
+            { std::lock_guard<std::mutex> lock(drain_mutex_); }
+            drain_cv_.notify_all();
+        }
+    }
+}
+
+template<typename O, typename D, typename S>
+void BasicThreadPool<O, D, S>::run_task(std::unique_ptr<Task> task) {
+    statistics_.task_started();
+    if constexpr (S::TIMED) {
+        auto start_time = std::chrono::steady_clock::now();
+        task->execute();
+        std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start_time;
+        statistics_.task_finished(duration.count());
+    } else {
+        task->execute();
+        statistics_.task_finished(0.0);
+    }
+
+    if constexpr (D::ENABLED) {
+        if (task->is_cancelled()) {
+            drop(task->id());
+            return;
+        }
+        for (auto& ready : dependencies_.complete(task->id())) {
+            enqueue(std::move(ready));
+        }
+    }
+
+    // Decremented after the dependents are queued, so stop() never sees
+    // the pool drained while they are in transit.
+    outstanding_.fetch_sub(1);
+}
+
+template<typename O, typename D, typename S>
+void BasicThreadPool<O, D, S>::drop(TaskId id) {
+    if constexpr (D::ENABLED) {
+        // The dependents of a task that does not run are skipped too
+        outstanding_.fetch_sub(1 + dependencies_.cancel_dependents(id).size());
+        if (stopping_) {
+            { std::lock_guard<std::mutex> lock(drain_mutex_); }
+            drain_cv_.notify_all();
+        }
+    }
+}
+
+// Convenience configurations
+using FifoThreadPool = BasicThreadPool<policy::FifoOrder, policy::NoDependencies, policy::NoStatistics>;
+using EdfThreadPool = BasicThreadPool<policy::EdfOrder, policy::WithDependencies, policy::FullStatistics>;
+
+} // namespace taskscheduler
+
+#endif // TASKSCHEDULER_BASIC_THREAD_POOL_HPP
@@ -0,0 +1,200 @@
+#ifndef TASKSCHEDULER_BATCHING_HPP
+#define TASKSCHEDULER_BATCHING_HPP
+
+#include "task.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace taskscheduler {
+
+struct BatchOptions {
+    // A batch runs as soon as it holds this many items...
+    size_t max_items = 64;
+
+    // ...or this long after its first item arrived. Zero runs it as soon as
+    // a worker picks it up, with whatever has arrived by then.
+    std::chrono::microseconds max_delay{100};
+
+    Priority priority = Priority::NORMAL;
+};
+
+/**
+ * Collects submitted items of one task class into batches that run as a
+ * single task. The typed collector below holds the items; this base lets
+ * the pool flush batches without knowing their types.
+ */
+class BatchCollector : public std::enable_shared_from_this<BatchCollector> {
+public:
+    // A closed batch
+    struct Taken {
+        std::unique_ptr<Task> task;      // Runs the batch; nullptr if there was none to take
+        TaskId timer = INVALID_TASK_ID;  // Its flush timer, if one was set
+    };
+
+    explicit BatchCollector(BatchOptions options) : options_(options) {}
+    virtual ~BatchCollector() = default;
+
+    BatchCollector(const BatchCollector&) = delete;
+    BatchCollector& operator=(const BatchCollector&) = delete;
+
+    const BatchOptions& options() const { return options_; }
+
+    // Closes the open batch and returns it. With `generation`, only if
+    // that batch is still open.
+    virtual Taken take(std::optional<uint64_t> generation = std::nullopt) = 0;
+
+    // Called with the item count of every batch that runs.
+    void set_observer(std::function<void(size_t)> observer) { observer_ = std::move(observer); }
+
+    // Records `timer` as the flush timer of batch `generation`, unless that
+    // batch has closed already; then returns false and the caller is left
+    // to cancel the timer.
+    bool set_timer(uint64_t generation, TaskId timer) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (generation != generation_) {
+            return false;
+        }
+        timer_ = timer;
+        return true;
+    }
+
+protected:
+    // Moves on from the open batch and returns its timer
+    TaskId close_locked() {
+        ++generation_;  // Stale timers for this batch find nothing to take
+        return std::exchange(timer_, INVALID_TASK_ID);
+    }
+
+    BatchOptions options_;
+    std::function<void(size_t)> observer_;
+    std::mutex mutex_;
+    uint64_t generation_ = 0;  // Of the open batch, while it has items
+
+private:
+    TaskId timer_ = INVALID_TASK_ID;
+};
+
+template<typename Item, typename Result>
+class TypedBatchCollector : public BatchCollector {
+public:
+    // Gets the items of one batch and returns one result per item, in order
+    using Handler = std::conditional_t<std::is_void_v<Result>,
+                                       std::function<void(std::vector<Item>&)>,
+                                       std::function<std::vector<Result>(std::vector<Item>&)>>;
+
+    struct Added {
+        std::future<Result> future;  // Invalid for items added without one
+        Taken full;                  // The batch, if this item filled it
+        uint64_t opened = 0;         // Generation of the batch, if this item opened it
+    };
+
+    TypedBatchCollector(BatchOptions options, Handler handler)
+        : BatchCollector(options), handler_(std::move(handler)) {
+        options_.max_items = std::max<size_t>(options_.max_items, 1);
+    }
+
+    // Adds `item` to the open batch. Without `with_future` nobody waits for
+    // its result, and the item costs no promise or future.
+    Added add(Item item, bool with_future = true) {
+        Added added;
+        std::optional<std::promise<Result>> promise;  // Allocated outside the lock
+        if (with_future) {
+            added.future = promise.emplace().get_future();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (open_.items.empty()) {
+            open_.items.reserve(options_.max_items);
+            added.opened = ++generation_;
+        }
+        if (with_future) {
+            open_.promises.emplace_back(open_.items.size(), std::move(*promise));
+        }
+        open_.items.push_back(std::move(item));
+
+        if (open_.items.size() >= options_.max_items) {
+            added.full = make_task_locked();
+            added.opened = 0;
+        }
+        return added;
+    }
+
+    Taken take(std::optional<uint64_t> generation) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (open_.items.empty() || (generation.has_value() && generation.value() != generation_)) {
+            return {};
+        }
+        return make_task_locked();
+    }
+
+private:
+    struct Pending {
+        std::vector<Item> items;
+        std::vector<std::pair<size_t, std::promise<Result>>> promises;  // By item index
+    };
+
+    Taken make_task_locked() {
+        auto pending = std::make_shared<Pending>(std::move(open_));
+        open_ = Pending{};
+        Taken taken;
+        taken.timer = close_locked();
+
+        size_t count = pending->items.size();
+        auto self = std::static_pointer_cast<TypedBatchCollector>(shared_from_this());
+        auto task = std::make_unique<Task>([self, pending]() { self->run(*pending); }, options_.priority);
+        task->set_payload_bytes(count * sizeof(Item) +
+                                pending->promises.size() * sizeof(std::promise<Result>));
+        taken.task = std::move(task);
+        return taken;
+    }
+
+    void run(Pending& pending) {
+        if (observer_) {
+            observer_(pending.items.size());
+        }
+        try {
+            if constexpr (std::is_void_v<Result>) {
+                handler_(pending.items);
+                for (auto& [index, promise] : pending.promises) {
+                    promise.set_value();
+                }
+            } else {
+                std::vector<Result> results = handler_(pending.items);
+                for (auto& [index, promise] : pending.promises) {
+                    if (index < results.size()) {
+                        promise.set_value(std::move(results[index]));
+                    } else {
+                        promise.set_exception(std::make_exception_ptr(
+                            std::length_error("batch handler returned too few results")));
+                    }
+                }
+            }
+        } catch (...) {
+            auto error = std::current_exception();
+            for (auto& [index, promise] : pending.promises) {
+                try {
+                    promise.set_exception(error);
+                } catch (const std::future_error&) {
+                    // Already satisfied before the handler threw
+                }
+            }
+        }
+    }
+
+    Handler handler_;
+    Pending open_;
+};
+
+} // namespace taskscheduler
+
+#endif // TASKSCHEDULER_BATCHING_HPP
@@ -0,0 +1,109 @@
+#ifndef TASKSCHEDULER_COMPLETION_SET_HPP
+#define TASKSCHEDULER_COMPLETION_SET_HPP
+
+#include "task_id.hpp"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <mutex>
+
+namespace taskscheduler {
+
+/**
+ * Set of finished task ids, sized by the ids still outstanding rather than
+ * by the number ever finished.
+ *
+ * Ids are handed out in increasing order and mostly finish close to that
+ * order, so the set keeps a watermark below which every id has finished,
+ * a bitmap page for each 4096-id block that is partly finished, and runs
+ * of fully finished blocks above the watermark. A block costs 512 bytes
+ * only while it holds an outstanding id; finished blocks collapse into
+ * runs and are dropped once the watermark passes them.
+ *
+ * The pages near the watermark sit in a fixed window of atomic bitmaps:
+ * inserting or looking up an id there sets or tests one bit without a
+ * lock. The internal lock is only taken once per filled page, to retire
+ * it and move the window on, and for ids beyond the window. A page that
+ * stays partly finished (a long-running task) holds on to its own slot
+ * only; ids of the pages sharing that slot go through the lock until it
+ * fills.
+ *
+ * Thread-safe. insert() and contains() are sequentially consistent with
+ * respect to each other, so one thread inserting and then checking a flag
+ * and another setting the flag and then looking up the id cannot both miss.
+ */
+class CompletionSet {
+public:
+    CompletionSet();
+
+    CompletionSet(const CompletionSet&) = delete;
+    CompletionSet& operator=(const CompletionSet&) = delete;
+
+    void insert(TaskId id);
+
+    // Inserts every id in [begin, end).
+    void insert_range(TaskId begin, TaskId end);
+
+    bool contains(TaskId id) const;
+
+    // Every id below this one has finished.
+    TaskId watermark() const;
+
+    // Bitmap pages currently held for partly finished blocks
+    size_t page_count() const;
+
+private:
+    static constexpr TaskId PAGE_BITS = 4096;
+    static constexpr size_t PAGE_WORDS = PAGE_BITS / 64;
+    static constexpr size_t WINDOW_PAGES = 16;
+    static constexpr TaskId RETIRING = std::numeric_limits<TaskId>::max();
+
+    struct Page {
+        std::array<uint64_t, PAGE_WORDS> words{};
+        size_t count = 0;
+    };
+
+    // A window page, reused for the next page number with the same slot
+    // once its own page has filled. Readers and writers announce themselves
+    // in `users` before checking `page`; the lock holder retagging the slot
+    // sets `page` to RETIRING and waits for them to leave.
+    struct alignas(64) Slot {
+        std::atomic<TaskId> page{RETIRING};
+        std::atomic<uint32_t> users{0};
+        std::atomic<uint32_t> full_words{0};
+        std::array<std::atomic<uint64_t>, PAGE_WORDS> words{};
+    };
+
+    enum class SlotResult {
+        MISSED,    // The slot holds another page
+        INSERTED,
+        FILLED     // Inserted, and the page is now full
+    };
+
+    SlotResult insert_in_slot(TaskId id);
+    static SlotResult set_bit(Slot& slot, TaskId id);
+    static bool test_bit(const Slot& slot, TaskId id);
+    Slot& slot_of(TaskId page) const { return window_[page % WINDOW_PAGES]; }
+
+    void insert_locked(TaskId id);
+    Page& page_locked(TaskId page);
+    void add_full_pages_locked(TaskId first, TaskId last);
+    void advance_locked();
+    TaskId scan_watermark_locked(TaskId from) const;
+    bool in_full_run_locked(TaskId page) const;
+    void retire_slot_locked(TaskId page);
+    void refresh_window_locked();
+    void retag_locked(Slot& slot, TaskId page);
+
+    mutable std::mutex mutex_;
+    mutable std::array<Slot, WINDOW_PAGES> window_;  // Lookups announce themselves too
+    std::atomic<TaskId> watermark_{INVALID_TASK_ID + 1};  // Never assigned, never outstanding
+    std::map<TaskId, Page> pages_;            // By page number, beyond the window
+    std::map<TaskId, TaskId> full_runs_;      // [first, last) page numbers, fully finished
+};
+
+} // namespace taskscheduler
+
+#endif // TASKSCHEDULER_COMPLETION_SET_HPP
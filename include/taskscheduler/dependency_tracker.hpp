@@ -2,12 +2,19 @@
 #define TASKSCHEDULER_DEPENDENCY_TRACKER_HPP
 
 #include "task.hpp"
+#include "lock_stats.hpp"
 #include "task_id.hpp"
+#include "completion_set.hpp"
+#include "slot_index.hpp"
+#include <cstdint>
 #include <unordered_map>
-#include <unordered_set>
 #include <vector>
 #include <memory>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <mutex>
+#include <optional>
 
 namespace taskscheduler {
 
@@ -20,19 +27,169 @@ public:
     DependencyTracker& operator=(const DependencyTracker&) = delete;
 
     TaskId assign_id(std::unique_ptr<Task>& task);
-    void add_task(std::unique_ptr<Task> task);
+
+    // Makes assign_id() hand out ids from `next_id` on, unless it already
+    // has; used to keep ids read back from a journal unique. The skipped
+    // ids count as finished, except those in `outstanding`.
+    void reserve_ids(TaskId next_id, const std::vector<TaskId>& outstanding = {});
+
+    // Holds `task` until its prerequisites finish. Prerequisites that have
+    // finished already count as satisfied; if all have, the task is handed
+    // straight back. A task depending on an id that was never assigned is
+    // handed back cancelled.
+    std::unique_ptr<Task> add_task(std::unique_ptr<Task> task);
     std::vector<std::unique_ptr<Task>> get_ready_tasks();
     void mark_completed(TaskId task_id);
+
+    // Marks `task_id` completed and returns the dependents that became
+    // ready as a result, in a single pass over that task's dependents.
+    // Does not take the tracker lock when no task is waiting on anything.
+    std::vector<std::unique_ptr<Task>> complete(TaskId task_id);
+
+    // Records that `task_id` will never run, e.g. because it was dropped
+    // before reaching the tracker or a queue. Tasks submitted later that
+    // depend on it do not wait for it.
+    void retire(TaskId task_id);
+
+    // True once `task_id` completed, was cancelled or was retired
+    bool is_finished(TaskId task_id) const;
+
+    // Blocks until is_finished(task_id), or until `deadline` passes.
+    // Returns whether the task finished; false at once for an id that has
+    // not been assigned. Waiters sleep on a condition
+    // variable of their own id and are woken only when it finishes.
+    bool wait_finished(TaskId task_id,
+                       std::optional<std::chrono::steady_clock::time_point> deadline = std::nullopt) const;
     bool has_pending_tasks() const;
+    size_t pending_count() const;
+
+    // Cancels a pending task and, transitively, every task that depends on
+    // it. Cancelled tasks are released from the tracker immediately.
     bool cancel_task(TaskId id);
 
+    // Same as cancel_task, but hands the released tasks back to the caller.
+    // Returns an empty vector if `id` is not pending.
+    std::vector<std::unique_ptr<Task>> remove_task(TaskId id);
+
+    // Propagates a dependent's urgency backwards from the tasks in `ids`
+    // through their pending prerequisites: `priority` and `deadline` are
+    // inherited, and each prerequisite's critical path is extended by
+    // `downstream_ms`; a path that grows by less than a sixteenth is not
+    // passed further back. Returns the prerequisites that were reached but
+    // are not held by the tracker (queued, running or done), mapped to the
+    // downstream path they should be extended by, and adds the number of
+    // priority/deadline boosts to `boosted`.
+    std::unordered_map<TaskId, double> inherit(const TaskIdList& ids,
+                                               Priority priority,
+                                               std::optional<Task::TimePoint> deadline,
+                                               double downstream_ms, size_t& boosted);
+
+    // What a pending task passes on to the prerequisites the tracker does
+    // not hold: their downstream paths as returned by inherit(), and the
+    // task's effective priority and deadline.
+    struct Propagation {
+        std::unordered_map<TaskId, double> downstream_ms;
+        Priority priority = Priority::LOW;
+        std::optional<Task::TimePoint> deadline;
+        size_t boosted = 0;
+    };
+
+    // Replaces the priority and/or deadline of pending task `id` and passes
+    // the result on to its pending prerequisites as inherit() does. Returns
+    // std::nullopt if `id` is not pending.
+    std::optional<Propagation> update_task(TaskId id, std::optional<Priority> priority,
+                                           std::optional<Task::TimePoint> deadline);
+
+    // Removes every pending task, e.g. to hand it back at shutdown.
+    std::vector<std::unique_ptr<Task>> drain();
+
+    // Cancels every pending task that transitively depends on `id` without
+    // touching `id` itself, and returns the released tasks. `id` counts as
+    // finished from then on.
+    std::vector<std::unique_ptr<Task>> cancel_dependents(TaskId id);
+
+    // Contention counters of the tracker lock; nullopt unless built with
+    // TASKSCHEDULER_LOCK_STATS.
+    std::optional<LockStatistics> lock_statistics() const {
+        return taskscheduler::lock_statistics(mutex_);
+    }
+
+    // Node slots allocated so far, live or free. Slots are recycled, so
+    // this tracks the peak number of tasks and targets held at once.
+    size_t slot_count() const;
+
 private:
-    mutable std::mutex mutex_;
+    static constexpr uint32_t NO_SLOT = SlotIndex::NO_SLOT;
+
+    // An edge from a prerequisite to the node of a dependent. The
+    // generation goes stale once the dependent leaves its node, so
+    // edges are never unlinked one by one.
+    struct Edge {
+        uint32_t slot;
+        uint32_t generation;
+    };
+
+    // A task held until its prerequisites finish, a prerequisite that
+    // others wait on, or both. Dependents sit in a flat array that
+    // complete() walks in order.
+    struct Node {
+        TaskId id = INVALID_TASK_ID;
+        uint32_t generation = 0;
+        uint32_t remaining = 0;       // Unfinished prerequisites of task
+        uint32_t live_edges = 0;      // Entries of dependents not yet stale
+        std::unique_ptr<Task> task;   // Null while only a prerequisite
+        std::vector<Edge> dependents;
+    };
+
+    struct Waiter {
+        std::condition_variable cv;
+        size_t count = 0;
+    };
+
+    void mark_finished(TaskId task_id);
+    void mark_finished_range(TaskId begin, TaskId end);
+    void notify_finished(TaskId task_id);
+
+    uint32_t node_slot(TaskId id);
+    void release_if_unused(uint32_t slot);
+    void drop_edge(TaskId target);
+    std::vector<Edge> detach_dependents(uint32_t slot);
+    bool is_live(const Edge& edge) const;
+    Task* pending_task(TaskId id);
+    std::vector<std::unique_ptr<Task>> resolve_dependents(TaskId task_id, bool take_ready);
+
+    std::unique_ptr<Task> remove_pending(uint32_t slot);
+    void cancel_dependents_locked(TaskId id, std::vector<std::unique_ptr<Task>>& removed);
+    std::unordered_map<TaskId, double> inherit_locked(const TaskIdList& ids, Priority priority,
+                                                      std::optional<Task::TimePoint> deadline,
+                                                      double downstream_ms, size_t& boosted);
+    void publish_sizes();
+
+    mutable SchedulerMutex mutex_;
     TaskId next_id_{1};
 
-    std::unordered_map<TaskId, std::unique_ptr<Task>> pending_tasks_;
-    std::unordered_map<TaskId, std::unordered_set<TaskId>> dependents_;
-    std::unordered_map<TaskId, size_t> remaining_dependencies_;
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> free_slots_;
+    SlotIndex slots_;
+    size_t pending_nodes_ = 0;  // Nodes holding a task
+    size_t target_nodes_ = 0;   // Nodes with live dependents
+
+    // Ids that completed or will never run. Written before complete() looks
+    // for dependents and read by add_task() after it registered its own, so
+    // one of the two always sees the other.
+    CompletionSet finished_;
+
+    // Threads in wait_finished(), by id. A waiter registers and then checks
+    // finished_; mark_finished() inserts and then checks waiter_count_, so
+    // a finish never slips between a waiter's check and its sleep.
+    mutable std::mutex waiters_mutex_;
+    mutable std::unordered_map<TaskId, Waiter> waiters_;
+    mutable std::atomic<size_t> waiter_count_{0};
+
+    // Mirrors of pending_nodes_ and target_nodes_, read without
+    // the lock by pending_count() and the fast path in complete()
+    std::atomic<size_t> pending_size_{0};
+    std::atomic<size_t> tracked_targets_{0};
 };
 
 } // namespace taskscheduler
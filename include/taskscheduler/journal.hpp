@@ -0,0 +1,114 @@
+#ifndef TASKSCHEDULER_JOURNAL_HPP
+#define TASKSCHEDULER_JOURNAL_HPP
+
+#include "task_registry.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace taskscheduler {
+
+struct JournalOptions {
+    // Initial size of the mapped log; it doubles whenever it fills up.
+    size_t initial_bytes = 1 << 20;
+
+    // How long the committer waits to gather more records into one fsync
+    // after the first uncommitted record arrives.
+    std::chrono::microseconds commit_delay{0};
+
+    // Whether ThreadPool::submit_registered() waits until the submit
+    // record is durable before queuing the task.
+    bool wait_for_commit = true;
+};
+
+// A task that was submitted but neither completed nor cancelled
+struct JournalEntry {
+    TaskId id;
+    TaskSpec spec;
+};
+
+/**
+ * Append-only log of submit, complete and cancel records for tasks built
+ * from registered types, backed by a memory-mapped file.
+ *
+ * Appends copy the record into the mapping under a short lock and return
+ * the log offset it ends at. A committer thread calls fdatasync() for
+ * everything appended so far, so concurrent submitters share one sync
+ * (group commit); wait_durable() blocks until a given offset is on disk.
+ * Records carry a CRC, and a torn record at the tail is discarded on
+ * recovery.
+ *
+ * open() reads an existing log back, keeps the tasks that are still live
+ * and rewrites the file to contain only their submit records, so the log
+ * does not grow across restarts. Dependencies on tasks that completed, or
+ * that the journal never saw, are dropped; tasks depending on a cancelled
+ * task are cancelled with it. Deadlines are stored as wall-clock time.
+ *
+ * Completion records are not waited for, so a task that finished just
+ * before a crash may run again after recovery.
+ */
+class Journal {
+public:
+    explicit Journal(JournalOptions options = {});
+    ~Journal();
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+    bool is_open() const;
+    const JournalOptions& options() const;
+
+    // Live tasks read back by open(), in submission order
+    const std::vector<JournalEntry>& recovered() const;
+
+    // Highest task id seen in the log (INVALID_TASK_ID if none)
+    TaskId max_task_id() const;
+
+    uint64_t append_submit(TaskId id, const TaskSpec& spec);
+    uint64_t append_complete(TaskId id);
+    uint64_t append_cancel(TaskId id);
+
+    void wait_durable(uint64_t offset);
+    void sync();
+
+    uint64_t size_bytes() const;
+    uint64_t durable_bytes() const;
+    size_t commit_count() const;
+
+private:
+    uint64_t append(const std::vector<uint8_t>& payload);
+    void ensure_capacity_locked(uint64_t needed);
+    bool map_locked(uint64_t capacity);
+    bool recover_file(const std::string& path);
+    void commit_loop();
+
+    JournalOptions options_;
+    std::string path_;
+    int fd_ = -1;
+    uint8_t* base_ = nullptr;
+    uint64_t capacity_ = 0;
+
+    mutable std::mutex mutex_;
+    std::condition_variable commit_cv_;
+    std::condition_variable durable_cv_;
+    uint64_t tail_ = 0;
+    uint64_t durable_ = 0;
+    bool commit_requested_ = false;
+    bool stopping_ = false;
+    std::atomic<size_t> commits_{0};
+    std::thread committer_;
+
+    std::vector<JournalEntry> recovered_;
+    TaskId max_task_id_ = INVALID_TASK_ID;
+};
+
+} // namespace taskscheduler
+
+#endif // TASKSCHEDULER_JOURNAL_HPP
@@ -0,0 +1,93 @@
+#ifndef TASKSCHEDULER_LOCK_STATS_HPP
+#define TASKSCHEDULER_LOCK_STATS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace taskscheduler {
+
+// Contention counters of one scheduler lock, accumulated since it was
+// created. The pool fills in `name`.
+struct LockStatistics {
+    static constexpr size_t HOLD_TIME_BUCKETS = 16;
+
+    // Bucket i of the hold-time histogram counts holds of up to
+    // FIRST_HOLD_TIME_BOUND_NS << i (inclusive); longer holds land in the
+    // overflow bucket. HOLD_TIME_BUCKET_BOUNDS_US lists the same bounds in
+    // microseconds: 0.25, 0.5, 1, ... 8192.
+    static constexpr uint64_t FIRST_HOLD_TIME_BOUND_NS = 250;
+    static const std::array<double, HOLD_TIME_BUCKETS> HOLD_TIME_BUCKET_BOUNDS_US;
+
+    std::string name;
+    size_t acquisitions = 0;
+    size_t contended_acquisitions = 0;  // Had to wait for another holder
+    double wait_time_ms = 0.0;          // Spent waiting in contended acquisitions
+    double hold_time_ms = 0.0;
+    std::array<size_t, HOLD_TIME_BUCKETS + 1> hold_time_buckets{};  // Not cumulative
+};
+
+/**
+ * A std::mutex that counts its acquisitions, how many of them found the
+ * lock held, how long those waited, and how long the lock was held.
+ *
+ * An uncontended acquisition costs a try_lock and two clock reads. The
+ * counters are relaxed atomics, so statistics() can be read at any time
+ * without taking the lock.
+ */
+class InstrumentedMutex {
+public:
+    InstrumentedMutex() = default;
+
+    InstrumentedMutex(const InstrumentedMutex&) = delete;
+    InstrumentedMutex& operator=(const InstrumentedMutex&) = delete;
+
+    void lock();
+    bool try_lock();
+    void unlock();
+
+    LockStatistics statistics() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void acquired();
+
+    std::mutex mutex_;
+    Clock::time_point acquired_at_;  // Only touched by the holder
+
+    std::atomic<size_t> acquisitions_{0};
+    std::atomic<size_t> contended_acquisitions_{0};
+    std::atomic<uint64_t> wait_time_ns_{0};
+    std::atomic<uint64_t> hold_time_ns_{0};
+    std::array<std::atomic<size_t>, LockStatistics::HOLD_TIME_BUCKETS + 1> hold_time_buckets_{};
+};
+
+// The mutex guarding TaskQueue and DependencyTracker. Configuring with
+// -DTASKSCHEDULER_LOCK_STATS=ON swaps in InstrumentedMutex; otherwise it
+// is a plain std::mutex and the instrumentation is compiled out.
+#ifdef TASKSCHEDULER_LOCK_STATS
+using SchedulerMutex = InstrumentedMutex;
+using SchedulerConditionVariable = std::condition_variable_any;
+#else
+using SchedulerMutex = std::mutex;
+using SchedulerConditionVariable = std::condition_variable;
+#endif
+
+inline std::optional<LockStatistics> lock_statistics(const InstrumentedMutex& mutex) {
+    return mutex.statistics();
+}
+
+inline std::optional<LockStatistics> lock_statistics(const std::mutex&) {
+    return std::nullopt;
+}
+
+} // namespace taskscheduler
+
+#endif // TASKSCHEDULER_LOCK_STATS_HPP
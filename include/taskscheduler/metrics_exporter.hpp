@@ -0,0 +1,66 @@
+#ifndef TASKSCHEDULER_METRICS_EXPORTER_HPP
+#define TASKSCHEDULER_METRICS_EXPORTER_HPP
+
+#include "thread_pool.hpp"
+#include <string>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+
+namespace taskscheduler {
+
+/**
+ * Renders a pool's statistics in the Prometheus text exposition format.
+ * Counters come from ThreadPool::get_cumulative_statistics() and keep
+ * increasing across reset_statistics(); gauges and the execution-time
+ * histogram are read from atomics, so rendering never takes a lock on the
+ * scheduling hot path.
+ *
+ * The exporter can serve the metrics from a minimal HTTP listener bound to
+ * the loopback interface, or write them to a file at a fixed interval.
+ * The pool must outlive the exporter.
+ */
+class MetricsExporter {
+public:
+    explicit MetricsExporter(const ThreadPool& pool, std::string metric_prefix = "taskscheduler");
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    std::string render() const;
+
+    // Serves render() to any request on 127.0.0.1:`port`. Pass 0 to pick a
+    // free port; the bound port is available from http_port().
+    bool start_http_listener(uint16_t port);
+    uint16_t http_port() const;
+
+    // Atomically replaces `path` with render() every `interval`.
+    bool start_file_writer(const std::string& path, std::chrono::milliseconds interval);
+    bool write_file(const std::string& path) const;
+
+    void stop();
+
+private:
+    void http_loop();
+    void file_loop(std::string path, std::chrono::milliseconds interval);
+
+    const ThreadPool& pool_;
+    std::string prefix_;
+
+    std::atomic<bool> running_{false};
+    std::mutex stop_mutex_;
+    std::condition_variable stop_cv_;
+
+    int listen_fd_ = -1;
+    uint16_t http_port_ = 0;
+    std::thread http_thread_;
+    std::thread file_thread_;
+};
+
+} // namespace taskscheduler
+
+#endif // TASKSCHEDULER_METRICS_EXPORTER_HPP
@@ -0,0 +1,106 @@
+#ifndef TASKSCHEDULER_PERF_COUNTERS_HPP
+#define TASKSCHEDULER_PERF_COUNTERS_HPP
+
+#include "task_class.hpp"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace taskscheduler {
+
+// Counter readings of one thread. The hardware fields stay zero when the
+// counters were opened in software mode.
+struct PerfSample {
+    uint64_t cycles = 0;
+    uint64_t instructions = 0;
+    uint64_t llc_misses = 0;
+    uint64_t context_switches = 0;
+    uint64_t cpu_time_ns = 0;
+
+    PerfSample operator-(const PerfSample& earlier) const;
+};
+
+/**
+ * Per-thread counters, read around a task to attribute its cost.
+ *
+ * Cycles, instructions and last-level cache misses come from a
+ * perf_event_open group on the constructing thread, counting user space
+ * only. If the kernel refuses them (perf_event_paranoid, containers,
+ * virtual machines without a PMU) the counters fall back to software mode,
+ * where only the always-available thread CPU time and context switch
+ * counts are read. Must be read on the thread that created it.
+ */
+class PerfCounters {
+public:
+    // With `hardware` false, goes straight to software mode.
+    explicit PerfCounters(bool hardware = true);
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool hardware() const { return group_fd_ >= 0; }
+    PerfSample read() const;
+
+private:
+    static constexpr size_t EVENTS = 3;
+
+    int group_fd_ = -1;
+    std::array<int, EVENTS> fds_{-1, -1, -1};
+};
+
+// Counter totals of the tasks of one class. Hardware totals cover only the
+// hardware_samples tasks measured by workers in hardware mode.
+struct TaskClassCounters {
+    TaskClassId task_class = DEFAULT_TASK_CLASS;
+    size_t tasks = 0;
+    size_t hardware_samples = 0;
+    uint64_t cycles = 0;
+    uint64_t instructions = 0;
+    uint64_t llc_misses = 0;
+    uint64_t context_switches = 0;
+    double cpu_time_ms = 0.0;
+};
+
+// Sums counter deltas by task class, lock-free for small class ids like
+// RuntimeEstimator.
+class TaskClassCounterTable {
+public:
+    TaskClassCounterTable() = default;
+
+    TaskClassCounterTable(const TaskClassCounterTable&) = delete;
+    TaskClassCounterTable& operator=(const TaskClassCounterTable&) = delete;
+
+    void record(TaskClassId task_class, const PerfSample& delta, bool hardware);
+
+    // Classes with at least one recorded task, by class id
+    std::vector<TaskClassCounters> snapshot() const;
+
+private:
+    static constexpr TaskClassId DIRECT_CLASSES = 64;
+
+    struct Slot {
+        std::atomic<size_t> tasks{0};
+        std::atomic<size_t> hardware_samples{0};
+        std::atomic<uint64_t> cycles{0};
+        std::atomic<uint64_t> instructions{0};
+        std::atomic<uint64_t> llc_misses{0};
+        std::atomic<uint64_t> context_switches{0};
+        std::atomic<uint64_t> cpu_time_ns{0};
+    };
+
+    static void add(Slot& slot, const PerfSample& delta, bool hardware);
+    static TaskClassCounters read(TaskClassId task_class, const Slot& slot);
+
+    std::array<Slot, DIRECT_CLASSES> direct_;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<TaskClassId, Slot> slots_;
+};
+
+} // namespace taskscheduler
+
+#endif // TASKSCHEDULER_PERF_COUNTERS_HPP
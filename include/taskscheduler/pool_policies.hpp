@@ -0,0 +1,158 @@
+#ifndef TASKSCHEDULER_POOL_POLICIES_HPP
+#define TASKSCHEDULER_POOL_POLICIES_HPP
+
+#include "task.hpp"
+#include "dependency_tracker.hpp"
+#include "statistics.hpp"
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace taskscheduler {
+
+/**
+ * Compile-time policies for BasicTaskQueue and BasicThreadPool.
+ *
+ * Each policy family provides the same interface for every choice, so the
+ * pool calls it unconditionally and a disabled feature reduces to empty
+ * inline functions the compiler removes.
+ */
+namespace policy {
+
+// ---- Ordering --------------------------------------------------------------
+// FIFO is true for queues that never reorder; otherwise precedes(a, b)
+// returns true if `a` should run before `b`. Equal tasks run in FIFO order.
+
+struct FifoOrder {
+    static constexpr bool FIFO = true;
+    static bool precedes(const Task&, const Task&) { return false; }
+};
+
+struct PriorityOrder {
+    static constexpr bool FIFO = false;
+    static bool precedes(const Task& a, const Task& b) {
+        return a.priority() > b.priority();
+    }
+};
+
+// Earliest deadline first; tasks without a deadline run after those with
+// one, and priority breaks ties.
+struct EdfOrder {
+    static constexpr bool FIFO = false;
+    static bool precedes(const Task& a, const Task& b) {
+        if (a.deadline_key() != b.deadline_key()) {
+            return a.deadline_key() < b.deadline_key();
+        }
+        return a.priority() > b.priority();
+    }
+};
+
+// ---- Dependencies ----------------------------------------------------------
+
+class WithDependencies {
+public:
+    static constexpr bool ENABLED = true;
+
+    TaskId assign_id(std::unique_ptr<Task>& task) {
+        return tracker_.assign_id(task);
+    }
+
+    // Returns the task if it can run now; otherwise keeps it until its
+    // prerequisites complete and returns nullptr. A task depending on an
+    // id that was never assigned is returned cancelled.
+    std::unique_ptr<Task> admit(std::unique_ptr<Task> task) {
+        if (task->dependency_list().empty()) {
+            return task;
+        }
+        return tracker_.add_task(std::move(task));
+    }
+
+    std::vector<std::unique_ptr<Task>> complete(TaskId id) {
+        return tracker_.complete(id);
+    }
+
+    // Drops the pending tasks that depend on `id`, which will not run.
+    std::vector<std::unique_ptr<Task>> cancel_dependents(TaskId id) {
+        return tracker_.cancel_dependents(id);
+    }
+
+    size_t pending_count() const {
+        return tracker_.pending_count();
+    }
+
+private:
+    DependencyTracker tracker_;
+};
+
+// Tasks declaring dependencies are rejected at submit.
+class NoDependencies {
+public:
+    static constexpr bool ENABLED = false;
+
+    TaskId assign_id(std::unique_ptr<Task>& task) {
+        TaskId id = next_id_.fetch_add(1, std::memory_order_relaxed);
+        task->set_id(id);
+        return id;
+    }
+
+    std::unique_ptr<Task> admit(std::unique_ptr<Task> task) { return task; }
+    std::vector<std::unique_ptr<Task>> complete(TaskId) { return {}; }
+    size_t pending_count() const { return 0; }
+
+private:
+    std::atomic<TaskId> next_id_{1};
+};
+
+// ---- Statistics ------------------------------------------------------------
+// TIMED is true if the policy needs task execution times; the pool reads the
+// clock around execute() only then.
+
+class FullStatistics {
+public:
+    static constexpr bool TIMED = true;
+
+    void task_started() { statistics_.increment_active_workers(); }
+    void task_finished(double execution_time_ms) {
+        statistics_.record_task_completed(execution_time_ms);
+        statistics_.decrement_active_workers();
+    }
+    StatisticsSnapshot snapshot() const { return statistics_.get_snapshot(); }
+    void reset() { statistics_.reset(); }
+
+private:
+    Statistics statistics_;
+};
+
+// Completion count only; no clock reads.
+class CounterStatistics {
+public:
+    static constexpr bool TIMED = false;
+
+    void task_started() {}
+    void task_finished(double) { completed_tasks_.fetch_add(1, std::memory_order_relaxed); }
+    StatisticsSnapshot snapshot() const {
+        StatisticsSnapshot snapshot{};
+        snapshot.completed_tasks = completed_tasks_.load(std::memory_order_relaxed);
+        return snapshot;
+    }
+    void reset() { completed_tasks_.store(0, std::memory_order_relaxed); }
+
+private:
+    std::atomic<size_t> completed_tasks_{0};
+};
+
+class NoStatistics {
+public:
+    static constexpr bool TIMED = false;
+
+    void task_started() {}
+    void task_finished(double) {}
+    StatisticsSnapshot snapshot() const { return StatisticsSnapshot{}; }
+    void reset() {}
+};
+
+} // namespace policy
+
+} // namespace taskscheduler
+
+#endif // TASKSCHEDULER_POOL_POLICIES_HPP
@@ -1,9 +1,11 @@
 #ifndef TASKSCHEDULER_PRIORITY_HPP
 #define TASKSCHEDULER_PRIORITY_HPP
 
+#include <cstdint>
+
 namespace taskscheduler {
 
-enum class Priority {
+enum class Priority : uint8_t {
     LOW = 0,
     NORMAL = 1,
     HIGH = 2,
@@ -0,0 +1,123 @@
+#ifndef TASKSCHEDULER_PROCESS_POOL_HPP
+#define TASKSCHEDULER_PROCESS_POOL_HPP
+
+#include "task_queue.hpp"
+#include "dependency_tracker.hpp"
+#include "statistics.hpp"
+#include "task_registry.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <sys/types.h>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace taskscheduler {
+
+struct ProcessPoolOptions {
+    size_t num_workers = 2;
+
+    // Tasks in flight per worker; rounded up to a power of two.
+    size_t ring_slots = 256;
+
+    // Per-worker shared buffer holding the arguments of in-flight tasks.
+    // Larger arguments are rejected at submit.
+    size_t arena_bytes = 1 << 20;
+};
+
+/**
+ * Runs registered task types in forked worker processes, so a handler
+ * that crashes takes down only its worker.
+ *
+ * The coordinator (this object, plus one coordinator thread) keeps the
+ * dependency tracker and the priority/deadline ordering of a TaskQueue.
+ * Ready tasks are handed to the least loaded worker through a shared
+ * memory SPSC ring; their arguments are copied once into that worker's
+ * shared arena and the handler reads them in place. Workers report
+ * completions through a second ring and one eventfd shared by all
+ * workers.
+ *
+ * A worker that dies is restarted. The task it was running is counted as
+ * failed and its dependents are dropped, the same as for a handler that
+ * throws; tasks it had not started yet are queued again.
+ *
+ * Workers are forked from this process at start(), so every type must be
+ * registered before then. Handlers run in the worker and cannot touch the
+ * coordinator's memory other than through shared mappings or files.
+ */
+class ProcessPool {
+public:
+    explicit ProcessPool(const TaskRegistry& registry, ProcessPoolOptions options = {});
+    ~ProcessPool();
+
+    ProcessPool(const ProcessPool&) = delete;
+    ProcessPool& operator=(const ProcessPool&) = delete;
+
+    // Forks the workers and starts the coordinator thread. Returns false if
+    // the shared memory or a worker cannot be set up.
+    bool start();
+
+    // Waits for every task that can still run, then stops the workers.
+    // Tasks waiting on a failed or unknown prerequisite are dropped.
+    void shutdown();
+
+    // Returns INVALID_TASK_ID if the pool is not running, the type is not
+    // registered, the arguments do not fit a worker's arena or a
+    // prerequisite is an id this pool never assigned.
+    TaskId submit(const TaskSpec& spec);
+
+    size_t worker_count() const;
+    std::vector<pid_t> worker_pids() const;
+    bool is_running() const;
+
+    StatisticsSnapshot get_statistics() const;
+
+    // Tasks whose handler threw or whose worker died while running them
+    size_t failed_tasks() const;
+    size_t worker_restarts() const;
+
+private:
+    struct Worker;
+
+    void coordinator_loop();
+    void collect_completions(Worker& worker);
+    void check_worker(Worker& worker);
+    void dispatch_ready();
+    bool dispatch_to(Worker& worker, std::unique_ptr<Task>& task);
+    void finish_task(std::unique_ptr<Task> task, bool succeeded);
+    void drop_tasks(std::vector<std::unique_ptr<Task>> tasks);
+    bool spawn_worker(Worker& worker);
+    void stop_workers();
+
+    const TaskRegistry& registry_;
+    ProcessPoolOptions options_;
+
+    TaskQueue queue_;
+    DependencyTracker dependency_tracker_;
+    Statistics statistics_;
+
+    // Serialized arguments of every task that has not finished yet
+    std::mutex arguments_mutex_;
+    std::unordered_map<TaskId, std::string> arguments_;
+
+    // Owned by the coordinator thread once started
+    std::vector<std::unique_ptr<Worker>> workers_;
+
+    int completion_fd_ = -1;
+    int submit_fd_ = -1;
+    int epoll_fd_ = -1;
+
+    std::atomic<bool> running_{false};
+    std::atomic<bool> stopping_{false};
+    std::atomic<size_t> outstanding_{0};
+    std::atomic<size_t> failed_tasks_{0};
+    std::atomic<size_t> worker_restarts_{0};
+    std::thread coordinator_;
+};
+
+} // namespace taskscheduler
+
+#endif // TASKSCHEDULER_PROCESS_POOL_HPP
@@ -0,0 +1,87 @@
+#ifndef TASKSCHEDULER_REACTOR_HPP
+#define TASKSCHEDULER_REACTOR_HPP
+
+#include "task.hpp"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace taskscheduler {
+
+enum class IoInterest {
+    READABLE,
+    WRITABLE,
+    READ_WRITE
+};
+
+/**
+ * epoll-based reactor that parks tasks until a file descriptor becomes
+ * ready, then hands them to a dispatch function (normally the pool's
+ * queue). Waiting on I/O therefore never occupies a worker.
+ *
+ * Each watch is one-shot and keyed by the task's id: once the descriptor
+ * is ready, or reports an error or hang-up, the watch is removed and the
+ * task dispatched. A descriptor can carry one watch at a time. Timer
+ * watches use a timerfd owned by the reactor; eventfds and other
+ * descriptors stay owned by the caller and must stay open while watched.
+ *
+ * The reactor thread is started by the first watch.
+ */
+class Reactor {
+public:
+    using Dispatch = std::function<void(std::unique_ptr<Task>)>;
+
+    explicit Reactor(Dispatch dispatch);
+    ~Reactor();
+
+    Reactor(const Reactor&) = delete;
+    Reactor& operator=(const Reactor&) = delete;
+
+    // Each returns false, leaving `task` untouched, if the descriptor
+    // cannot be watched or the reactor has stopped.
+    bool watch(int fd, IoInterest interest, std::unique_ptr<Task>& task);
+    bool watch_timer(std::chrono::nanoseconds delay, std::unique_ptr<Task>& task);
+
+    // Removes a watch before it fires and returns its task, or nullptr.
+    std::unique_ptr<Task> cancel(TaskId id);
+
+    size_t pending_count() const;
+
+    // Waiting tasks watching a caller's descriptor rather than a timer.
+    size_t pending_io_count() const;
+
+    // Stops the reactor thread and returns every task still waiting.
+    std::vector<std::unique_ptr<Task>> stop();
+
+private:
+    struct Watch {
+        int fd;
+        bool owns_fd;
+        std::unique_ptr<Task> task;
+    };
+
+    bool add_watch(int fd, bool owns_fd, uint32_t events, std::unique_ptr<Task>& task);
+    std::unique_ptr<Task> remove_watch_locked(TaskId id);
+    void ensure_started_locked();
+    void run();
+
+    Dispatch dispatch_;
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<TaskId, Watch> watches_;
+    std::atomic<size_t> pending_{0};
+    std::atomic<size_t> pending_io_{0};
+    bool stopped_ = false;
+    std::thread thread_;
+};
+
+} // namespace taskscheduler
+
+#endif // TASKSCHEDULER_REACTOR_HPP
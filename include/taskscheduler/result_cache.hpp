@@ -0,0 +1,111 @@
+#ifndef TASKSCHEDULER_RESULT_CACHE_HPP
+#define TASKSCHEDULER_RESULT_CACHE_HPP
+
+#include <any>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace taskscheduler {
+
+// Bounds on finished results kept for keyed submits. With max_entries of
+// zero nothing is kept once a result is ready, and only submits made while
+// the task is queued or running share it. A ttl of zero never expires.
+struct ResultCacheLimits {
+    size_t max_entries = 0;
+    std::chrono::milliseconds ttl{0};
+};
+
+/**
+ * Futures of keyed tasks, shared between submits of the same key.
+ *
+ * A key maps to the future of the task computing it: first while the task
+ * is in flight, then, within the limits, after it finished successfully.
+ * Futures are stored type-erased; a submit whose result type differs from
+ * the one already stored under its key is neither shared nor cached.
+ *
+ * Finished entries are evicted least recently used first once there are
+ * more than max_entries of them, and on lookup once older than the ttl.
+ */
+class ResultCache : public std::enable_shared_from_this<ResultCache> {
+public:
+    enum class Lookup {
+        HIT,        // Finished result returned from the cache
+        IN_FLIGHT,  // Joined a task that is still queued or running
+        MISS        // Caller must run the task
+    };
+
+    // Held by the task computing a keyed result. submitted() lets later
+    // submits of the key join the task once the pool has taken it, and
+    // complete() publishes the result; abandon(), or destroying the ticket
+    // without either (the task was rejected, cancelled or never ran),
+    // removes the key so the next submit runs it again. A failing task must
+    // abandon before its exception is set, so no later submit joins the
+    // failed future.
+    class Ticket {
+    public:
+        ~Ticket();
+
+        Ticket(const Ticket&) = delete;
+        Ticket& operator=(const Ticket&) = delete;
+
+        void submitted();
+        void complete();
+        void abandon();
+
+    private:
+        friend class ResultCache;
+        Ticket(std::shared_ptr<ResultCache> cache, std::string key, uint64_t id);
+
+        std::shared_ptr<ResultCache> cache_;
+        std::string key_;
+        uint64_t id_;
+        bool settled_ = false;
+    };
+
+    void set_limits(const ResultCacheLimits& limits);
+    ResultCacheLimits limits() const;
+
+    // If `key` holds a future of the same type, replaces `future` with it.
+    // Otherwise returns MISS, and reserves the key for `future` with a
+    // `ticket` for the caller's task unless another type or a task not yet
+    // submitted holds it.
+    Lookup acquire(const std::string& key, std::any& future, std::shared_ptr<Ticket>& ticket);
+
+    void clear();
+    size_t size() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        Entry(std::any future, uint64_t id) : future(std::move(future)), id(id) {}
+
+        std::any future;
+        uint64_t id;
+        bool submitted = false;  // Joinable once its task was taken
+        bool finished = false;
+        Clock::time_point finished_at;
+        std::list<std::string>::iterator recency;  // Valid once finished
+    };
+
+    void submitted(const std::string& key, uint64_t id);
+    void complete(const std::string& key, uint64_t id);
+    void abandon(const std::string& key, uint64_t id);
+    void erase_locked(std::unordered_map<std::string, Entry>::iterator it);
+    void evict_locked();
+
+    mutable std::mutex mutex_;
+    ResultCacheLimits limits_;
+    uint64_t next_id_ = 1;
+    std::unordered_map<std::string, Entry> entries_;
+    std::list<std::string> finished_;  // Least recently used first
+};
+
+} // namespace taskscheduler
+
+#endif // TASKSCHEDULER_RESULT_CACHE_HPP
@@ -0,0 +1,43 @@
+#ifndef TASKSCHEDULER_RUNTIME_ESTIMATOR_HPP
+#define TASKSCHEDULER_RUNTIME_ESTIMATOR_HPP
+
+#include "task_class.hpp"
+#include <unordered_map>
+#include <array>
+#include <atomic>
+#include <mutex>
+
+namespace taskscheduler {
+
+// Online per-class runtime estimate (exponentially weighted moving average
+// of measured execution times). DEFAULT_TASK_CLASS lumps unrelated work
+// together, so it is never learned and always estimates zero.
+class RuntimeEstimator {
+public:
+    explicit RuntimeEstimator(double smoothing = 0.2);
+    ~RuntimeEstimator() = default;
+
+    RuntimeEstimator(const RuntimeEstimator&) = delete;
+    RuntimeEstimator& operator=(const RuntimeEstimator&) = delete;
+
+    void record(TaskClassId task_class, double execution_time_ms);
+
+    // Returns 0.0 for classes that have not been observed yet, and for
+    // DEFAULT_TASK_CLASS.
+    double estimate(TaskClassId task_class) const;
+
+private:
+    // Small class ids are updated lock-free from worker threads; larger
+    // ids fall back to a locked map.
+    static constexpr TaskClassId DIRECT_CLASSES = 64;
+
+    double smoothing_;
+    std::array<std::atomic<double>, DIRECT_CLASSES> direct_estimates_;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<TaskClassId, double> estimates_;
+};
+
+} // namespace taskscheduler
+
+#endif // TASKSCHEDULER_RUNTIME_ESTIMATOR_HPP
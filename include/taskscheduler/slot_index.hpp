@@ -0,0 +1,46 @@
+#ifndef TASKSCHEDULER_SLOT_INDEX_HPP
+#define TASKSCHEDULER_SLOT_INDEX_HPP
+
+#include "task_id.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace taskscheduler {
+
+/**
+ * Open-addressing map from task id to a 32-bit slot. Ids are dense and
+ * increasing, so a multiplicative hash spreads them evenly; entries are
+ * stored inline, with no allocation per id.
+ *
+ * INVALID_TASK_ID marks empty entries and is never stored: find() does not
+ * find it and erase() ignores it. Not thread-safe.
+ */
+class SlotIndex {
+public:
+    static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+    // NO_SLOT if `id` is not stored
+    uint32_t find(TaskId id) const;
+
+    // `id` must not be stored already
+    void insert(TaskId id, uint32_t slot);
+    void erase(TaskId id);
+    void clear();
+
+private:
+    struct Entry {
+        TaskId id = INVALID_TASK_ID;  // Marks an empty entry
+        uint32_t slot = NO_SLOT;
+    };
+
+    size_t home(TaskId id) const;
+    void grow();
+
+    std::vector<Entry> entries_;  // Power of two in size
+    size_t size_ = 0;
+};
+
+} // namespace taskscheduler
+
+#endif // TASKSCHEDULER_SLOT_INDEX_HPP
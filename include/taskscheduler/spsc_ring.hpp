@@ -0,0 +1,91 @@
+#ifndef TASKSCHEDULER_SPSC_RING_HPP
+#define TASKSCHEDULER_SPSC_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+namespace taskscheduler {
+
+/**
+ * Bounded single-producer single-consumer ring of trivially copyable
+ * slots. The ring and its slots live in one block of caller-provided
+ * memory, so it can be placed in a shared mapping and used between
+ * processes: it holds no pointers, and its indices are lock-free atomics.
+ *
+ * Each side keeps a cached copy of the other side's index and only
+ * re-reads the shared one when the cache says the ring is full (producer)
+ * or empty (consumer).
+ */
+template<typename T>
+class SpscRing {
+    static_assert(std::is_trivially_copyable_v<T>, "ring slots are copied between processes");
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "ring indices must be address-free");
+
+public:
+    // Bytes needed for a ring of `capacity` slots (a power of two).
+    static size_t bytes_for(size_t capacity) {
+        return sizeof(SpscRing) + capacity * sizeof(T);
+    }
+
+    // Constructs an empty ring in `memory`, which must be suitably aligned
+    // and hold bytes_for(capacity) bytes.
+    static SpscRing* create(void* memory, size_t capacity) {
+        return new (memory) SpscRing(capacity);
+    }
+
+    // Producer side. Returns false if the ring is full.
+    bool try_push(const T& value) {
+        uint64_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ > mask_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ > mask_) {
+                return false;
+            }
+        }
+        slots()[tail & mask_] = value;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false if the ring is empty.
+    bool try_pop(T& value) {
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        if (head == cached_tail_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_) {
+                return false;
+            }
+        }
+        value = slots()[head & mask_];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t capacity() const { return static_cast<size_t>(mask_) + 1; }
+
+    // Totals since creation; either side may read them.
+    uint64_t pushed() const { return tail_.load(std::memory_order_acquire); }
+    uint64_t popped() const { return head_.load(std::memory_order_acquire); }
+
+private:
+    explicit SpscRing(size_t capacity) : mask_(capacity - 1) {}
+
+    T* slots() { return reinterpret_cast<T*>(this + 1); }
+
+    // Consumer-owned line
+    alignas(64) std::atomic<uint64_t> head_{0};
+    uint64_t cached_tail_ = 0;
+
+    // Producer-owned line
+    alignas(64) std::atomic<uint64_t> tail_{0};
+    uint64_t cached_head_ = 0;
+
+    alignas(64) const uint64_t mask_;
+};
+
+} // namespace taskscheduler
+
+#endif // TASKSCHEDULER_SPSC_RING_HPP
@@ -1,8 +1,10 @@
 #ifndef TASKSCHEDULER_STATISTICS_HPP
 #define TASKSCHEDULER_STATISTICS_HPP
 
+#include "task_id.hpp"
 #include <atomic>
-#include <mutex>
+#include <array>
+#include <cstddef>
 #include <chrono>
 #include <limits>
 
@@ -11,10 +13,79 @@ namespace taskscheduler {
 struct StatisticsSnapshot {
     size_t completed_tasks;
     size_t active_workers;
-    size_t queue_depth;
+    size_t queue_depth;  // Filled in by the pool
     double min_execution_time_ms;
     double max_execution_time_ms;
     double avg_execution_time_ms;
+
+    // Admission control
+    size_t pending_task_count;
+    size_t pending_task_bytes;
+    size_t rejected_tasks;
+    size_t shed_tasks;
+
+    // Number of prerequisite tasks boosted by priority inheritance
+    size_t priority_inheritance_boosts;
+
+    // Dependents run directly on the worker that made them ready
+    size_t inline_continuations;
+
+    // Duration of the most recent shutdown (0 if none yet)
+    double last_shutdown_time_ms;
+
+    // Tasks waiting in the dependency tracker
+    size_t pending_dependencies;
+
+    // Blocking regions: workers currently blocked, compensating workers
+    // spawned for them, and total time spent inside the regions
+    size_t blocked_workers;
+    size_t compensating_workers_spawned;
+    double blocked_time_ms;
+
+    // Keyed submits: answered from the result cache, joined to a task
+    // already queued or running, and run because neither applied
+    size_t result_cache_hits;
+    size_t deduplicated_submits;
+    size_t result_cache_misses;
+
+    // Items run inside batch executions (see submit_batched)
+    size_t coalesced_items;
+
+    // The task that has been running longest on a fixed worker right now
+    // (INVALID_TASK_ID and 0 if all are idle)
+    TaskId longest_running_task;
+    double longest_running_task_ms;
+
+    // Watchdog reports (see ThreadPool::set_watchdog)
+    size_t long_running_tasks;
+    size_t stalled_workers;
+};
+
+// Monotonic counters for rate calculations by external monitoring. Unlike
+// StatisticsSnapshot these are never cleared by reset().
+struct CumulativeStatistics {
+    static constexpr size_t EXECUTION_TIME_BUCKETS = 16;
+
+    // Upper bounds (inclusive) of the execution-time histogram buckets;
+    // observations above the last bound land in the overflow bucket.
+    static const std::array<double, EXECUTION_TIME_BUCKETS> EXECUTION_TIME_BUCKET_BOUNDS_MS;
+
+    size_t completed_tasks;
+    size_t rejected_tasks;
+    size_t shed_tasks;
+    size_t priority_inheritance_boosts;
+    size_t inline_continuations;
+    size_t compensating_workers_spawned;
+    size_t result_cache_hits;
+    size_t deduplicated_submits;
+    size_t result_cache_misses;
+    size_t coalesced_items;
+    size_t long_running_tasks;
+    size_t stalled_workers;
+
+    double total_execution_time_ms;
+    double blocked_time_ms;
+    std::array<size_t, EXECUTION_TIME_BUCKETS + 1> execution_time_buckets;  // Not cumulative
 };
 
 class Statistics {
@@ -25,20 +96,63 @@ public:
     void record_task_completed(double execution_time_ms);
     void increment_active_workers();
     void decrement_active_workers();
-    void set_queue_depth(size_t depth);
+    void record_task_rejected();
+    void record_task_shed();
+    void record_priority_inheritance(size_t boosted_tasks);
+    void record_inline_continuation();
+    void record_compensating_worker();
+    void record_blocked(double blocked_time_ms);
+    void record_result_cache_hit();
+    void record_deduplicated_submit();
+    void record_result_cache_miss();
+    void record_coalesced_items(size_t items);
+    void record_long_running_task();
+    void record_stalled_worker();
+    void record_shutdown(double shutdown_time_ms);
 
     StatisticsSnapshot get_snapshot() const;
+    CumulativeStatistics get_cumulative() const;
     void reset();
 
 private:
     std::atomic<size_t> completed_tasks_{0};
     std::atomic<size_t> active_workers_{0};
-    std::atomic<size_t> queue_depth_{0};
+    std::atomic<size_t> rejected_tasks_{0};
+    std::atomic<size_t> shed_tasks_{0};
+    std::atomic<size_t> priority_inheritance_boosts_{0};
+    std::atomic<size_t> inline_continuations_{0};
+    std::atomic<size_t> compensating_workers_spawned_{0};
+    std::atomic<double> blocked_time_ms_{0.0};
+    std::atomic<size_t> result_cache_hits_{0};
+    std::atomic<size_t> deduplicated_submits_{0};
+    std::atomic<size_t> result_cache_misses_{0};
+    std::atomic<size_t> coalesced_items_{0};
+    std::atomic<size_t> long_running_tasks_{0};
+    std::atomic<size_t> stalled_workers_{0};
+    std::atomic<double> last_shutdown_time_ms_{0.0};
+
+    // Updated without locks; a snapshot taken while tasks complete may mix
+    // values from adjacent completions.
+    std::atomic<double> min_execution_time_ms_{std::numeric_limits<double>::max()};
+    std::atomic<double> max_execution_time_ms_{0.0};
+    std::atomic<double> total_execution_time_ms_{0.0};
 
-    mutable std::mutex execution_time_mutex_;
-    double min_execution_time_ms_{std::numeric_limits<double>::max()};
-    double max_execution_time_ms_{0.0};
-    double total_execution_time_ms_{0.0};
+    // Lifetime counterparts, untouched by reset()
+    std::atomic<size_t> lifetime_completed_tasks_{0};
+    std::atomic<size_t> lifetime_rejected_tasks_{0};
+    std::atomic<size_t> lifetime_shed_tasks_{0};
+    std::atomic<size_t> lifetime_priority_inheritance_boosts_{0};
+    std::atomic<size_t> lifetime_inline_continuations_{0};
+    std::atomic<size_t> lifetime_compensating_workers_spawned_{0};
+    std::atomic<size_t> lifetime_result_cache_hits_{0};
+    std::atomic<size_t> lifetime_deduplicated_submits_{0};
+    std::atomic<size_t> lifetime_result_cache_misses_{0};
+    std::atomic<size_t> lifetime_coalesced_items_{0};
+    std::atomic<size_t> lifetime_long_running_tasks_{0};
+    std::atomic<size_t> lifetime_stalled_workers_{0};
+    std::atomic<double> lifetime_execution_time_ms_{0.0};
+    std::atomic<double> lifetime_blocked_time_ms_{0.0};
+    std::array<std::atomic<size_t>, CumulativeStatistics::EXECUTION_TIME_BUCKETS + 1> execution_time_buckets_{};
 };
 
 } // namespace taskscheduler
@@ -3,43 +3,125 @@
 
 #include "priority.hpp"
 #include "task_id.hpp"
+#include "task_class.hpp"
+#include "task_id_list.hpp"
 #include <functional>
 #include <vector>
 #include <chrono>
 #include <optional>
 #include <atomic>
+#include <cstdint>
+#include <limits>
 
 namespace taskscheduler {
 
-class Task {
+/**
+ * Unit of work scheduled by the pool.
+ *
+ * The layout is kept compact because millions of tasks may be queued at
+ * once: the fields read while ordering and running a task are packed into
+ * its first 64 bytes, dependencies are stored inline for the common case
+ * of up to four, the deadline is a sentinel-encoded tick count instead of
+ * an optional, and the class is final so it carries no vtable.
+ */
+class Task final {
 public:
     using Callable = std::function<void()>;
     using TimePoint = std::chrono::steady_clock::time_point;
 
     explicit Task(Callable callable, Priority priority = Priority::NORMAL);
     explicit Task(Callable callable, Priority priority, const std::vector<TaskId>& dependencies);
-    virtual ~Task() = default;
+    ~Task() = default;
 
     void execute();
     Priority priority() const;
+    Priority base_priority() const;
+
+    // Replaces the base priority. The effective priority is the higher of
+    // it and any priority a dependent passed on.
+    void set_priority(Priority priority);
     TaskId id() const;
-    const std::vector<TaskId>& dependencies() const;
+
+    // Copy of the prerequisites, kept for callers written against the
+    // vector the ids used to be stored in. dependency_list() reads them in
+    // place.
+    std::vector<TaskId> dependencies() const;
+    const TaskIdList& dependency_list() const;
+
+    // Replaces the prerequisites of a task no pool holds.
+    void set_dependencies(TaskIdList dependencies);
     void set_id(TaskId id);
 
+    // Replaces the task's own deadline. The effective deadline is the
+    // earlier of it and any deadline a dependent passed on.
     void set_deadline(TimePoint deadline);
     std::optional<TimePoint> deadline() const;
     bool has_deadline() const;
 
+    // Deadline as a sortable key: earlier deadlines compare lower, and a
+    // task without a deadline sorts after every task that has one.
+    int64_t deadline_key() const;
+
+    // Priority inheritance: raise the effective priority, or pull the
+    // deadline earlier, on behalf of a more urgent dependent. Each returns
+    // true if the task changed. What was passed on is kept apart from the
+    // task's own values, so later updates of those do not undo it.
+    bool inherit_priority(Priority priority);
+    bool inherit_deadline(TimePoint deadline);
+
+    void set_task_class(TaskClassId task_class);
+    TaskClassId task_class() const;
+
+    // Registered type the task was created from (see TaskRegistry).
+    void set_task_type(TaskTypeId task_type);
+    TaskTypeId task_type() const;
+
+    // Executor lane, set by the pool at submit time.
+    void set_lane(LaneId lane);
+    LaneId lane() const;
+
+    // Critical-path length: this task's estimated runtime plus the longest
+    // estimated chain of dependents waiting on it. Setting the estimate
+    // resets the path to it; extending returns true if the path grew.
+    void set_runtime_estimate_ms(double estimate_ms);
+    double runtime_estimate_ms() const;
+    double critical_path_ms() const;
+    bool extend_critical_path(double downstream_ms);
+
     void cancel();
     bool is_cancelled() const;
 
+    // Estimated heap cost of the callable's captured state, used by
+    // admission control. Defaults to zero when unknown.
+    void set_payload_bytes(size_t bytes);
+    size_t payload_bytes() const;
+
+    // Approximate memory held by this task while it is pending.
+    size_t footprint_bytes() const;
+
 private:
+    static constexpr int64_t NO_DEADLINE = std::numeric_limits<int64_t>::max();
+
+    static int64_t to_ticks(TimePoint deadline);
+
+    // First 64 bytes: everything dequeue ordering and execution touch. Tasks
+    // are not cache-line aligned, so these may straddle two lines.
     Callable callable_;
-    Priority priority_;
+    int64_t deadline_ticks_{NO_DEADLINE};
     TaskId id_{INVALID_TASK_ID};
-    std::vector<TaskId> dependencies_;
-    std::optional<TimePoint> deadline_;
+    float critical_path_ms_{0.0f};
+    TaskClassId task_class_{DEFAULT_TASK_CLASS};
+    Priority base_priority_;
+    Priority inherited_priority_{Priority::LOW};
     std::atomic<bool> cancelled_{false};
+    LaneId lane_{DEFAULT_LANE};
+    uint32_t payload_bytes_{0};
+
+    // Colder fields, touched at submit and dependency-resolution time
+    TaskIdList dependencies_;
+    float runtime_estimate_ms_{0.0f};
+    TaskTypeId task_type_{UNREGISTERED_TASK_TYPE};
+    int64_t inherited_deadline_ticks_{NO_DEADLINE};
 };
 
 } // namespace taskscheduler
@@ -0,0 +1,27 @@
+#ifndef TASKSCHEDULER_TASK_CLASS_HPP
+#define TASKSCHEDULER_TASK_CLASS_HPP
+
+#include <cstdint>
+
+namespace taskscheduler {
+
+// Optional key grouping tasks that do the same kind of work, so the pool
+// can learn and act on per-class behaviour.
+using TaskClassId = uint32_t;
+
+constexpr TaskClassId DEFAULT_TASK_CLASS = 0;
+
+// Registered task type (see TaskRegistry); tasks built from a plain
+// callable have none.
+using TaskTypeId = uint32_t;
+
+constexpr TaskTypeId UNREGISTERED_TASK_TYPE = 0;
+
+// Index of the executor lane a task runs on (see ThreadPool::add_lane).
+using LaneId = uint8_t;
+
+constexpr LaneId DEFAULT_LANE = 0;
+
+} // namespace taskscheduler
+
+#endif // TASKSCHEDULER_TASK_CLASS_HPP
@@ -0,0 +1,53 @@
+#ifndef TASKSCHEDULER_TASK_ID_LIST_HPP
+#define TASKSCHEDULER_TASK_ID_LIST_HPP
+
+#include "task_id.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <initializer_list>
+
+namespace taskscheduler {
+
+// Immutable list of task ids that stores up to INLINE_CAPACITY ids without
+// a heap allocation. Most tasks have no or only a few dependencies.
+class TaskIdList {
+public:
+    static constexpr uint32_t INLINE_CAPACITY = 4;
+
+    TaskIdList() = default;
+    TaskIdList(const std::vector<TaskId>& ids);
+    TaskIdList(std::initializer_list<TaskId> ids);
+    ~TaskIdList();
+
+    TaskIdList(const TaskIdList& other);
+    TaskIdList& operator=(const TaskIdList& other);
+    TaskIdList(TaskIdList&& other) noexcept;
+    TaskIdList& operator=(TaskIdList&& other) noexcept;
+
+    const TaskId* begin() const { return data(); }
+    const TaskId* end() const { return data() + size_; }
+    const TaskId& operator[](size_t index) const { return data()[index]; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    // Heap memory owned by the list (zero while the ids fit inline)
+    size_t heap_bytes() const;
+
+private:
+    const TaskId* data() const { return is_inline() ? inline_ : heap_; }
+    bool is_inline() const { return size_ <= INLINE_CAPACITY; }
+    void assign(const TaskId* ids, size_t count);
+    void steal(TaskIdList& other);
+    void release();
+
+    union {
+        TaskId inline_[INLINE_CAPACITY];
+        TaskId* heap_;
+    };
+    uint32_t size_ = 0;
+};
+
+} // namespace taskscheduler
+
+#endif // TASKSCHEDULER_TASK_ID_LIST_HPP
@@ -2,11 +2,14 @@
 #define TASKSCHEDULER_TASK_QUEUE_HPP
 
 #include "task.hpp"
-#include <queue>
+#include "lock_stats.hpp"
+#include "slot_index.hpp"
+#include <unordered_map>
 #include <vector>
 #include <memory>
-#include <mutex>
-#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 
 namespace taskscheduler {
 
@@ -18,63 +21,132 @@ public:
     TaskQueue(const TaskQueue&) = delete;
     TaskQueue& operator=(const TaskQueue&) = delete;
 
+    // size(), empty() and is_closed() read published atomics and never
+    // take the queue lock, so they are cheap to poll from hot paths.
     void push(std::unique_ptr<Task> task);
+
+    // Like push, but leaves `task` untouched and returns false if the queue
+    // is closed.
+    bool try_push(std::unique_ptr<Task>& task);
+
     std::unique_ptr<Task> pop();
+
+    // Like pop, but gives up and returns nullptr after `timeout`.
+    std::unique_ptr<Task> pop_for(std::chrono::milliseconds timeout);
     size_t size() const;
     bool empty() const;
     void close();
     bool is_closed() const;
+
+    // Closes the queue and removes every queued task, in scheduling order.
+    std::vector<std::unique_ptr<Task>> close_and_drain();
     bool cancel_task(TaskId id);
 
+    // Replaces the priority and/or deadline of queued task `id` and moves it
+    // to its new place in O(log n). Returns false if it is not queued.
+    bool update_task(TaskId id, std::optional<Priority> priority,
+                     std::optional<Task::TimePoint> deadline);
+
+    // Raises the effective priority and deadline of the queued tasks in
+    // `downstream_ms`, extends their critical paths by the mapped value and
+    // re-keys them. Returns the number of priority/deadline boosts.
+    size_t inherit(const std::unordered_map<TaskId, double>& downstream_ms, Priority priority,
+                   std::optional<Task::TimePoint> deadline);
+
+    // True if a queued task would be scheduled strictly ahead of `task`
+    // (ignoring FIFO order among otherwise equal tasks).
+    bool has_work_ahead_of(const Task& task) const;
+
+    // Removes and returns the lowest-priority queued task whose priority is
+    // strictly below `priority`, or nullptr if there is none.
+    std::unique_ptr<Task> shed_lowest(Priority priority);
+
+    // Contention counters of the queue lock; nullopt unless built with
+    // TASKSCHEDULER_LOCK_STATS.
+    std::optional<LockStatistics> lock_statistics() const {
+        return taskscheduler::lock_statistics(mutex_);
+    }
+
 private:
+    static constexpr uint32_t NO_SLOT = SlotIndex::NO_SLOT;
+
+    // The fields the scheduling order reads, copied out of the task so heap
+    // maintenance compares entries without touching the tasks themselves.
+    // Refreshed whenever the queue changes a queued task.
+    struct Key {
+        int64_t deadline;
+        float critical_path_ms;
+        Priority priority;
+
+        explicit Key(const Task& task)
+            : deadline(task.deadline_key()),
+              critical_path_ms(static_cast<float>(task.critical_path_ms())),
+              priority(task.priority()) {}
+    };
+
     struct TaskWrapper {
-        mutable std::unique_ptr<Task> task;
+        std::unique_ptr<Task> task;
         size_t sequence;
+        Key key;
+        uint32_t slot;  // In slot_positions_, or NO_SLOT if not indexed
 
-        TaskWrapper(std::unique_ptr<Task> t, size_t seq)
-            : task(std::move(t)), sequence(seq) {}
-
-        TaskWrapper(TaskWrapper&& other) noexcept
-            : task(std::move(other.task)), sequence(other.sequence) {}
-
-        TaskWrapper& operator=(TaskWrapper&& other) noexcept {
-            task = std::move(other.task);
-            sequence = other.sequence;
-            return *this;
-        }
+        TaskWrapper(std::unique_ptr<Task> t, size_t seq, uint32_t s)
+            : task(std::move(t)), sequence(seq), key(*task), slot(s) {}
 
+        // True if `other` should run first
         bool operator<(const TaskWrapper& other) const {
-            // First, consider deadlines
-            bool this_has_deadline = task->has_deadline();
-            bool other_has_deadline = other.task->has_deadline();
-
-            // If both have deadlines, prioritize the earlier deadline
-            if (this_has_deadline && other_has_deadline) {
-                auto this_deadline = task->deadline().value();
-                auto other_deadline = other.task->deadline().value();
-                if (this_deadline != other_deadline) {
-                    return this_deadline > other_deadline;  // Earlier deadline has higher priority
-                }
-            }
-
-            // If only one has a deadline, it gets priority
-            if (this_has_deadline != other_has_deadline) {
-                return !this_has_deadline;  // Task with deadline wins
+            if (precedes(other.key, key)) {
+                return true;
             }
-
-            // Fall back to priority comparison
-            if (task->priority() == other.task->priority()) {
-                return sequence > other.sequence;  // FIFO for same priority
+            if (precedes(key, other.key)) {
+                return false;
             }
-            return task->priority() < other.task->priority();  // Higher priority first
+            return sequence > other.sequence;  // FIFO for otherwise equal tasks
         }
     };
 
-    mutable std::mutex mutex_;
-    std::condition_variable cv_;
-    std::priority_queue<TaskWrapper> queue_;
+    // Scheduling order without the FIFO tie-break: true if `a` should run
+    // before `b`.
+    static bool precedes(const Key& a, const Key& b) {
+        // Earlier deadline first; tasks without a deadline carry the
+        // largest key and so sort after every task that has one.
+        if (a.deadline != b.deadline) {
+            return a.deadline < b.deadline;
+        }
+
+        // Fall back to priority comparison
+        if (a.priority != b.priority) {
+            return a.priority > b.priority;  // Higher priority first
+        }
+
+        // Longest remaining critical path first
+        return a.critical_path_ms > b.critical_path_ms;
+    }
+
+    // Heap maintenance; every move of an entry updates slot_positions_
+    void push_locked(std::unique_ptr<Task> task);
+    size_t find_locked(TaskId id) const;
+    std::unique_ptr<Task> remove_locked(size_t position);
+    void rekey_locked(size_t position);
+    size_t sift_up(size_t position);
+    void sift_down(size_t position);
+    void place(size_t position);
+
+    mutable SchedulerMutex mutex_;
+    SchedulerConditionVariable cv_;
+
+    // Binary heap with the next task to run at the front, indexed by task id
+    // so a queued task can be found and re-keyed in place. Tasks without an
+    // id are queued but not indexed. The id maps to a slot for the task's
+    // whole stay and the slot holds its current position, so moving an
+    // entry is a plain store rather than a hash update.
+    std::vector<TaskWrapper> heap_;
+    SlotIndex slots_;
+    std::vector<size_t> slot_positions_;
+    std::vector<uint32_t> free_slots_;
     size_t sequence_counter_ = 0;
-    bool closed_ = false;
+    std::atomic<size_t> size_{0};
+    std::atomic<bool> closed_{false};
 };
 
 } // namespace taskscheduler
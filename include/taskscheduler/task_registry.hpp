@@ -0,0 +1,52 @@
+#ifndef TASKSCHEDULER_TASK_REGISTRY_HPP
+#define TASKSCHEDULER_TASK_REGISTRY_HPP
+
+#include "task.hpp"
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace taskscheduler {
+
+// A task described by data instead of a closure, so it can be written to a
+// journal or sent to another process and rebuilt there.
+struct TaskSpec {
+    TaskTypeId type = UNREGISTERED_TASK_TYPE;
+    std::string arguments;  // Serialized by the caller, opaque to the pool
+    Priority priority = Priority::NORMAL;
+    std::vector<TaskId> dependencies;
+    std::optional<Task::TimePoint> deadline;
+    TaskClassId task_class = DEFAULT_TASK_CLASS;
+};
+
+/**
+ * Maps task type ids to the handlers that run them. Handlers receive the
+ * serialized arguments of the spec they were created from.
+ *
+ * Types are registered up front; lookups after that take no lock.
+ */
+class TaskRegistry {
+public:
+    using Handler = std::function<void(std::string_view arguments)>;
+
+    // Returns false for UNREGISTERED_TASK_TYPE or an id already in use.
+    bool register_type(TaskTypeId type, Handler handler);
+    bool contains(TaskTypeId type) const;
+
+    // Calls the handler for `type` directly; returns false if unknown.
+    bool invoke(TaskTypeId type, std::string_view arguments) const;
+
+    // Builds a runnable task from `spec`, or nullptr if its type is unknown.
+    std::unique_ptr<Task> create(const TaskSpec& spec) const;
+
+private:
+    std::unordered_map<TaskTypeId, std::shared_ptr<const Handler>> handlers_;
+};
+
+} // namespace taskscheduler
+
+#endif // TASKSCHEDULER_TASK_REGISTRY_HPP
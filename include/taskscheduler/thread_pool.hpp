@@ -4,11 +4,28 @@
 #include "task_queue.hpp"
 #include "dependency_tracker.hpp"
 #include "statistics.hpp"
+#include "admission_control.hpp"
+#include "runtime_estimator.hpp"
+#include "reactor.hpp"
+#include "trace.hpp"
+#include "journal.hpp"
+#include "result_cache.hpp"
+#include "batching.hpp"
+#include "perf_counters.hpp"
+#include "watchdog.hpp"
 #include <thread>
 #include <vector>
 #include <atomic>
 #include <future>
 #include <functional>
+#include <chrono>
+#include <optional>
+#include <mutex>
+#include <condition_variable>
+#include <list>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
 
 namespace taskscheduler {
 
@@ -16,8 +33,47 @@ namespace taskscheduler {
  * Thread pool with fixed worker count.
  * Processes tasks from a shared queue using multiple worker threads.
  * Supports task dependencies.
+ *
+ * Optional admission limits bound the number and estimated size of tasks
+ * held in the queue and the dependency tracker. When a submission does not
+ * fit, submit_with_id() returns INVALID_TASK_ID (or blocks, or sheds lower
+ * priority queued work, depending on the configured OverflowPolicy).
+ *
+ * A task's priority and deadline are inherited by its prerequisites at
+ * submit time, so urgent work is never stuck behind a low-priority
+ * dependency.
+ *
+ * Within a priority level, ready tasks with the longest remaining critical
+ * path run first. Path lengths are built from per-class runtime estimates
+ * learned from measured execution times (see Task::set_task_class).
+ *
+ * Tasks that wait on I/O can be parked on the pool's reactor with
+ * submit_when_ready() or submit_after() instead of blocking a worker; they
+ * are admitted at submit time and queued once their descriptor is ready.
+ *
+ * Tasks that must make blocking calls can announce them with
+ * blocking_region(); the pool then runs a temporary compensating worker
+ * so the rest of the queue keeps moving.
+ *
+ * Work that should not compete for the same workers, such as long
+ * blocking calls and short CPU-bound tasks, can be split into executor
+ * lanes with add_lane(). Each lane has its own queue and workers; tasks
+ * are routed by class or by naming the lane at submit, and dependencies
+ * work across lanes. The constructor's threads serve the "default" lane.
+ *
+ * Tasks built from a TaskRegistry with submit_registered() can be made
+ * durable by attaching a Journal: their submits, completions and
+ * cancellations are logged, and attach_journal() resubmits the tasks a
+ * previous process left unfinished under their original ids.
+ *
+ * Every worker publishes the task it is running and since when, so a hung
+ * task shows up in get_statistics() and get_worker_states() while it still
+ * runs; an optional watchdog (set_watchdog()) reports such tasks as they
+ * cross per-class thresholds.
  */
 class ThreadPool {
+    struct Lane;
+
 public:
     explicit ThreadPool(size_t num_threads = std::thread::hardware_concurrency());
     ~ThreadPool();
@@ -27,38 +83,343 @@ public:
 
     void start();
     void stop();
+
+    // Stops accepting work and waits for queued tasks, running tasks,
+    // tasks delayed with submit_after() and the dependents they release to
+    // finish before joining the workers. Tasks still waiting on a
+    // descriptor (submit_when_ready()) or on prerequisites that can no
+    // longer finish are dropped; use the timed form to get them back.
+    // stop() and the destructor shut down this way.
     void shutdown_graceful();
-    void shutdown_immediate();
+
+    // As above, but gives up draining after `drain_timeout` and falls back
+    // to an immediate shutdown. Returns the tasks that did not run, as
+    // shutdown_immediate() does.
+    std::vector<std::unique_ptr<Task>> shutdown_graceful(std::chrono::milliseconds drain_timeout);
+
+    // Stops dequeuing at once and joins each worker as soon as its current
+    // task finishes. Returns every task that did not run, from both the
+    // queue and the dependency tracker, prerequisites before dependents.
+    // Edges to prerequisites that finished here are removed; the others
+    // still use this pool's ids, so hand the tasks to another pool's
+    // resubmit() rather than submitting them one by one.
+    std::vector<std::unique_ptr<Task>> shutdown_immediate();
+
+    // Submits tasks handed back by another pool's shutdown, giving each a
+    // new id and pointing its dependencies at the new ids of the earlier
+    // tasks in `tasks`. A dependency on an id that is not among them, or
+    // whose task was not admitted, is not met and the dependent is not
+    // run. Returns the new ids in order, INVALID_TASK_ID where a task was
+    // not admitted.
+    std::vector<TaskId> resubmit(std::vector<std::unique_ptr<Task>> tasks);
+
     void submit(std::unique_ptr<Task> task);
     TaskId submit_with_id(std::unique_ptr<Task> task);
+
+    // Submits to the named lane regardless of the task's class. Returns
+    // INVALID_TASK_ID if no such lane exists.
+    TaskId submit_with_id(const std::string& lane, std::unique_ptr<Task> task);
+
+    // Adds a lane with its own queue and `num_threads` (at least one)
+    // workers, or returns false if the name is taken, 256 lanes exist
+    // already or the pool has started.
+    bool add_lane(const std::string& name, size_t num_threads);
+
+    // Routes tasks of `task_class` to the named lane unless submitted to a
+    // lane explicitly. Returns false if no such lane exists.
+    bool route_class(TaskClassId task_class, const std::string& lane);
+
+    std::vector<std::string> lane_names() const;
+
+    // Statistics of the tasks executed on one lane, with its own queue
+    // depth and blocked workers; std::nullopt if no such lane exists.
+    std::optional<StatisticsSnapshot> get_lane_statistics(const std::string& lane) const;
     bool cancel_task(TaskId id);
 
+    // Change the priority or deadline of a task that is still queued or
+    // waiting on prerequisites, keeping its id and dependency edges. The
+    // task is re-keyed in place; a task waiting on prerequisites passes a
+    // gain in urgency on to them. Returns false if the task is not queued
+    // or waiting (running, finished, parked on the reactor, or unknown).
+    bool update_priority(TaskId id, Priority priority);
+    bool update_deadline(TaskId id, Task::TimePoint deadline);
+
+    // Blocks until no admitted task is left: none queued, running, parked
+    // on the reactor or waiting on prerequisites. The timed form gives up
+    // after `timeout`. Returns false on timeout, and at once when called
+    // from one of the pool's own tasks, which would wait for itself.
+    bool wait_idle();
+    bool wait_idle(std::chrono::milliseconds timeout);
+
+    // Blocks until task `id` has finished: completed, been cancelled, or
+    // been handed back at shutdown. The timed form gives up after
+    // `timeout`. Returns false on timeout or for an id never assigned.
+    bool wait_for(TaskId id);
+    bool wait_for(TaskId id, std::chrono::milliseconds timeout);
+
+    // Queues `task` once `fd` is ready for `interest` (or reports an error
+    // or hang-up). Returns INVALID_TASK_ID if the task is not admitted or
+    // the descriptor cannot be watched; `fd` must stay open until then.
+    TaskId submit_when_ready(int fd, IoInterest interest, std::unique_ptr<Task> task);
+
+    // Queues `task` after `delay`, using a timerfd on the reactor.
+    TaskId submit_after(std::chrono::nanoseconds delay, std::unique_ptr<Task> task);
+
+    void set_admission_limits(const AdmissionLimits& limits);
+    AdmissionLimits admission_limits() const;
+
+    // When enabled, a worker whose task makes exactly one dependent ready
+    // runs that dependent itself unless more urgent work is queued.
+    void set_inline_continuations(bool enabled);
+    bool inline_continuations() const;
+
+    // When enabled, each worker reads per-thread counters (see PerfCounters)
+    // around every task and adds them to its class's totals, reported by
+    // get_task_class_counters(). Workers use hardware counters if the kernel
+    // grants them and software counters otherwise. Returns false once the
+    // pool has started.
+    bool set_performance_counters(bool enabled);
+    bool performance_counters() const;
+
     template<typename F, typename... Args>
     auto submit(F&& f, Args&&... args) -> std::future<typename std::invoke_result<F, Args...>::type>;
 
+    // Single-flight submit: while a task with the same key is queued or
+    // running, callers get its future instead of running another copy. A
+    // successful result may also be kept for later submits within the
+    // result cache limits. Every submit of a key must return the same type.
+    template<typename F, typename... Args>
+    auto submit_keyed(const std::string& key, F&& f, Args&&... args)
+        -> std::shared_future<typename std::invoke_result<F, Args...>::type>;
+
+    // Runs items submitted with submit_batched() for `task_class` as batches:
+    // one task calls `handler` with up to options.max_items items, or with
+    // those gathered within options.max_delay. Returns false if the class
+    // already has a handler or the pool has started.
+    template<typename Item, typename Result>
+    bool register_batch_handler(TaskClassId task_class, const BatchOptions& options,
+                                typename TypedBatchCollector<Item, Result>::Handler handler);
+
+    // Adds `item` to the open batch of `task_class` and returns its own
+    // result. Returns an invalid future if the class has no handler for
+    // these types.
+    template<typename Result, typename Item>
+    std::future<Result> submit_batched(TaskClassId task_class, Item item);
+
+    // Like submit_batched(), but nothing waits for the item's result, so it
+    // costs no promise or future. Returns false if the class has no handler
+    // for these types.
+    template<typename Result, typename Item>
+    bool post_batched(TaskClassId task_class, Item item);
+
+    // Submits every open batch now instead of waiting for it to fill up.
+    // Graceful shutdown does this first.
+    void flush_batches();
+
+    void set_result_cache_limits(const ResultCacheLimits& limits);
+    ResultCacheLimits result_cache_limits() const;
+    void clear_result_cache();
+
+    // Records every admitted submit and executed task to `recorder` until
+    // replaced or cleared with nullptr. The recorder must outlive its use.
+    void set_trace_recorder(TraceRecorder* recorder);
+
+    // Registry used by submit_registered() and journal recovery. Must
+    // outlive its use and not gain types while tasks are submitted.
+    void set_task_registry(const TaskRegistry* registry);
+
+    // Builds a task from `spec` and submits it. With a journal attached the
+    // submit is logged first and, if the journal's options ask for it, made
+    // durable before the task is queued. Returns INVALID_TASK_ID if no
+    // registry is set, the type is unknown, the task is not admitted or
+    // the journal cannot take the record.
+    TaskId submit_registered(const TaskSpec& spec);
+
+    // Resubmits the tasks `journal` recovered on open() and logs registered
+    // tasks to it from now on. Returns the number of tasks resubmitted;
+    // tasks whose type is not in the registry, and their dependents, stay
+    // in the journal for a later run. The journal must outlive its use.
+    size_t attach_journal(Journal& journal);
+
+    // Scoped notice that the calling worker is about to block. While the
+    // region is open the pool may start a compensating worker, up to
+    // max_compensating_workers(), which retires after the region closes.
+    // Nested regions and calls from threads other than this pool's workers
+    // have no effect.
+    class BlockingRegion {
+    public:
+        ~BlockingRegion();
+
+        BlockingRegion(const BlockingRegion&) = delete;
+        BlockingRegion& operator=(const BlockingRegion&) = delete;
+
+    private:
+        friend class ThreadPool;
+        BlockingRegion(ThreadPool* pool, Lane* lane);
+
+        ThreadPool* pool_;
+        Lane* lane_;
+        std::chrono::steady_clock::time_point start_time_;
+    };
+
+    BlockingRegion blocking_region();
+
+    // Defaults to the number of regular workers; 0 disables compensation.
+    void set_max_compensating_workers(size_t max_workers);
+    size_t max_compensating_workers() const;
+
     size_t thread_count() const;
     size_t pending_tasks() const;
     bool is_running() const;
 
+    // Lock-free: safe to call from monitoring threads at any rate.
     StatisticsSnapshot get_statistics() const;
     void reset_statistics();
 
+    // Lifetime counters and execution-time histogram, unaffected by
+    // reset_statistics().
+    CumulativeStatistics get_cumulative_statistics() const;
+
+    // Contention counters of the scheduler locks: one entry per lane queue,
+    // named "task_queue/<lane>", and one for "dependency_tracker". Empty
+    // unless the library was built with TASKSCHEDULER_LOCK_STATS.
+    std::vector<LockStatistics> get_lock_statistics() const;
+
+    // Counter totals per task class, by class id; empty unless
+    // set_performance_counters(true) was called before start().
+    std::vector<TaskClassCounters> get_task_class_counters() const;
+
+    // What every worker, fixed or compensating, is running right now and
+    // for how long. Each worker publishes this itself, so reading it never
+    // waits on a task.
+    std::vector<WorkerState> get_worker_states() const;
+
+    // Runs a watchdog thread while the pool is running that reports tasks
+    // over their class's threshold and workers stalled on one task while
+    // their lane has queued work (see WatchdogOptions). Events are counted
+    // in the statistics and passed to `callback`, if any, on the watchdog
+    // thread. Returns false once the pool has started.
+    bool set_watchdog(const WatchdogOptions& options, Watchdog::Callback callback = nullptr);
+
 private:
-    void worker_loop();
-    void process_ready_tasks();
+    struct Lane {
+        Lane(std::string lane_name, size_t threads) : name(std::move(lane_name)), num_threads(threads) {}
+
+        std::string name;
+        size_t num_threads;
+        TaskQueue queue;
+        std::vector<std::thread> threads;
+        Statistics statistics;
+        std::atomic<size_t> blocked_workers{0};
+        std::atomic<size_t> live_compensators{0};
+
+        // One per fixed worker, by index
+        std::unique_ptr<WorkerActivity[]> workers{new WorkerActivity[num_threads]};
+        size_t compensators_started = 0;  // Guarded by compensator_mutex_
+    };
+
+    struct Compensator {
+        std::thread thread;
+        std::atomic<bool> finished{false};
+        Lane* lane = nullptr;
+        size_t worker = 0;
+        WorkerActivity activity;
+    };
+
+    // Lane served by the current thread, if it is one of this pool's
+    // workers (see blocking_region)
+    static thread_local Lane* current_lane_;
 
-    TaskQueue task_queue_;
+    void worker_loop(Lane* lane, size_t worker);
+    void run_chain(Lane& lane, std::unique_ptr<Task> task);
+    void enter_blocking_region(Lane& lane);
+    void leave_blocking_region(Lane& lane, double blocked_time_ms);
+    void compensating_worker_loop(Lane* lane, Compensator* self);
+    bool retire_compensator(Lane& lane);
+    std::optional<LaneId> lane_index(const std::string& name) const;
+    TaskId submit_to_lane(std::optional<LaneId> lane, std::unique_ptr<Task> task);
+    void join_compensators();
+    std::unique_ptr<Task> run_task(Lane& lane, std::unique_ptr<Task> task);
+    void enqueue(std::unique_ptr<Task> task);
+    TaskId prepare(std::unique_ptr<Task>& task, std::optional<LaneId> lane = std::nullopt,
+                   TaskId recovered_id = INVALID_TASK_ID);
+    void journal_cancel(const Task& task);
+    bool update_task(TaskId id, std::optional<Priority> priority, std::optional<Task::TimePoint> deadline);
+    // Empty if the class has no handler for these types.
+    template<typename Result, typename Item>
+    std::optional<std::future<Result>> add_batched(TaskClassId task_class, Item item, bool with_future);
+    void submit_batch(TaskClassId task_class, BatchCollector::Taken batch);
+    void cancel_batch_timer(TaskId timer);
+    void schedule_batch_flush(TaskClassId task_class, const std::shared_ptr<BatchCollector>& collector,
+                              uint64_t generation);
+    void dispatch(std::unique_ptr<Task> task);
+    bool wait_for_drain(std::optional<std::chrono::steady_clock::time_point> deadline);
+    bool wait_idle_until(std::optional<std::chrono::steady_clock::time_point> deadline);
+    std::vector<std::unique_ptr<Task>> stop_workers(bool discard_queued);
+    void record_shutdown(std::chrono::steady_clock::time_point start_time);
+    bool admit(const Task& task);
+    std::unique_ptr<Task> shed_lowest(Priority priority);
+    void propagate_to_dependencies(const Task& task);
+    void release_task(const Task& task);
+    void release_tasks(const std::vector<std::unique_ptr<Task>>& tasks);
+    WorkerState worker_state(const Lane& lane, size_t worker, bool compensating,
+                             const WorkerActivity& activity,
+                             std::chrono::steady_clock::time_point now) const;
+    void longest_running(const Lane& lane, std::chrono::steady_clock::time_point now,
+                         StatisticsSnapshot& snapshot) const;
+    void on_watchdog_event(const WatchdogEvent& event);
+
+    // Lane 0 is the default lane. Lanes are only added before start(), so
+    // the vector is read without a lock afterwards.
+    std::vector<std::unique_ptr<Lane>> lanes_;
+    std::unordered_map<TaskClassId, LaneId> class_lanes_;
+
+    // Registered before start(), like lanes, and read without a lock
+    std::unordered_map<TaskClassId, std::shared_ptr<BatchCollector>> batch_collectors_;
     DependencyTracker dependency_tracker_;
     Statistics statistics_;
-    std::vector<std::thread> threads_;
+    AdmissionController admission_;
+    RuntimeEstimator runtime_estimator_;
     std::atomic<bool> running_{false};
+    std::atomic<bool> shutting_down_{false};
+    std::atomic<bool> stop_requested_{false};
+    std::atomic<bool> inline_continuations_{false};
+    bool performance_counters_ = false;
+    TaskClassCounterTable task_class_counters_;
+    std::atomic<TraceRecorder*> trace_recorder_{nullptr};
+    std::atomic<const TaskRegistry*> task_registry_{nullptr};
+    std::atomic<Journal*> journal_{nullptr};
+    std::shared_ptr<ResultCache> result_cache_ = std::make_shared<ResultCache>();
     size_t num_threads_;
+
+    std::mutex drain_mutex_;
+    std::condition_variable drain_cv_;
+
+    // wait_idle() sleepers, woken by the release that empties the pool
+    std::mutex idle_mutex_;
+    std::condition_variable idle_cv_;
+    std::atomic<size_t> idle_waiters_{0};
+
+    std::mutex unrun_mutex_;
+    std::vector<std::unique_ptr<Task>> unrun_tasks_;
+
+    std::atomic<size_t> max_compensating_workers_;
+    mutable std::mutex compensator_mutex_;
+    std::list<Compensator> compensators_;
+
+    // Configured before start(), like the performance counters
+    std::unique_ptr<Watchdog> watchdog_;
+    Watchdog::Callback watchdog_callback_;
+
+    // Last, so it stops dispatching before the rest is torn down
+    Reactor reactor_{[this](std::unique_ptr<Task> task) { dispatch(std::move(task)); }};
 };
 
 // Template implementation
 template<typename F, typename... Args>
 auto ThreadPool::submit(F&& f, Args&&... args) -> std::future<typename std::invoke_result<F, Args...>::type> {
     using return_type = typename std::invoke_result<F, Args...>::type;
+    using bound_type = decltype(std::bind(std::declval<F>(), std::declval<Args>()...));
 
     auto task = std::make_shared<std::packaged_task<return_type()>>(
         std::bind(std::forward<F>(f), std::forward<Args>(args)...)
@@ -66,7 +427,114 @@ auto ThreadPool::submit(F&& f, Args&&... args) -> std::future<typename std::invo
 
     std::future<return_type> result = task->get_future();
 
-    submit(std::make_unique<Task>([task]() { (*task)(); }));
+    auto wrapper = std::make_unique<Task>([task]() { (*task)(); });
+    wrapper->set_payload_bytes(sizeof(std::packaged_task<return_type()>) + sizeof(bound_type));
+    submit(std::move(wrapper));
+
+    return result;
+}
+
+template<typename Item, typename Result>
+bool ThreadPool::register_batch_handler(TaskClassId task_class, const BatchOptions& options,
+                                        typename TypedBatchCollector<Item, Result>::Handler handler) {
+    if (running_ || !handler || batch_collectors_.count(task_class) > 0) {
+        return false;
+    }
+    auto collector = std::make_shared<TypedBatchCollector<Item, Result>>(options, std::move(handler));
+    collector->set_observer([this](size_t items) { statistics_.record_coalesced_items(items); });
+    batch_collectors_.emplace(task_class, std::move(collector));
+    return true;
+}
+
+template<typename Result, typename Item>
+std::optional<std::future<Result>> ThreadPool::add_batched(TaskClassId task_class, Item item, bool with_future) {
+    auto it = batch_collectors_.find(task_class);
+    if (it == batch_collectors_.end()) {
+        return std::nullopt;
+    }
+    auto* collector = dynamic_cast<TypedBatchCollector<Item, Result>*>(it->second.get());
+    if (collector == nullptr) {
+        return std::nullopt;
+    }
+
+    auto added = collector->add(std::move(item), with_future);
+    if (added.full.task) {
+        submit_batch(task_class, std::move(added.full));
+    } else if (added.opened != 0) {
+        schedule_batch_flush(task_class, it->second, added.opened);
+    }
+    return std::move(added.future);
+}
+
+template<typename Result, typename Item>
+std::future<Result> ThreadPool::submit_batched(TaskClassId task_class, Item item) {
+    auto added = add_batched<Result>(task_class, std::move(item), true);
+    return added ? std::move(*added) : std::future<Result>();
+}
+
+template<typename Result, typename Item>
+bool ThreadPool::post_batched(TaskClassId task_class, Item item) {
+    return add_batched<Result>(task_class, std::move(item), false).has_value();
+}
+
+template<typename F, typename... Args>
+auto ThreadPool::submit_keyed(const std::string& key, F&& f, Args&&... args)
+    -> std::shared_future<typename std::invoke_result<F, Args...>::type> {
+    using return_type = typename std::invoke_result<F, Args...>::type;
+    using bound_type = decltype(std::bind(std::declval<F>(), std::declval<Args>()...));
+
+    auto work = std::make_shared<bound_type>(std::bind(std::forward<F>(f), std::forward<Args>(args)...));
+    auto promise = std::make_shared<std::promise<return_type>>();
+
+    std::shared_future<return_type> result = promise->get_future().share();
+    std::any shared = result;
+    std::shared_ptr<ResultCache::Ticket> ticket;
+    switch (result_cache_->acquire(key, shared, ticket)) {
+        case ResultCache::Lookup::HIT:
+            statistics_.record_result_cache_hit();
+            return std::any_cast<std::shared_future<return_type>>(shared);
+        case ResultCache::Lookup::IN_FLIGHT:
+            statistics_.record_deduplicated_submit();
+            return std::any_cast<std::shared_future<return_type>>(shared);
+        case ResultCache::Lookup::MISS:
+        default:
+            break;
+    }
+
+    // The ticket is settled before the future becomes ready, so a caller
+    // that saw the result also sees it cached (or, on failure, forgotten).
+    // A task that is rejected or never runs drops its ticket, and with it
+    // the key, when it is destroyed; its waiters see a broken promise.
+    auto wrapper = std::make_unique<Task>([work, promise, ticket]() {
+        try {
+            if constexpr (std::is_void_v<return_type>) {
+                (*work)();
+                if (ticket) {
+                    ticket->complete();
+                }
+                promise->set_value();
+            } else {
+                return_type value = (*work)();
+                if (ticket) {
+                    ticket->complete();
+                }
+                promise->set_value(std::move(value));
+            }
+        } catch (...) {
+            if (ticket) {
+                ticket->abandon();
+            }
+            promise->set_exception(std::current_exception());
+        }
+    });
+    wrapper->set_payload_bytes(sizeof(std::promise<return_type>) + sizeof(bound_type) + key.size());
+    if (submit_with_id(std::move(wrapper)) == INVALID_TASK_ID) {
+        return result;
+    }
+    if (ticket) {
+        ticket->submitted();
+    }
+    statistics_.record_result_cache_miss();
 
     return result;
 }
@@ -0,0 +1,71 @@
+#ifndef TASKSCHEDULER_TRACE_HPP
+#define TASKSCHEDULER_TRACE_HPP
+
+#include "task.hpp"
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace taskscheduler {
+
+enum class TraceEventType : uint8_t {
+    SUBMIT = 1,
+    COMPLETE = 2
+};
+
+struct TraceEvent {
+    TraceEventType type;
+    int64_t timestamp_ns;         // Since the recorder was created
+    TaskId task_id;
+
+    // SUBMIT only
+    Priority priority;
+    TaskClassId task_class;
+    std::optional<int64_t> deadline_ns;  // Relative to timestamp_ns
+    std::vector<TaskId> dependencies;
+
+    // COMPLETE only: measured execution time
+    int64_t duration_ns;
+};
+
+/**
+ * Records a pool's workload as a compact binary trace: every submit with
+ * its priority, deadline, dependencies and class, and the execution time
+ * of every task that ran. Attach with ThreadPool::set_trace_recorder().
+ *
+ * Events are encoded on append into one buffer (32 bytes per event plus
+ * 8 per dependency) under a short lock. The file format is that buffer
+ * behind a magic and version header, in host byte order.
+ */
+class TraceRecorder {
+public:
+    TraceRecorder();
+
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    void record_submit(const Task& task);
+    void record_completion(const Task& task, std::chrono::nanoseconds duration);
+
+    size_t event_count() const;
+    std::vector<TraceEvent> events() const;
+    void clear();
+
+    bool write(const std::string& path) const;
+    static std::optional<std::vector<TraceEvent>> read(const std::string& path);
+
+private:
+    int64_t now_ns() const;
+
+    std::chrono::steady_clock::time_point start_time_;
+    mutable std::mutex mutex_;
+    std::vector<uint8_t> buffer_;
+    size_t event_count_ = 0;
+};
+
+} // namespace taskscheduler
+
+#endif // TASKSCHEDULER_TRACE_HPP
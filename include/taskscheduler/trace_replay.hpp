@@ -0,0 +1,48 @@
+#ifndef TASKSCHEDULER_TRACE_REPLAY_HPP
+#define TASKSCHEDULER_TRACE_REPLAY_HPP
+
+#include "thread_pool.hpp"
+#include "trace.hpp"
+#include <chrono>
+#include <vector>
+
+namespace taskscheduler {
+
+struct ReplayOptions {
+    // Multiplier on the recorded gaps between submits; 0 submits the whole
+    // trace at once.
+    double time_scale = 1.0;
+
+    // Give up waiting for completions after this long.
+    std::chrono::milliseconds timeout{60000};
+};
+
+struct ReplayReport {
+    size_t submitted_tasks;
+    size_t completed_tasks;
+    double makespan_ms;             // First submit to last completion
+    double throughput_per_second;   // completed_tasks / makespan
+
+    // Submit-to-completion latency
+    double latency_p50_ms;
+    double latency_p90_ms;
+    double latency_p99_ms;
+    double latency_max_ms;
+};
+
+/**
+ * Resubmits a recorded trace to `pool` with the recorded priorities,
+ * relative deadlines, classes and dependencies. Each task body spins for
+ * its recorded execution time; tasks that never completed in the trace
+ * run empty. Dependencies on tasks outside the trace are dropped.
+ *
+ * Returns once every submitted task has completed or options.timeout
+ * expires. The pool must be idle and not shared with other work while
+ * replaying.
+ */
+ReplayReport replay_trace(const std::vector<TraceEvent>& events, ThreadPool& pool,
+                          const ReplayOptions& options = {});
+
+} // namespace taskscheduler
+
+#endif // TASKSCHEDULER_TRACE_REPLAY_HPP
@@ -0,0 +1,148 @@
+#ifndef TASKSCHEDULER_WATCHDOG_HPP
+#define TASKSCHEDULER_WATCHDOG_HPP
+
+#include "task_class.hpp"
+#include "task_id.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace taskscheduler {
+
+/**
+ * What one worker is doing, published by that worker and readable from
+ * any thread without locks.
+ *
+ * The worker is the only writer. Each update bumps a sequence number to
+ * an odd value, stores the fields and bumps it to even again; readers
+ * retry until they see the same even value before and after reading.
+ * Aligned to a cache line so neighbouring workers do not share one.
+ */
+class alignas(64) WorkerActivity {
+public:
+    struct Reading {
+        TaskId task = INVALID_TASK_ID;  // INVALID_TASK_ID while idle
+        TaskClassId task_class = DEFAULT_TASK_CLASS;
+        std::chrono::steady_clock::time_point started;
+        uint64_t tasks_started = 0;
+        bool blocking = false;
+    };
+
+    // Called by the worker around each task and blocking region
+    void begin(TaskId task, TaskClassId task_class, std::chrono::steady_clock::time_point started);
+    void end();
+    void set_blocking(bool blocking);
+
+    Reading read() const;
+
+private:
+    void begin_update();
+    void end_update();
+
+    std::atomic<uint64_t> sequence_{0};
+    std::atomic<TaskId> task_{INVALID_TASK_ID};
+    std::atomic<TaskClassId> task_class_{DEFAULT_TASK_CLASS};
+    std::atomic<int64_t> started_ns_{0};
+    std::atomic<uint64_t> tasks_started_{0};
+    std::atomic<bool> blocking_{false};
+};
+
+// One worker's activity at the time it was read
+struct WorkerState {
+    std::string lane;
+    size_t worker = 0;  // Fixed workers first; compensating ones are numbered on from there, never reused
+    bool compensating = false;
+    TaskId task = INVALID_TASK_ID;  // INVALID_TASK_ID while idle
+    TaskClassId task_class = DEFAULT_TASK_CLASS;
+    double running_ms = 0.0;
+    uint64_t tasks_started = 0;
+    bool blocking = false;   // Inside a blocking region
+    size_t lane_queue_depth = 0;
+};
+
+struct WatchdogOptions {
+    // How often workers are checked
+    std::chrono::milliseconds interval{1000};
+
+    // A task running longer than the threshold of its class is reported
+    // once. Classes not listed use default_threshold; zero disables.
+    std::chrono::milliseconds default_threshold{0};
+    std::unordered_map<TaskClassId, std::chrono::milliseconds> class_thresholds;
+
+    // A worker is reported as stalled once it has run the same task for
+    // this long while its lane has queued work, outside a blocking region
+    // (those are covered by compensating workers). Zero disables.
+    std::chrono::milliseconds stall_timeout{0};
+
+    std::chrono::milliseconds threshold(TaskClassId task_class) const;
+};
+
+struct WatchdogEvent {
+    enum class Kind {
+        LONG_RUNNING_TASK,
+        STALLED_WORKER
+    };
+
+    Kind kind;
+    WorkerState worker;
+};
+
+/**
+ * Checks worker activity at a fixed interval on a thread of its own and
+ * reports tasks that run too long and workers that stopped making
+ * progress. Each condition is reported once per task a worker runs.
+ */
+class Watchdog {
+public:
+    using Sampler = std::function<std::vector<WorkerState>()>;
+    using Callback = std::function<void(const WatchdogEvent&)>;
+
+    explicit Watchdog(WatchdogOptions options);
+    ~Watchdog();
+
+    Watchdog(const Watchdog&) = delete;
+    Watchdog& operator=(const Watchdog&) = delete;
+
+    // Calls check(sampler()) every options.interval and hands each event
+    // to `callback` until stop().
+    void start(Sampler sampler, Callback callback);
+    void stop();
+
+    // One round of checks. Remembers what it reported, so must not be
+    // called while the thread is running.
+    std::vector<WatchdogEvent> check(const std::vector<WorkerState>& workers);
+
+    const WatchdogOptions& options() const { return options_; }
+
+private:
+    // Tasks started count of the task last reported, per condition
+    struct Reported {
+        uint64_t long_running = 0;
+        uint64_t stalled = 0;
+    };
+
+    void run();
+
+    WatchdogOptions options_;
+    Sampler sampler_;
+    Callback callback_;
+    std::map<std::pair<std::string, size_t>, Reported> reported_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopping_ = false;
+    std::thread thread_;
+};
+
+} // namespace taskscheduler
+
+#endif // TASKSCHEDULER_WATCHDOG_HPP
@@ -0,0 +1,101 @@
+#include "taskscheduler/admission_control.hpp"
+
+namespace taskscheduler {
+
+void AdmissionController::set_limits(const AdmissionLimits& limits) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        limits_ = limits;
+        max_pending_tasks_.store(limits.max_pending_tasks);
+        max_pending_bytes_.store(limits.max_pending_bytes);
+    }
+    cv_.notify_all();
+}
+
+AdmissionLimits AdmissionController::limits() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return limits_;
+}
+
+bool AdmissionController::try_acquire(size_t bytes) {
+    return !closed_.load() && reserve(bytes, false);
+}
+
+bool AdmissionController::acquire(size_t bytes) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    waiters_.fetch_add(1);
+    bool closed = false;
+    cv_.wait(lock, [this, bytes, &closed] {
+        closed = closed_.load();
+        return closed || reserve(bytes, true);
+    });
+    waiters_.fetch_sub(1);
+    return !closed;
+}
+
+size_t AdmissionController::release(size_t bytes) {
+    size_t remaining = pending_tasks_.fetch_sub(1) - 1;
+    pending_bytes_.fetch_sub(bytes);
+    wake_waiters();
+    return remaining;
+}
+
+void AdmissionController::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_.store(true);
+    }
+    cv_.notify_all();
+}
+
+size_t AdmissionController::pending_tasks() const {
+    // Sequentially consistent so ThreadPool::wait_idle() can order its
+    // check against release()
+    return pending_tasks_.load();
+}
+
+size_t AdmissionController::pending_bytes() const {
+    return pending_bytes_.load(std::memory_order_relaxed);
+}
+
+bool AdmissionController::reserve(size_t bytes, bool locked) {
+    size_t max_tasks = max_pending_tasks_.load();
+    size_t max_bytes = max_pending_bytes_.load();
+    if (max_tasks == 0 && max_bytes == 0) {
+        pending_tasks_.fetch_add(1);
+        pending_bytes_.fetch_add(bytes);
+        return true;
+    }
+
+    size_t tasks = pending_tasks_.load();
+    do {
+        if (max_tasks != 0 && tasks + 1 > max_tasks) {
+            return false;
+        }
+    } while (!pending_tasks_.compare_exchange_weak(tasks, tasks + 1));
+
+    // An oversized task is still admitted into an empty pool so it cannot
+    // be blocked forever.
+    size_t used = pending_bytes_.load();
+    do {
+        if (max_bytes != 0 && tasks != 0 && used + bytes > max_bytes) {
+            // Hand the task slot back; a waiter may have seen it taken
+            pending_tasks_.fetch_sub(1);
+            if (!locked) {
+                wake_waiters();
+            }
+            return false;
+        }
+    } while (!pending_bytes_.compare_exchange_weak(used, used + bytes));
+    return true;
+}
+
+void AdmissionController::wake_waiters() {
+    // Only pay for the mutex when a submitter is actually blocked
+    if (waiters_.load() != 0) {
+        { std::lock_guard<std::mutex> lock(mutex_); }
+        cv_.notify_all();
+    }
+}
+
+} // namespace taskscheduler
@@ -0,0 +1,328 @@
+#include "taskscheduler/completion_set.hpp"
+#include <algorithm>
+#include <iterator>
+#include <thread>
+
+namespace taskscheduler {
+
+namespace {
+
+constexpr uint64_t ALL_BITS = ~uint64_t{0};
+
+// Bits below `bit` of a 64-bit word
+uint64_t bits_below(TaskId bit) {
+    return (uint64_t{1} << (bit % 64)) - 1;
+}
+
+} // namespace
+
+CompletionSet::CompletionSet() {
+    for (size_t i = 0; i < WINDOW_PAGES; ++i) {
+        window_[i].page.store(i, std::memory_order_relaxed);
+    }
+    // INVALID_TASK_ID sits below the initial watermark
+    window_[0].words[0].store(bits_below(watermark_.load(std::memory_order_relaxed)),
+                              std::memory_order_relaxed);
+}
+
+void CompletionSet::insert(TaskId id) {
+    if (id < watermark_.load()) {
+        return;
+    }
+
+    switch (insert_in_slot(id)) {
+    case SlotResult::INSERTED:
+        return;
+    case SlotResult::FILLED: {
+        std::lock_guard<std::mutex> lock(mutex_);
+        retire_slot_locked(id / PAGE_BITS);
+        advance_locked();
+        return;
+    }
+    case SlotResult::MISSED: {
+        std::lock_guard<std::mutex> lock(mutex_);
+        insert_locked(id);
+        advance_locked();
+        return;
+    }
+    }
+}
+
+void CompletionSet::insert_range(TaskId begin, TaskId end) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    begin = std::max(begin, watermark_.load(std::memory_order_relaxed));
+    if (begin >= end) {
+        return;
+    }
+
+    // Whole pages in the middle become a run; the partial ends go bit by bit
+    TaskId first_full = (begin + PAGE_BITS - 1) / PAGE_BITS;
+    TaskId last_full = end / PAGE_BITS;
+    if (first_full < last_full) {
+        for (TaskId id = begin; id < first_full * PAGE_BITS; ++id) {
+            insert_locked(id);
+        }
+        add_full_pages_locked(first_full, last_full);
+        begin = last_full * PAGE_BITS;
+    }
+    for (TaskId id = begin; id < end; ++id) {
+        insert_locked(id);
+    }
+    advance_locked();
+    refresh_window_locked();  // Slots whose page the run covered
+}
+
+bool CompletionSet::contains(TaskId id) const {
+    if (id < watermark_.load()) {
+        return true;
+    }
+
+    TaskId page = id / PAGE_BITS;
+    Slot& slot = slot_of(page);
+    slot.users.fetch_add(1);
+    bool held = slot.page.load() == page;
+    bool found = held && test_bit(slot, id);
+    slot.users.fetch_sub(1);
+    if (held) {
+        return found;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (id < watermark_.load(std::memory_order_relaxed)) {
+        return true;
+    }
+    if (slot.page.load(std::memory_order_relaxed) == page) {
+        return test_bit(slot, id);
+    }
+    if (in_full_run_locked(page)) {
+        return true;
+    }
+    auto it = pages_.find(page);
+    if (it == pages_.end()) {
+        return false;
+    }
+    TaskId bit = id % PAGE_BITS;
+    return (it->second.words[bit / 64] >> (bit % 64)) & 1;
+}
+
+TaskId CompletionSet::watermark() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return scan_watermark_locked(watermark_.load(std::memory_order_relaxed));
+}
+
+size_t CompletionSet::page_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t count = pages_.size();
+    for (const Slot& slot : window_) {
+        size_t bits = 0;
+        for (const auto& word : slot.words) {
+            bits += static_cast<size_t>(__builtin_popcountll(word.load(std::memory_order_relaxed)));
+        }
+        if (bits > 0 && bits < PAGE_BITS) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+CompletionSet::SlotResult CompletionSet::insert_in_slot(TaskId id) {
+    TaskId page = id / PAGE_BITS;
+    Slot& slot = slot_of(page);
+    slot.users.fetch_add(1);
+    SlotResult result = SlotResult::MISSED;
+    if (slot.page.load() == page) {
+        result = set_bit(slot, id);
+    }
+    slot.users.fetch_sub(1);
+    return result;
+}
+
+CompletionSet::SlotResult CompletionSet::set_bit(Slot& slot, TaskId id) {
+    TaskId bit = id % PAGE_BITS;
+    uint64_t mask = uint64_t{1} << (bit % 64);
+    uint64_t old = slot.words[bit / 64].fetch_or(mask);
+    if ((old & mask) == 0 && (old | mask) == ALL_BITS &&
+        slot.full_words.fetch_add(1) + 1 == PAGE_WORDS) {
+        return SlotResult::FILLED;
+    }
+    return SlotResult::INSERTED;
+}
+
+bool CompletionSet::test_bit(const Slot& slot, TaskId id) {
+    TaskId bit = id % PAGE_BITS;
+    return (slot.words[bit / 64].load() >> (bit % 64)) & 1;
+}
+
+void CompletionSet::insert_locked(TaskId id) {
+    if (id < watermark_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    TaskId page_number = id / PAGE_BITS;
+    Slot& slot = slot_of(page_number);
+    if (slot.page.load(std::memory_order_relaxed) == page_number) {
+        if (set_bit(slot, id) == SlotResult::FILLED) {
+            retire_slot_locked(page_number);
+        }
+        return;
+    }
+    if (in_full_run_locked(page_number)) {
+        return;
+    }
+
+    Page& page = page_locked(page_number);
+    TaskId bit = id % PAGE_BITS;
+    uint64_t mask = uint64_t{1} << (bit % 64);
+    if (page.words[bit / 64] & mask) {
+        return;
+    }
+    page.words[bit / 64] |= mask;
+    if (++page.count == PAGE_BITS) {
+        add_full_pages_locked(page_number, page_number + 1);
+    }
+}
+
+CompletionSet::Page& CompletionSet::page_locked(TaskId page_number) {
+    // The watermark's page is always in the window, so a page created
+    // here has nothing below the watermark to fill in.
+    return pages_[page_number];
+}
+
+void CompletionSet::add_full_pages_locked(TaskId first, TaskId last) {
+    pages_.erase(pages_.lower_bound(first), pages_.lower_bound(last));
+
+    // Merge with the runs this one overlaps or touches
+    auto it = full_runs_.upper_bound(first);
+    if (it != full_runs_.begin() && std::prev(it)->second >= first) {
+        --it;
+        first = it->first;
+        last = std::max(last, it->second);
+        it = full_runs_.erase(it);
+    }
+    while (it != full_runs_.end() && it->first <= last) {
+        last = std::max(last, it->second);
+        it = full_runs_.erase(it);
+    }
+    full_runs_.emplace(first, last);
+}
+
+void CompletionSet::advance_locked() {
+    TaskId old_watermark = watermark_.load(std::memory_order_relaxed);
+    TaskId watermark = scan_watermark_locked(old_watermark);
+    if (watermark == old_watermark) {
+        return;
+    }
+    watermark_.store(watermark);
+
+    // Runs and pages the watermark passed are no longer needed
+    while (!full_runs_.empty() && full_runs_.begin()->second * PAGE_BITS <= watermark) {
+        full_runs_.erase(full_runs_.begin());
+    }
+    pages_.erase(pages_.begin(), pages_.lower_bound(watermark / PAGE_BITS));
+    if (watermark / PAGE_BITS != old_watermark / PAGE_BITS) {
+        refresh_window_locked();
+    }
+}
+
+TaskId CompletionSet::scan_watermark_locked(TaskId from) const {
+    TaskId watermark = from;
+    for (;;) {
+        TaskId page_number = watermark / PAGE_BITS;
+        auto run = full_runs_.upper_bound(page_number);
+        if (run != full_runs_.begin() && std::prev(run)->second > page_number) {
+            watermark = std::prev(run)->second * PAGE_BITS;
+            continue;
+        }
+
+        // Stop at the first gap of the watermark's page, if it has one
+        TaskId bit = watermark % PAGE_BITS;
+        const Slot& slot = slot_of(page_number);
+        auto it = pages_.find(page_number);
+        bool in_window = slot.page.load(std::memory_order_relaxed) == page_number;
+        if (!in_window && it == pages_.end()) {
+            return watermark;
+        }
+        for (size_t word = bit / 64; word < PAGE_WORDS; ++word) {
+            uint64_t bits = in_window ? slot.words[word].load() : it->second.words[word];
+            if (word == bit / 64) {
+                bits |= bits_below(bit);
+            }
+            if (bits != ALL_BITS) {
+                return page_number * PAGE_BITS + word * 64 + static_cast<TaskId>(__builtin_ctzll(~bits));
+            }
+        }
+        watermark = (page_number + 1) * PAGE_BITS;  // Filled, not yet retired
+    }
+}
+
+bool CompletionSet::in_full_run_locked(TaskId page) const {
+    auto it = full_runs_.upper_bound(page);
+    return it != full_runs_.begin() && std::prev(it)->second > page;
+}
+
+void CompletionSet::retire_slot_locked(TaskId page) {
+    Slot& slot = slot_of(page);
+    if (slot.page.load(std::memory_order_relaxed) != page) {
+        return;  // Retagged since it filled
+    }
+    add_full_pages_locked(page, page + 1);
+    retag_locked(slot, page);
+}
+
+void CompletionSet::refresh_window_locked() {
+    for (size_t i = 0; i < WINDOW_PAGES; ++i) {
+        Slot& slot = window_[i];
+        TaskId page = slot.page.load(std::memory_order_relaxed);
+        if (page < watermark_.load(std::memory_order_relaxed) / PAGE_BITS || in_full_run_locked(page)) {
+            retag_locked(slot, page);
+        }
+    }
+}
+
+void CompletionSet::retag_locked(Slot& slot, TaskId page) {
+    slot.page.store(RETIRING);
+    while (slot.users.load() != 0) {
+        std::this_thread::yield();
+    }
+
+    // The slot now serves the lowest page of its residue class that is
+    // neither below the watermark nor already finished
+    TaskId watermark = watermark_.load(std::memory_order_relaxed);
+    TaskId watermark_page = watermark / PAGE_BITS;
+    TaskId index = page % WINDOW_PAGES;
+    page = watermark_page + (index + WINDOW_PAGES - watermark_page % WINDOW_PAGES) % WINDOW_PAGES;
+    for (;;) {
+        auto run = full_runs_.upper_bound(page);
+        if (run != full_runs_.begin() && std::prev(run)->second > page) {
+            TaskId end = std::prev(run)->second;
+            page = end + (index + WINDOW_PAGES - end % WINDOW_PAGES) % WINDOW_PAGES;
+            continue;
+        }
+
+        std::array<uint64_t, PAGE_WORDS> words{};
+        auto it = pages_.find(page);
+        if (it != pages_.end()) {
+            words = it->second.words;
+            pages_.erase(it);
+        }
+        if (page == watermark_page) {
+            TaskId bit = watermark % PAGE_BITS;
+            std::fill(words.begin(), words.begin() + static_cast<std::ptrdiff_t>(bit / 64), ALL_BITS);
+            words[bit / 64] |= bits_below(bit);
+        }
+
+        uint32_t full_words = 0;
+        for (size_t word = 0; word < PAGE_WORDS; ++word) {
+            slot.words[word].store(words[word], std::memory_order_relaxed);
+            full_words += words[word] == ALL_BITS ? 1 : 0;
+        }
+        if (full_words == PAGE_WORDS) {
+            add_full_pages_locked(page, page + 1);
+            continue;
+        }
+        slot.full_words.store(full_words, std::memory_order_relaxed);
+        slot.page.store(page);
+        return;
+    }
+}
+
+} // namespace taskscheduler
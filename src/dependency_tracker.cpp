@@ -1,81 +1,511 @@
 #include "taskscheduler/dependency_tracker.hpp"
+#include <algorithm>
 
 namespace taskscheduler {
 
+namespace {
+
+// Smallest growth, relative to its current length, of a pending task's
+// critical path that is passed on to its own prerequisites. Along a chain
+// of equal estimates the growth at depth k is 1/k, so a new tail reaches
+// at most this many levels back.
+constexpr double MIN_PATH_GROWTH = 1.0 / 16;
+
+// Calls `fn` once for each distinct id in `ids`. Short lists, the common
+// case, are checked pairwise without allocating.
+template<typename Fn>
+void for_each_distinct(const TaskIdList& ids, Fn&& fn) {
+    if (ids.size() <= 16) {
+        for (size_t i = 0; i < ids.size(); ++i) {
+            if (std::find(ids.begin(), ids.begin() + i, ids[i]) == ids.begin() + i) {
+                fn(ids[i]);
+            }
+        }
+        return;
+    }
+
+    std::vector<TaskId> sorted(ids.begin(), ids.end());
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+    for (TaskId id : sorted) {
+        fn(id);
+    }
+}
+
+} // namespace
+
 TaskId DependencyTracker::assign_id(std::unique_ptr<Task>& task) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<SchedulerMutex> lock(mutex_);
     TaskId id = next_id_++;
     task->set_id(id);
     return id;
 }
 
-void DependencyTracker::add_task(std::unique_ptr<Task> task) {
-    std::lock_guard<std::mutex> lock(mutex_);
+void DependencyTracker::reserve_ids(TaskId next_id, const std::vector<TaskId>& outstanding) {
+    std::lock_guard<SchedulerMutex> lock(mutex_);
+    if (next_id <= next_id_) {
+        return;
+    }
 
-    TaskId task_id = task->id();
-    const auto& deps = task->dependencies();
+    std::vector<TaskId> skipped_outstanding;
+    for (TaskId id : outstanding) {
+        if (id >= next_id_ && id < next_id) {
+            skipped_outstanding.push_back(id);
+        }
+    }
+    std::sort(skipped_outstanding.begin(), skipped_outstanding.end());
+
+    TaskId begin = next_id_;
+    for (TaskId id : skipped_outstanding) {
+        mark_finished_range(begin, id);
+        begin = id + 1;
+    }
+    mark_finished_range(begin, next_id);
+    next_id_ = next_id;
+}
 
+std::unique_ptr<Task> DependencyTracker::add_task(std::unique_ptr<Task> task) {
+    std::lock_guard<SchedulerMutex> lock(mutex_);
+
+    TaskId task_id = task->id();
+    const auto& deps = task->dependency_list();
     if (deps.empty()) {
-        return;
+        return task;
+    }
+
+    // An id never handed out, such as the INVALID_TASK_ID of a rejected
+    // submit, would never finish. Checked before node_slot(), whose index
+    // uses INVALID_TASK_ID to mark empty entries.
+    if (std::any_of(deps.begin(), deps.end(), [this](TaskId dep_id) {
+            return dep_id == INVALID_TASK_ID || dep_id >= next_id_;
+        })) {
+        task->cancel();
+        return task;
     }
 
-    remaining_dependencies_[task_id] = deps.size();
+    // Register first and publish, then drop the edges to prerequisites that
+    // have finished; see finished_. A prerequisite listed twice counts once.
+    // Indices, not references: node_slot() may grow nodes_.
+    uint32_t slot = node_slot(task_id);
+    Edge edge{slot, nodes_[slot].generation};
+    for_each_distinct(deps, [this, edge](TaskId dep_id) {
+        Node& target = nodes_[node_slot(dep_id)];
+        target.dependents.push_back(edge);
+        if (target.live_edges++ == 0) {
+            ++target_nodes_;
+        }
+        ++nodes_[edge.slot].remaining;
+    });
+    publish_sizes();
+
+    for_each_distinct(deps, [this, slot](TaskId dep_id) {
+        if (!finished_.contains(dep_id)) {
+            return;
+        }
+        // Nothing else touched its dependents since, so ours is last
+        uint32_t target = slots_.find(dep_id);
+        if (target != NO_SLOT && !nodes_[target].dependents.empty()) {
+            nodes_[target].dependents.pop_back();
+            drop_edge(dep_id);
+            --nodes_[slot].remaining;
+        }
+    });
 
-    for (TaskId dep_id : deps) {
-        dependents_[dep_id].insert(task_id);
+    if (nodes_[slot].remaining == 0) {
+        release_if_unused(slot);
+        publish_sizes();
+        return task;
     }
 
-    pending_tasks_[task_id] = std::move(task);
+    nodes_[slot].task = std::move(task);
+    ++pending_nodes_;
+    publish_sizes();
+    return nullptr;
 }
 
 std::vector<std::unique_ptr<Task>> DependencyTracker::get_ready_tasks() {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<SchedulerMutex> lock(mutex_);
     std::vector<std::unique_ptr<Task>> ready;
 
-    for (auto it = pending_tasks_.begin(); it != pending_tasks_.end(); ) {
-        TaskId task_id = it->first;
-        if (remaining_dependencies_[task_id] == 0) {
-            ready.push_back(std::move(it->second));
-            remaining_dependencies_.erase(task_id);
-            it = pending_tasks_.erase(it);
-        } else {
-            ++it;
+    for (uint32_t slot = 0; slot < nodes_.size(); ++slot) {
+        Node& node = nodes_[slot];
+        if (node.task && node.remaining == 0) {
+            ready.push_back(std::move(node.task));
+            --pending_nodes_;
+            release_if_unused(slot);
         }
     }
+    publish_sizes();
 
     return ready;
 }
 
 void DependencyTracker::mark_completed(TaskId task_id) {
-    std::lock_guard<std::mutex> lock(mutex_);
-
-    auto it = dependents_.find(task_id);
-    if (it != dependents_.end()) {
-        for (TaskId dependent_id : it->second) {
-            auto dep_it = remaining_dependencies_.find(dependent_id);
-            if (dep_it != remaining_dependencies_.end()) {
-                dep_it->second--;
-            }
+    mark_finished(task_id);
+    std::lock_guard<SchedulerMutex> lock(mutex_);
+    resolve_dependents(task_id, false);
+}
+
+std::vector<std::unique_ptr<Task>> DependencyTracker::complete(TaskId task_id) {
+    // Sequentially consistent against add_task's publish-then-check; see
+    // finished_
+    mark_finished(task_id);
+    if (tracked_targets_.load() == 0) {
+        return {};
+    }
+
+    std::lock_guard<SchedulerMutex> lock(mutex_);
+    return resolve_dependents(task_id, true);
+}
+
+void DependencyTracker::retire(TaskId task_id) {
+    mark_finished(task_id);
+}
+
+bool DependencyTracker::is_finished(TaskId task_id) const {
+    return finished_.contains(task_id);
+}
+
+bool DependencyTracker::wait_finished(
+    TaskId task_id, std::optional<std::chrono::steady_clock::time_point> deadline) const {
+    {
+        // An id not handed out yet may never be
+        std::lock_guard<SchedulerMutex> lock(mutex_);
+        if (task_id == INVALID_TASK_ID || task_id >= next_id_) {
+            return false;
         }
-        dependents_.erase(it);
     }
+
+    std::unique_lock<std::mutex> lock(waiters_mutex_);
+    Waiter& waiter = waiters_[task_id];  // Node stays put while others come and go
+    ++waiter.count;
+    waiter_count_.fetch_add(1);
+
+    auto finished = [this, task_id] { return finished_.contains(task_id); };
+    bool done = true;
+    if (deadline.has_value()) {
+        done = waiter.cv.wait_until(lock, deadline.value(), finished);
+    } else {
+        waiter.cv.wait(lock, finished);
+    }
+
+    waiter_count_.fetch_sub(1);
+    if (--waiter.count == 0) {
+        waiters_.erase(task_id);
+    }
+    return done;
 }
 
 bool DependencyTracker::has_pending_tasks() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return !pending_tasks_.empty();
+    std::lock_guard<SchedulerMutex> lock(mutex_);
+    return pending_nodes_ > 0;
+}
+
+size_t DependencyTracker::pending_count() const {
+    return pending_size_.load(std::memory_order_acquire);
 }
 
 bool DependencyTracker::cancel_task(TaskId id) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    return !remove_task(id).empty();
+}
+
+std::vector<std::unique_ptr<Task>> DependencyTracker::remove_task(TaskId id) {
+    std::lock_guard<SchedulerMutex> lock(mutex_);
+    std::vector<std::unique_ptr<Task>> removed;
+
+    uint32_t slot = slots_.find(id);
+    if (slot == NO_SLOT || !nodes_[slot].task) {
+        return removed;
+    }
+
+    removed.push_back(remove_pending(slot));
+    cancel_dependents_locked(id, removed);
+    return removed;
+}
+
+std::vector<std::unique_ptr<Task>> DependencyTracker::cancel_dependents(TaskId id) {
+    std::lock_guard<SchedulerMutex> lock(mutex_);
+    std::vector<std::unique_ptr<Task>> removed;
+    cancel_dependents_locked(id, removed);
+    return removed;
+}
+
+std::vector<std::unique_ptr<Task>> DependencyTracker::drain() {
+    std::lock_guard<SchedulerMutex> lock(mutex_);
+    std::vector<std::unique_ptr<Task>> drained;
 
-    auto it = pending_tasks_.find(id);
-    if (it != pending_tasks_.end()) {
-        it->second->cancel();
-        return true;
+    drained.reserve(pending_nodes_);
+    for (auto& node : nodes_) {
+        if (node.task) {
+            drained.push_back(std::move(node.task));
+        }
+    }
+    nodes_.clear();
+    free_slots_.clear();
+    slots_.clear();
+    pending_nodes_ = 0;
+    target_nodes_ = 0;
+    publish_sizes();
+
+    return drained;
+}
+
+size_t DependencyTracker::slot_count() const {
+    std::lock_guard<SchedulerMutex> lock(mutex_);
+    return nodes_.size();
+}
+
+std::unordered_map<TaskId, double> DependencyTracker::inherit(
+    const TaskIdList& ids, Priority priority,
+    std::optional<Task::TimePoint> deadline, double downstream_ms, size_t& boosted) {
+    std::lock_guard<SchedulerMutex> lock(mutex_);
+    return inherit_locked(ids, priority, deadline, downstream_ms, boosted);
+}
+
+std::optional<DependencyTracker::Propagation> DependencyTracker::update_task(
+    TaskId id, std::optional<Priority> priority, std::optional<Task::TimePoint> deadline) {
+    std::lock_guard<SchedulerMutex> lock(mutex_);
+    Task* pending = pending_task(id);
+    if (pending == nullptr) {
+        return std::nullopt;
     }
 
-    return false;
+    Task& task = *pending;
+    if (priority.has_value()) {
+        task.set_priority(priority.value());
+    }
+    if (deadline.has_value()) {
+        task.set_deadline(deadline.value());
+    }
+
+    Propagation propagation;
+    propagation.priority = task.priority();
+    propagation.deadline = task.deadline();
+    propagation.downstream_ms = inherit_locked(task.dependency_list(), task.priority(), task.deadline(),
+                                               task.critical_path_ms(), propagation.boosted);
+    return propagation;
+}
+
+std::unordered_map<TaskId, double> DependencyTracker::inherit_locked(
+    const TaskIdList& ids, Priority priority,
+    std::optional<Task::TimePoint> deadline, double downstream_ms, size_t& boosted) {
+    std::unordered_map<TaskId, double> not_pending;
+    std::vector<std::pair<TaskId, double>> worklist;
+
+    for (TaskId id : ids) {
+        worklist.emplace_back(id, downstream_ms);
+    }
+
+    while (!worklist.empty()) {
+        auto [current, downstream] = worklist.back();
+        worklist.pop_back();
+
+        Task* pending = pending_task(current);
+        if (pending == nullptr) {
+            double& longest = not_pending[current];
+            longest = std::max(longest, downstream);
+            continue;
+        }
+
+        Task& task = *pending;
+        bool changed = task.inherit_priority(priority);
+        if (deadline.has_value()) {
+            changed = task.inherit_deadline(deadline.value()) || changed;
+        }
+        if (changed) {
+            ++boosted;
+        }
+        double path_before = task.critical_path_ms();
+        bool path_grew = task.extend_critical_path(downstream) &&
+            task.critical_path_ms() - path_before >= path_before * MIN_PATH_GROWTH;
+
+        // An unchanged task already passed at least this much on to its
+        // own prerequisites. A path that barely grew is not passed on
+        // either: every submit at the end of a long chain would otherwise
+        // walk the whole chain.
+        if (changed || path_grew) {
+            for (TaskId dep_id : task.dependency_list()) {
+                worklist.emplace_back(dep_id, task.critical_path_ms());
+            }
+        }
+    }
+
+    return not_pending;
+}
+
+std::unique_ptr<Task> DependencyTracker::remove_pending(uint32_t slot) {
+    Node& node = nodes_[slot];
+    TaskId task_id = node.id;
+    std::unique_ptr<Task> task = std::move(node.task);
+    ++node.generation;  // Stales the edges its prerequisites hold
+    --pending_nodes_;
+    mark_finished(task_id);
+
+    task->cancel();
+
+    // Let go of the prerequisites that are still outstanding so their
+    // nodes do not stay alive for an abandoned edge.
+    for_each_distinct(task->dependency_list(), [this](TaskId dep_id) { drop_edge(dep_id); });
+
+    release_if_unused(slot);
+    publish_sizes();
+    return task;
+}
+
+void DependencyTracker::cancel_dependents_locked(
+    TaskId id, std::vector<std::unique_ptr<Task>>& removed) {
+    mark_finished(id);
+    std::vector<TaskId> worklist{id};
+
+    while (!worklist.empty()) {
+        TaskId current = worklist.back();
+        worklist.pop_back();
+
+        uint32_t slot = slots_.find(current);
+        if (slot == NO_SLOT) {
+            continue;
+        }
+
+        for (const Edge& edge : detach_dependents(slot)) {
+            if (!is_live(edge)) {
+                continue;
+            }
+            worklist.push_back(nodes_[edge.slot].id);
+            removed.push_back(remove_pending(edge.slot));
+        }
+    }
+    publish_sizes();
+}
+
+std::vector<std::unique_ptr<Task>> DependencyTracker::resolve_dependents(TaskId task_id, bool take_ready) {
+    std::vector<std::unique_ptr<Task>> ready;
+    uint32_t slot = slots_.find(task_id);
+    if (slot == NO_SLOT) {
+        return ready;
+    }
+
+    for (const Edge& edge : detach_dependents(slot)) {
+        if (!is_live(edge) || --nodes_[edge.slot].remaining != 0 || !take_ready) {
+            continue;
+        }
+        ready.push_back(std::move(nodes_[edge.slot].task));
+        --pending_nodes_;
+        release_if_unused(edge.slot);
+    }
+    publish_sizes();
+
+    return ready;
+}
+
+uint32_t DependencyTracker::node_slot(TaskId id) {
+    uint32_t slot = slots_.find(id);
+    if (slot != NO_SLOT) {
+        return slot;
+    }
+
+    if (free_slots_.empty()) {
+        slot = static_cast<uint32_t>(nodes_.size());
+        nodes_.emplace_back();
+    } else {
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+    }
+    nodes_[slot].id = id;
+    slots_.insert(id, slot);
+    return slot;
+}
+
+void DependencyTracker::release_if_unused(uint32_t slot) {
+    Node& node = nodes_[slot];
+    if (node.id == INVALID_TASK_ID || node.task || node.live_edges > 0) {
+        return;
+    }
+
+    slots_.erase(node.id);
+    node.id = INVALID_TASK_ID;
+    ++node.generation;
+    node.remaining = 0;
+    std::vector<Edge>().swap(node.dependents);
+    free_slots_.push_back(slot);
+}
+
+void DependencyTracker::drop_edge(TaskId target) {
+    uint32_t slot = slots_.find(target);
+    if (slot == NO_SLOT || nodes_[slot].live_edges == 0) {
+        return;
+    }
+
+    Node& node = nodes_[slot];
+    if (--node.live_edges == 0) {
+        --target_nodes_;
+        node.dependents.clear();
+        release_if_unused(slot);
+    } else if (node.dependents.size() >= 2 * static_cast<size_t>(node.live_edges) + 16) {
+        // Mostly stale; compact so a long-lived prerequisite with churning
+        // dependents stays proportional to the live ones
+        node.dependents.erase(std::remove_if(node.dependents.begin(), node.dependents.end(),
+                                             [this](const Edge& edge) { return !is_live(edge); }),
+                              node.dependents.end());
+    }
+}
+
+std::vector<DependencyTracker::Edge> DependencyTracker::detach_dependents(uint32_t slot) {
+    Node& node = nodes_[slot];
+    std::vector<Edge> dependents = std::move(node.dependents);
+    node.dependents.clear();
+    if (node.live_edges > 0) {
+        node.live_edges = 0;
+        --target_nodes_;
+    }
+    release_if_unused(slot);
+    return dependents;
+}
+
+bool DependencyTracker::is_live(const Edge& edge) const {
+    const Node& node = nodes_[edge.slot];
+    return node.generation == edge.generation && node.task != nullptr;
+}
+
+Task* DependencyTracker::pending_task(TaskId id) {
+    uint32_t slot = slots_.find(id);
+    return slot == NO_SLOT ? nullptr : nodes_[slot].task.get();
+}
+
+void DependencyTracker::mark_finished(TaskId task_id) {
+    finished_.insert(task_id);
+    if (waiter_count_.load() != 0) {
+        notify_finished(task_id);
+    }
+}
+
+void DependencyTracker::mark_finished_range(TaskId begin, TaskId end) {
+    if (begin >= end) {
+        return;
+    }
+    finished_.insert_range(begin, end);
+    if (waiter_count_.load() == 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(waiters_mutex_);
+    for (auto& [id, waiter] : waiters_) {
+        if (id >= begin && id < end) {
+            waiter.cv.notify_all();
+        }
+    }
+}
+
+void DependencyTracker::notify_finished(TaskId task_id) {
+    std::lock_guard<std::mutex> lock(waiters_mutex_);
+    auto it = waiters_.find(task_id);
+    if (it != waiters_.end()) {
+        it->second.cv.notify_all();
+    }
+}
+
+void DependencyTracker::publish_sizes() {
+    pending_size_.store(pending_nodes_, std::memory_order_release);
+    tracked_targets_.store(target_nodes_);  // Sequentially consistent; see complete()
 }
 
 } // namespace taskscheduler
@@ -0,0 +1,454 @@
+#include "taskscheduler/journal.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fcntl.h>
+#include <limits>
+#include <map>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_set>
+
+namespace taskscheduler {
+
+namespace {
+
+constexpr char JOURNAL_MAGIC[4] = {'T', 'S', 'J', 'L'};
+constexpr uint32_t JOURNAL_VERSION = 1;
+constexpr uint64_t FILE_HEADER_BYTES = 16;
+constexpr uint64_t RECORD_PREFIX_BYTES = 8;  // Payload length and CRC
+constexpr int64_t NO_DEADLINE = std::numeric_limits<int64_t>::max();
+
+// Unsynced records are flushed at least this often even if nobody waits
+constexpr std::chrono::milliseconds BACKGROUND_COMMIT_INTERVAL{50};
+
+enum class RecordKind : uint8_t {
+    SUBMIT = 1,
+    COMPLETE = 2,
+    CANCEL = 3
+};
+
+// Fixed part of every record payload; SUBMIT records are followed by
+// `dependency_count` task ids and then `arguments_bytes` of arguments.
+struct RecordHeader {
+    uint8_t kind;
+    uint8_t priority;
+    uint16_t dependency_count;
+    TaskTypeId type;
+    uint64_t task_id;
+    int64_t deadline_ns;  // system_clock since epoch
+    TaskClassId task_class;
+    uint32_t arguments_bytes;
+};
+static_assert(sizeof(RecordHeader) == 32, "journal records must stay compact");
+
+uint32_t crc32(const uint8_t* data, size_t size) {
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> entries{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t value = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                value = (value & 1) ? (0xEDB88320u ^ (value >> 1)) : (value >> 1);
+            }
+            entries[i] = value;
+        }
+        return entries;
+    }();
+
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+int64_t to_wall_clock_ns(Task::TimePoint deadline) {
+    auto wall = std::chrono::system_clock::now() + (deadline - std::chrono::steady_clock::now());
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(wall.time_since_epoch()).count();
+}
+
+Task::TimePoint from_wall_clock_ns(int64_t deadline_ns) {
+    auto wall = std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(deadline_ns)));
+    return std::chrono::steady_clock::now() +
+           std::chrono::duration_cast<Task::TimePoint::duration>(wall - std::chrono::system_clock::now());
+}
+
+std::vector<uint8_t> encode_submit(TaskId id, const TaskSpec& spec) {
+    RecordHeader header{};
+    header.kind = static_cast<uint8_t>(RecordKind::SUBMIT);
+    header.priority = static_cast<uint8_t>(spec.priority);
+    header.dependency_count = static_cast<uint16_t>(
+        std::min<size_t>(spec.dependencies.size(), std::numeric_limits<uint16_t>::max()));
+    header.type = spec.type;
+    header.task_id = id;
+    header.deadline_ns = spec.deadline.has_value() ? to_wall_clock_ns(spec.deadline.value()) : NO_DEADLINE;
+    header.task_class = spec.task_class;
+    header.arguments_bytes = static_cast<uint32_t>(spec.arguments.size());
+
+    size_t dependency_bytes = header.dependency_count * sizeof(TaskId);
+    std::vector<uint8_t> payload(sizeof(header) + dependency_bytes + spec.arguments.size());
+    std::memcpy(payload.data(), &header, sizeof(header));
+    std::memcpy(payload.data() + sizeof(header), spec.dependencies.data(), dependency_bytes);
+    std::memcpy(payload.data() + sizeof(header) + dependency_bytes, spec.arguments.data(), spec.arguments.size());
+    return payload;
+}
+
+std::vector<uint8_t> encode_marker(RecordKind kind, TaskId id) {
+    RecordHeader header{};
+    header.kind = static_cast<uint8_t>(kind);
+    header.task_id = id;
+    header.deadline_ns = NO_DEADLINE;
+
+    std::vector<uint8_t> payload(sizeof(header));
+    std::memcpy(payload.data(), &header, sizeof(header));
+    return payload;
+}
+
+void write_record(uint8_t* out, const std::vector<uint8_t>& payload) {
+    uint32_t length = static_cast<uint32_t>(payload.size());
+    uint32_t crc = crc32(payload.data(), payload.size());
+    std::memcpy(out, &length, sizeof(length));
+    std::memcpy(out + sizeof(length), &crc, sizeof(crc));
+    std::memcpy(out + RECORD_PREFIX_BYTES, payload.data(), payload.size());
+}
+
+bool write_all(int fd, const uint8_t* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written <= 0) {
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+} // namespace
+
+Journal::Journal(JournalOptions options) : options_(options) {}
+
+Journal::~Journal() {
+    close();
+}
+
+bool Journal::open(const std::string& path) {
+    if (is_open() || !recover_file(path)) {
+        return false;
+    }
+
+    fd_ = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+    struct stat info{};
+    if (fd_ < 0 || ::fstat(fd_, &info) != 0) {
+        close();
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    path_ = path;
+    tail_ = static_cast<uint64_t>(info.st_size);
+    durable_ = tail_;
+    stopping_ = false;
+    if (!map_locked(std::max<uint64_t>(options_.initial_bytes, tail_ * 2))) {
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    committer_ = std::thread(&Journal::commit_loop, this);
+    return true;
+}
+
+bool Journal::recover_file(const std::string& path) {
+    recovered_.clear();
+    max_task_id_ = INVALID_TASK_ID;
+
+    std::vector<uint8_t> data;
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        struct stat info{};
+        if (::fstat(fd, &info) == 0 && info.st_size > 0) {
+            data.resize(static_cast<size_t>(info.st_size));
+            if (::pread(fd, data.data(), data.size(), 0) != static_cast<ssize_t>(data.size())) {
+                data.clear();
+            }
+        }
+        ::close(fd);
+    }
+
+    bool valid_header = data.size() >= FILE_HEADER_BYTES &&
+                        std::memcmp(data.data(), JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) == 0;
+    uint32_t version = 0;
+    if (valid_header) {
+        std::memcpy(&version, data.data() + sizeof(JOURNAL_MAGIC), sizeof(version));
+    }
+    if (!data.empty() && (!valid_header || version != JOURNAL_VERSION)) {
+        return false;  // Not ours; refuse to overwrite it
+    }
+
+    // Scan up to the first empty, torn or corrupt record
+    std::map<TaskId, JournalEntry> submitted;
+    std::unordered_set<TaskId> completed;
+    std::unordered_set<TaskId> cancelled;
+    uint64_t offset = FILE_HEADER_BYTES;
+    while (offset + RECORD_PREFIX_BYTES <= data.size()) {
+        uint32_t length = 0;
+        uint32_t crc = 0;
+        std::memcpy(&length, data.data() + offset, sizeof(length));
+        std::memcpy(&crc, data.data() + offset + sizeof(length), sizeof(crc));
+        const uint8_t* payload = data.data() + offset + RECORD_PREFIX_BYTES;
+        if (length < sizeof(RecordHeader) || offset + RECORD_PREFIX_BYTES + length > data.size() ||
+            crc32(payload, length) != crc) {
+            break;
+        }
+
+        RecordHeader header;
+        std::memcpy(&header, payload, sizeof(header));
+        max_task_id_ = std::max<TaskId>(max_task_id_, header.task_id);
+
+        switch (static_cast<RecordKind>(header.kind)) {
+            case RecordKind::SUBMIT: {
+                size_t dependency_bytes = header.dependency_count * sizeof(TaskId);
+                if (sizeof(header) + dependency_bytes + header.arguments_bytes != length) {
+                    break;
+                }
+                JournalEntry entry;
+                entry.id = header.task_id;
+                entry.spec.type = header.type;
+                entry.spec.priority = static_cast<Priority>(header.priority);
+                entry.spec.task_class = header.task_class;
+                if (header.deadline_ns != NO_DEADLINE) {
+                    entry.spec.deadline = from_wall_clock_ns(header.deadline_ns);
+                }
+                entry.spec.dependencies.resize(header.dependency_count);
+                std::memcpy(entry.spec.dependencies.data(), payload + sizeof(header), dependency_bytes);
+                entry.spec.arguments.assign(
+                    reinterpret_cast<const char*>(payload + sizeof(header) + dependency_bytes),
+                    header.arguments_bytes);
+                submitted[entry.id] = std::move(entry);
+                break;
+            }
+            case RecordKind::COMPLETE:
+                completed.insert(header.task_id);
+                break;
+            case RecordKind::CANCEL:
+                cancelled.insert(header.task_id);
+                break;
+        }
+        offset += RECORD_PREFIX_BYTES + length;
+    }
+
+    // Prerequisites always have smaller ids, so one pass in id order sees
+    // every dependency's fate before its dependents.
+    std::unordered_set<TaskId> live;
+    for (auto& [id, entry] : submitted) {
+        if (completed.count(id) > 0) {
+            continue;
+        }
+        auto& dependencies = entry.spec.dependencies;
+        bool abandoned = cancelled.count(id) > 0 ||
+            std::any_of(dependencies.begin(), dependencies.end(),
+                        [&cancelled](TaskId dep) { return cancelled.count(dep) > 0; });
+        if (abandoned) {
+            cancelled.insert(id);
+            continue;
+        }
+        dependencies.erase(std::remove_if(dependencies.begin(), dependencies.end(),
+                                          [&live](TaskId dep) { return live.count(dep) == 0; }),
+                           dependencies.end());
+        live.insert(id);
+        recovered_.push_back(std::move(entry));
+    }
+
+    // Rewrite the log with only the live submits
+    std::string temp_path = path + ".tmp";
+    int out = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (out < 0) {
+        return false;
+    }
+
+    std::vector<uint8_t> compacted(FILE_HEADER_BYTES, 0);
+    std::memcpy(compacted.data(), JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+    std::memcpy(compacted.data() + sizeof(JOURNAL_MAGIC), &JOURNAL_VERSION, sizeof(JOURNAL_VERSION));
+    for (const auto& entry : recovered_) {
+        auto payload = encode_submit(entry.id, entry.spec);
+        size_t start = compacted.size();
+        compacted.resize(start + RECORD_PREFIX_BYTES + payload.size());
+        write_record(compacted.data() + start, payload);
+    }
+
+    bool written = write_all(out, compacted.data(), compacted.size()) && ::fsync(out) == 0;
+    ::close(out);
+    if (!written || ::rename(temp_path.c_str(), path.c_str()) != 0) {
+        ::unlink(temp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+void Journal::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    commit_cv_.notify_all();
+    if (committer_.joinable()) {
+        committer_.join();  // Commits everything appended so far first
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (base_ != nullptr) {
+        ::munmap(base_, capacity_);
+        base_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        // Drop the unused preallocated tail
+        if (::ftruncate(fd_, static_cast<off_t>(tail_)) == 0) {
+            ::fdatasync(fd_);
+        }
+        ::close(fd_);
+        fd_ = -1;
+    }
+    capacity_ = 0;
+}
+
+bool Journal::is_open() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return fd_ >= 0;
+}
+
+const JournalOptions& Journal::options() const {
+    return options_;
+}
+
+const std::vector<JournalEntry>& Journal::recovered() const {
+    return recovered_;
+}
+
+TaskId Journal::max_task_id() const {
+    return max_task_id_;
+}
+
+uint64_t Journal::append_submit(TaskId id, const TaskSpec& spec) {
+    return append(encode_submit(id, spec));
+}
+
+uint64_t Journal::append_complete(TaskId id) {
+    return append(encode_marker(RecordKind::COMPLETE, id));
+}
+
+uint64_t Journal::append_cancel(TaskId id) {
+    return append(encode_marker(RecordKind::CANCEL, id));
+}
+
+uint64_t Journal::append(const std::vector<uint8_t>& payload) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (base_ == nullptr || stopping_) {
+        return 0;
+    }
+
+    uint64_t size = RECORD_PREFIX_BYTES + payload.size();
+    ensure_capacity_locked(tail_ + size);
+    if (tail_ + size > capacity_) {
+        return 0;  // Could not grow the file
+    }
+
+    write_record(base_ + tail_, payload);
+    tail_ += size;
+    return tail_;
+}
+
+void Journal::ensure_capacity_locked(uint64_t needed) {
+    if (needed <= capacity_) {
+        return;
+    }
+    uint64_t capacity = std::max<uint64_t>(capacity_, FILE_HEADER_BYTES);
+    while (capacity < needed) {
+        capacity *= 2;
+    }
+    map_locked(capacity);
+}
+
+bool Journal::map_locked(uint64_t capacity) {
+    if (::ftruncate(fd_, static_cast<off_t>(capacity)) != 0) {
+        return false;
+    }
+    void* mapping = ::mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+    if (base_ != nullptr) {
+        ::munmap(base_, capacity_);
+    }
+    base_ = static_cast<uint8_t*>(mapping);
+    capacity_ = capacity;
+    return true;
+}
+
+void Journal::wait_durable(uint64_t offset) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (durable_ >= offset) {
+        return;
+    }
+    commit_requested_ = true;
+    commit_cv_.notify_one();
+    durable_cv_.wait(lock, [this, offset] { return durable_ >= offset || fd_ < 0; });
+}
+
+void Journal::sync() {
+    uint64_t offset;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        offset = tail_;
+    }
+    wait_durable(offset);
+}
+
+uint64_t Journal::size_bytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return tail_;
+}
+
+uint64_t Journal::durable_bytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return durable_;
+}
+
+size_t Journal::commit_count() const {
+    return commits_.load(std::memory_order_relaxed);
+}
+
+void Journal::commit_loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        commit_cv_.wait_for(lock, BACKGROUND_COMMIT_INTERVAL,
+                            [this] { return stopping_ || commit_requested_; });
+        if (durable_ >= tail_) {
+            commit_requested_ = false;
+            if (stopping_) {
+                return;
+            }
+            continue;
+        }
+
+        // Let more submitters join this commit
+        if (options_.commit_delay.count() > 0 && !stopping_) {
+            lock.unlock();
+            std::this_thread::sleep_for(options_.commit_delay);
+            lock.lock();
+        }
+
+        uint64_t target = tail_;
+        commit_requested_ = false;
+        lock.unlock();
+        ::fdatasync(fd_);  // Also flushes the dirty pages of the shared mapping
+        lock.lock();
+
+        durable_ = std::max(durable_, target);
+        commits_.fetch_add(1, std::memory_order_relaxed);
+        durable_cv_.notify_all();
+    }
+}
+
+} // namespace taskscheduler
@@ -0,0 +1,81 @@
+#include "taskscheduler/lock_stats.hpp"
+
+namespace taskscheduler {
+
+namespace {
+
+constexpr uint64_t hold_time_bound_ns(size_t bucket) {
+    return LockStatistics::FIRST_HOLD_TIME_BOUND_NS << bucket;
+}
+
+// Constant-initialized, so other static initializers can read it
+constexpr std::array<double, LockStatistics::HOLD_TIME_BUCKETS> hold_time_bounds_us() {
+    std::array<double, LockStatistics::HOLD_TIME_BUCKETS> bounds{};
+    for (size_t i = 0; i < bounds.size(); ++i) {
+        bounds[i] = static_cast<double>(hold_time_bound_ns(i)) / 1000.0;
+    }
+    return bounds;
+}
+
+// Index of the hold-time bucket for `ns`, HOLD_TIME_BUCKETS if it overflows
+size_t hold_time_bucket(uint64_t ns) {
+    size_t bucket = 0;
+    while (bucket < LockStatistics::HOLD_TIME_BUCKETS && ns > hold_time_bound_ns(bucket)) {
+        ++bucket;
+    }
+    return bucket;
+}
+
+uint64_t to_ns(std::chrono::steady_clock::duration duration) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+}
+
+} // namespace
+
+const std::array<double, LockStatistics::HOLD_TIME_BUCKETS>
+    LockStatistics::HOLD_TIME_BUCKET_BOUNDS_US = hold_time_bounds_us();
+
+void InstrumentedMutex::lock() {
+    if (!mutex_.try_lock()) {
+        Clock::time_point start = Clock::now();
+        mutex_.lock();
+        contended_acquisitions_.fetch_add(1, std::memory_order_relaxed);
+        wait_time_ns_.fetch_add(to_ns(Clock::now() - start), std::memory_order_relaxed);
+    }
+    acquired();
+}
+
+bool InstrumentedMutex::try_lock() {
+    if (!mutex_.try_lock()) {
+        return false;
+    }
+    acquired();
+    return true;
+}
+
+void InstrumentedMutex::unlock() {
+    uint64_t held = to_ns(Clock::now() - acquired_at_);
+    hold_time_ns_.fetch_add(held, std::memory_order_relaxed);
+    hold_time_buckets_[hold_time_bucket(held)].fetch_add(1, std::memory_order_relaxed);
+    mutex_.unlock();
+}
+
+void InstrumentedMutex::acquired() {
+    acquisitions_.fetch_add(1, std::memory_order_relaxed);
+    acquired_at_ = Clock::now();
+}
+
+LockStatistics InstrumentedMutex::statistics() const {
+    LockStatistics statistics;
+    statistics.acquisitions = acquisitions_.load(std::memory_order_relaxed);
+    statistics.contended_acquisitions = contended_acquisitions_.load(std::memory_order_relaxed);
+    statistics.wait_time_ms = wait_time_ns_.load(std::memory_order_relaxed) / 1e6;
+    statistics.hold_time_ms = hold_time_ns_.load(std::memory_order_relaxed) / 1e6;
+    for (size_t i = 0; i < hold_time_buckets_.size(); ++i) {
+        statistics.hold_time_buckets[i] = hold_time_buckets_[i].load(std::memory_order_relaxed);
+    }
+    return statistics;
+}
+
+} // namespace taskscheduler
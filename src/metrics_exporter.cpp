@@ -0,0 +1,325 @@
+#include "taskscheduler/metrics_exporter.hpp"
+#include <sstream>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace taskscheduler {
+
+namespace {
+
+void write_metric(std::ostringstream& out, const std::string& name, const char* type,
+                  const char* help, size_t value) {
+    out << "# HELP " << name << ' ' << help << '\n';
+    out << "# TYPE " << name << ' ' << type << '\n';
+    out << name << ' ' << value << '\n';
+}
+
+void write_metric(std::ostringstream& out, const std::string& name, const char* type,
+                  const char* help, double value) {
+    out << "# HELP " << name << ' ' << help << '\n';
+    out << "# TYPE " << name << ' ' << type << '\n';
+    out << name << ' ' << value << '\n';
+}
+
+// One sample per item, labelled `label`="label_value(item)"
+template<typename Item, typename LabelValue, typename Value>
+void write_labelled_metrics(std::ostringstream& out, const std::string& name, const char* type,
+                            const char* help, const char* label, const std::vector<Item>& items,
+                            LabelValue label_value, Value value) {
+    out << "# HELP " << name << ' ' << help << '\n';
+    out << "# TYPE " << name << ' ' << type << '\n';
+    for (const auto& item : items) {
+        out << name << '{' << label << "=\"" << label_value(item) << "\"} " << value(item) << '\n';
+    }
+}
+
+void send_all(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return;
+        }
+        sent += static_cast<size_t>(n);
+    }
+}
+
+} // namespace
+
+MetricsExporter::MetricsExporter(const ThreadPool& pool, std::string metric_prefix)
+    : pool_(pool), prefix_(std::move(metric_prefix)) {}
+
+MetricsExporter::~MetricsExporter() {
+    stop();
+}
+
+std::string MetricsExporter::render() const {
+    CumulativeStatistics cumulative = pool_.get_cumulative_statistics();
+    StatisticsSnapshot snapshot = pool_.get_statistics();
+    std::ostringstream out;
+    out.precision(12);
+
+    write_metric(out, prefix_ + "_tasks_completed_total", "counter",
+                 "Tasks executed since the pool was created.",
+                 cumulative.completed_tasks);
+    write_metric(out, prefix_ + "_tasks_rejected_total", "counter",
+                 "Submissions refused by admission control.",
+                 cumulative.rejected_tasks);
+    write_metric(out, prefix_ + "_tasks_shed_total", "counter",
+                 "Queued tasks dropped to admit higher-priority work.",
+                 cumulative.shed_tasks);
+    write_metric(out, prefix_ + "_priority_inheritance_boosts_total", "counter",
+                 "Prerequisites boosted by priority inheritance.",
+                 cumulative.priority_inheritance_boosts);
+    write_metric(out, prefix_ + "_inline_continuations_total", "counter",
+                 "Dependents run inline on the worker that released them.",
+                 cumulative.inline_continuations);
+    write_metric(out, prefix_ + "_compensating_workers_total", "counter",
+                 "Extra workers spawned while others were in blocking regions.",
+                 cumulative.compensating_workers_spawned);
+    write_metric(out, prefix_ + "_blocked_seconds_total", "counter",
+                 "Time workers spent inside blocking regions.",
+                 cumulative.blocked_time_ms / 1000.0);
+    write_metric(out, prefix_ + "_result_cache_hits_total", "counter",
+                 "Keyed submits answered from the result cache.",
+                 cumulative.result_cache_hits);
+    write_metric(out, prefix_ + "_deduplicated_submits_total", "counter",
+                 "Keyed submits joined to an identical task already in flight.",
+                 cumulative.deduplicated_submits);
+    write_metric(out, prefix_ + "_result_cache_misses_total", "counter",
+                 "Keyed submits that had to run their task.",
+                 cumulative.result_cache_misses);
+    write_metric(out, prefix_ + "_coalesced_items_total", "counter",
+                 "Items run inside batch executions.",
+                 cumulative.coalesced_items);
+    write_metric(out, prefix_ + "_long_running_tasks_total", "counter",
+                 "Tasks the watchdog found running past their class threshold.",
+                 cumulative.long_running_tasks);
+    write_metric(out, prefix_ + "_stalled_workers_total", "counter",
+                 "Workers the watchdog found stuck on one task while work was queued.",
+                 cumulative.stalled_workers);
+
+    write_metric(out, prefix_ + "_active_workers", "gauge",
+                 "Workers currently executing a task.",
+                 snapshot.active_workers);
+    write_metric(out, prefix_ + "_blocked_workers", "gauge",
+                 "Workers currently inside a blocking region.",
+                 snapshot.blocked_workers);
+    write_metric(out, prefix_ + "_longest_running_task_seconds", "gauge",
+                 "Time the longest-running current task has been executing.",
+                 snapshot.longest_running_task_ms / 1000.0);
+    write_metric(out, prefix_ + "_queue_depth", "gauge",
+                 "Tasks waiting in the ready queue.",
+                 snapshot.queue_depth);
+    write_metric(out, prefix_ + "_pending_dependencies", "gauge",
+                 "Tasks waiting for their dependencies to complete.",
+                 snapshot.pending_dependencies);
+    write_metric(out, prefix_ + "_pending_tasks", "gauge",
+                 "Tasks admitted and not yet finished.",
+                 snapshot.pending_task_count);
+    write_metric(out, prefix_ + "_pending_task_bytes", "gauge",
+                 "Estimated memory held by admitted, unfinished tasks.",
+                 snapshot.pending_task_bytes);
+
+    std::string histogram = prefix_ + "_task_execution_seconds";
+    out << "# HELP " << histogram << " Task execution time.\n";
+    out << "# TYPE " << histogram << " histogram\n";
+    size_t cumulative_count = 0;
+    const auto& bounds = CumulativeStatistics::EXECUTION_TIME_BUCKET_BOUNDS_MS;
+    for (size_t i = 0; i < bounds.size(); ++i) {
+        cumulative_count += cumulative.execution_time_buckets[i];
+        out << histogram << "_bucket{le=\"" << bounds[i] / 1000.0 << "\"} " << cumulative_count << '\n';
+    }
+    cumulative_count += cumulative.execution_time_buckets[bounds.size()];
+    out << histogram << "_bucket{le=\"+Inf\"} " << cumulative_count << '\n';
+    out << histogram << "_sum " << cumulative.total_execution_time_ms / 1000.0 << '\n';
+    out << histogram << "_count " << cumulative_count << '\n';
+
+    // Lock contention, only present in builds with TASKSCHEDULER_LOCK_STATS
+    auto locks = pool_.get_lock_statistics();
+    if (!locks.empty()) {
+        auto lock_name = [](const LockStatistics& lock) { return lock.name; };
+        write_labelled_metrics(out, prefix_ + "_lock_acquisitions_total", "counter",
+                               "Acquisitions of a scheduler lock.", "lock", locks, lock_name,
+                               [](const LockStatistics& lock) { return lock.acquisitions; });
+        write_labelled_metrics(out, prefix_ + "_lock_contended_acquisitions_total", "counter",
+                               "Acquisitions that found a scheduler lock held.", "lock", locks, lock_name,
+                               [](const LockStatistics& lock) { return lock.contended_acquisitions; });
+        write_labelled_metrics(out, prefix_ + "_lock_wait_seconds_total", "counter",
+                               "Time spent waiting for a held scheduler lock.", "lock", locks, lock_name,
+                               [](const LockStatistics& lock) { return lock.wait_time_ms / 1000.0; });
+
+        std::string hold = prefix_ + "_lock_hold_seconds";
+        out << "# HELP " << hold << " Time a scheduler lock was held.\n";
+        out << "# TYPE " << hold << " histogram\n";
+        const auto& hold_bounds = LockStatistics::HOLD_TIME_BUCKET_BOUNDS_US;
+        for (const auto& lock : locks) {
+            std::string label = "lock=\"" + lock.name + "\"";
+            size_t count = 0;
+            for (size_t i = 0; i < hold_bounds.size(); ++i) {
+                count += lock.hold_time_buckets[i];
+                out << hold << "_bucket{" << label << ",le=\"" << hold_bounds[i] / 1e6 << "\"} "
+                    << count << '\n';
+            }
+            count += lock.hold_time_buckets[hold_bounds.size()];
+            out << hold << "_bucket{" << label << ",le=\"+Inf\"} " << count << '\n';
+            out << hold << "_sum{" << label << "} " << lock.hold_time_ms / 1000.0 << '\n';
+            out << hold << "_count{" << label << "} " << count << '\n';
+        }
+    }
+
+    // Per-class counters, only present with ThreadPool::set_performance_counters
+    auto classes = pool_.get_task_class_counters();
+    if (!classes.empty()) {
+        auto class_id = [](const TaskClassCounters& counters) { return counters.task_class; };
+        write_labelled_metrics(out, prefix_ + "_class_cpu_seconds_total", "counter",
+                               "CPU time spent running tasks of a class.", "task_class", classes, class_id,
+                               [](const TaskClassCounters& counters) { return counters.cpu_time_ms / 1000.0; });
+        write_labelled_metrics(out, prefix_ + "_class_context_switches_total", "counter",
+                               "Context switches while running tasks of a class.", "task_class", classes,
+                               class_id, [](const TaskClassCounters& counters) { return counters.context_switches; });
+        write_labelled_metrics(out, prefix_ + "_class_cycles_total", "counter",
+                               "CPU cycles of tasks of a class measured with hardware counters.", "task_class",
+                               classes, class_id, [](const TaskClassCounters& counters) { return counters.cycles; });
+        write_labelled_metrics(out, prefix_ + "_class_instructions_total", "counter",
+                               "Instructions of tasks of a class measured with hardware counters.", "task_class",
+                               classes, class_id,
+                               [](const TaskClassCounters& counters) { return counters.instructions; });
+        write_labelled_metrics(out, prefix_ + "_class_llc_misses_total", "counter",
+                               "Last-level cache misses of tasks of a class measured with hardware counters.",
+                               "task_class", classes, class_id,
+                               [](const TaskClassCounters& counters) { return counters.llc_misses; });
+    }
+
+    return out.str();
+}
+
+bool MetricsExporter::start_http_listener(uint16_t port) {
+    if (http_thread_.joinable()) {
+        return false;
+    }
+
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return false;
+    }
+
+    int reuse = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+
+    socklen_t len = sizeof(addr);
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(fd, 16) != 0 ||
+        ::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    listen_fd_ = fd;
+    http_port_ = ntohs(addr.sin_port);
+    running_ = true;
+    http_thread_ = std::thread(&MetricsExporter::http_loop, this);
+    return true;
+}
+
+uint16_t MetricsExporter::http_port() const {
+    return http_port_;
+}
+
+bool MetricsExporter::start_file_writer(const std::string& path, std::chrono::milliseconds interval) {
+    if (file_thread_.joinable() || !write_file(path)) {
+        return false;
+    }
+
+    running_ = true;
+    file_thread_ = std::thread(&MetricsExporter::file_loop, this, path, interval);
+    return true;
+}
+
+bool MetricsExporter::write_file(const std::string& path) const {
+    // Write then rename, so scrapers never see a partial file
+    std::string temp_path = path + ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        file << render();
+        if (!file) {
+            return false;
+        }
+    }
+    return std::rename(temp_path.c_str(), path.c_str()) == 0;
+}
+
+void MetricsExporter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(stop_mutex_);
+        running_ = false;
+    }
+    stop_cv_.notify_all();
+
+    if (http_thread_.joinable()) {
+        http_thread_.join();
+    }
+    if (file_thread_.joinable()) {
+        file_thread_.join();
+    }
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+    }
+}
+
+void MetricsExporter::http_loop() {
+    while (running_) {
+        pollfd pfd{listen_fd_, POLLIN, 0};
+        if (::poll(&pfd, 1, 100) <= 0) {
+            continue;  // Timeout: re-check running_
+        }
+
+        int client = ::accept(listen_fd_, nullptr, nullptr);
+        if (client < 0) {
+            continue;
+        }
+
+        // The request itself is not interpreted; every path returns metrics
+        char request[1024];
+        pollfd client_pfd{client, POLLIN, 0};
+        if (::poll(&client_pfd, 1, 1000) > 0) {
+            (void)::recv(client, request, sizeof(request), 0);
+        }
+
+        std::string body = render();
+        std::ostringstream response;
+        response << "HTTP/1.1 200 OK\r\n"
+                 << "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                 << "Content-Length: " << body.size() << "\r\n"
+                 << "Connection: close\r\n\r\n"
+                 << body;
+        send_all(client, response.str());
+        ::close(client);
+    }
+}
+
+void MetricsExporter::file_loop(std::string path, std::chrono::milliseconds interval) {
+    std::unique_lock<std::mutex> lock(stop_mutex_);
+    while (!stop_cv_.wait_for(lock, interval, [this] { return !running_; })) {
+        lock.unlock();
+        write_file(path);
+        lock.lock();
+    }
+}
+
+} // namespace taskscheduler
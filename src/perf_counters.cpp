@@ -0,0 +1,154 @@
+#include "taskscheduler/perf_counters.hpp"
+#include <algorithm>
+#include <ctime>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace taskscheduler {
+
+namespace {
+
+// Opens one user-space event on the calling thread; the first event of a
+// group starts disabled and enables the others with it.
+int open_event(uint64_t config, int group_fd) {
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.disabled = group_fd < 0 ? 1 : 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    return static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, PERF_FLAG_FD_CLOEXEC));
+}
+
+uint64_t saturating_sub(uint64_t later, uint64_t earlier) {
+    return later > earlier ? later - earlier : 0;
+}
+
+} // namespace
+
+PerfSample PerfSample::operator-(const PerfSample& earlier) const {
+    PerfSample delta;
+    delta.cycles = saturating_sub(cycles, earlier.cycles);
+    delta.instructions = saturating_sub(instructions, earlier.instructions);
+    delta.llc_misses = saturating_sub(llc_misses, earlier.llc_misses);
+    delta.context_switches = saturating_sub(context_switches, earlier.context_switches);
+    delta.cpu_time_ns = saturating_sub(cpu_time_ns, earlier.cpu_time_ns);
+    return delta;
+}
+
+PerfCounters::PerfCounters(bool hardware) {
+    if (!hardware) {
+        return;
+    }
+
+    const std::array<uint64_t, EVENTS> events = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES
+    };
+    for (size_t i = 0; i < EVENTS; ++i) {
+        fds_[i] = open_event(events[i], fds_[0]);
+        if (fds_[i] < 0) {
+            for (size_t j = 0; j < i; ++j) {
+                ::close(fds_[j]);
+                fds_[j] = -1;
+            }
+            return;  // Software mode
+        }
+    }
+
+    group_fd_ = fds_[0];
+    ::ioctl(group_fd_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ::ioctl(group_fd_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+PerfCounters::~PerfCounters() {
+    for (int fd : fds_) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+}
+
+PerfSample PerfCounters::read() const {
+    PerfSample sample;
+    if (group_fd_ >= 0) {
+        // PERF_FORMAT_GROUP: the number of events, then their values
+        std::array<uint64_t, EVENTS + 1> values{};
+        if (::read(group_fd_, values.data(), sizeof(values)) == static_cast<ssize_t>(sizeof(values))) {
+            sample.cycles = values[1];
+            sample.instructions = values[2];
+            sample.llc_misses = values[3];
+        }
+    }
+
+    rusage usage{};
+    if (::getrusage(RUSAGE_THREAD, &usage) == 0) {
+        sample.context_switches = static_cast<uint64_t>(usage.ru_nvcsw + usage.ru_nivcsw);
+    }
+    timespec cpu_time{};
+    if (::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_time) == 0) {
+        sample.cpu_time_ns = static_cast<uint64_t>(cpu_time.tv_sec) * 1000000000ULL +
+                             static_cast<uint64_t>(cpu_time.tv_nsec);
+    }
+    return sample;
+}
+
+void TaskClassCounterTable::add(Slot& slot, const PerfSample& delta, bool hardware) {
+    slot.tasks.fetch_add(1, std::memory_order_relaxed);
+    if (hardware) {
+        slot.hardware_samples.fetch_add(1, std::memory_order_relaxed);
+        slot.cycles.fetch_add(delta.cycles, std::memory_order_relaxed);
+        slot.instructions.fetch_add(delta.instructions, std::memory_order_relaxed);
+        slot.llc_misses.fetch_add(delta.llc_misses, std::memory_order_relaxed);
+    }
+    slot.context_switches.fetch_add(delta.context_switches, std::memory_order_relaxed);
+    slot.cpu_time_ns.fetch_add(delta.cpu_time_ns, std::memory_order_relaxed);
+}
+
+TaskClassCounters TaskClassCounterTable::read(TaskClassId task_class, const Slot& slot) {
+    TaskClassCounters counters;
+    counters.task_class = task_class;
+    counters.tasks = slot.tasks.load(std::memory_order_relaxed);
+    counters.hardware_samples = slot.hardware_samples.load(std::memory_order_relaxed);
+    counters.cycles = slot.cycles.load(std::memory_order_relaxed);
+    counters.instructions = slot.instructions.load(std::memory_order_relaxed);
+    counters.llc_misses = slot.llc_misses.load(std::memory_order_relaxed);
+    counters.context_switches = slot.context_switches.load(std::memory_order_relaxed);
+    counters.cpu_time_ms = slot.cpu_time_ns.load(std::memory_order_relaxed) / 1e6;
+    return counters;
+}
+
+void TaskClassCounterTable::record(TaskClassId task_class, const PerfSample& delta, bool hardware) {
+    if (task_class < DIRECT_CLASSES) {
+        add(direct_[task_class], delta, hardware);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    add(slots_[task_class], delta, hardware);
+}
+
+std::vector<TaskClassCounters> TaskClassCounterTable::snapshot() const {
+    std::vector<TaskClassCounters> classes;
+    for (TaskClassId task_class = 0; task_class < DIRECT_CLASSES; ++task_class) {
+        if (direct_[task_class].tasks.load(std::memory_order_relaxed) > 0) {
+            classes.push_back(read(task_class, direct_[task_class]));
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& [task_class, slot] : slots_) {
+            classes.push_back(read(task_class, slot));
+        }
+    }
+    std::sort(classes.begin(), classes.end(),
+              [](const TaskClassCounters& a, const TaskClassCounters& b) { return a.task_class < b.task_class; });
+    return classes;
+}
+
+} // namespace taskscheduler
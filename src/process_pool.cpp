@@ -0,0 +1,464 @@
+#include "taskscheduler/process_pool.hpp"
+#include "taskscheduler/spsc_ring.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace taskscheduler {
+
+namespace {
+
+// Sent instead of a task to make a worker exit
+constexpr TaskId STOP_WORKER = INVALID_TASK_ID;
+
+// How often the coordinator checks for dead workers while idle
+constexpr int WORKER_CHECK_INTERVAL_MS = 10;
+
+constexpr size_t REGION_ALIGNMENT = 64;
+
+struct DispatchSlot {
+    TaskId id;
+    TaskTypeId type;
+    uint32_t arguments_bytes;
+    uint64_t arguments_offset;  // Into the worker's arena
+};
+
+enum class CompletionStatus : uint32_t {
+    SUCCEEDED,
+    FAILED
+};
+
+struct CompletionSlot {
+    TaskId id;
+    CompletionStatus status;
+    int64_t execution_ns;
+};
+
+using DispatchRing = SpscRing<DispatchSlot>;
+using CompletionRing = SpscRing<CompletionSlot>;
+
+size_t round_up(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+size_t next_power_of_two(size_t value) {
+    size_t power = 1;
+    while (power < value) {
+        power <<= 1;
+    }
+    return power;
+}
+
+void signal_eventfd(int fd) {
+    uint64_t one = 1;
+    ssize_t written = ::write(fd, &one, sizeof(one));
+    (void)written;  // Only fails if the counter would overflow; still signalled
+}
+
+void clear_eventfd(int fd) {
+    uint64_t value;
+    ssize_t bytes = ::read(fd, &value, sizeof(value));
+    (void)bytes;
+}
+
+// Body of a worker process; never returns.
+[[noreturn]] void run_worker(const TaskRegistry& registry, DispatchRing& dispatch,
+                             CompletionRing& completions, const uint8_t* arena,
+                             int wake_fd, int completion_fd) {
+    for (;;) {
+        DispatchSlot slot;
+        while (!dispatch.try_pop(slot)) {
+            uint64_t value;
+            if (::read(wake_fd, &value, sizeof(value)) < 0 && errno != EINTR) {
+                ::_exit(1);
+            }
+        }
+        if (slot.id == STOP_WORKER) {
+            ::_exit(0);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        bool succeeded;
+        try {
+            std::string_view arguments(reinterpret_cast<const char*>(arena + slot.arguments_offset),
+                                       slot.arguments_bytes);
+            succeeded = registry.invoke(slot.type, arguments);
+        } catch (...) {
+            succeeded = false;
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+
+        // Never full: the coordinator keeps at most one ring of tasks in flight
+        completions.try_push({slot.id, succeeded ? CompletionStatus::SUCCEEDED : CompletionStatus::FAILED,
+                              std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()});
+        signal_eventfd(completion_fd);
+    }
+}
+
+} // namespace
+
+struct ProcessPool::Worker {
+    struct InFlight {
+        std::unique_ptr<Task> task;
+        uint64_t arena_end;  // Arena space to free once it completes
+    };
+
+    void* region = MAP_FAILED;
+    size_t region_bytes = 0;
+    DispatchRing* dispatch = nullptr;
+    CompletionRing* completions = nullptr;
+    uint8_t* arena = nullptr;
+    int wake_fd = -1;
+    std::atomic<pid_t> pid{-1};
+
+    // Dispatch order, which is also completion order
+    std::deque<InFlight> in_flight;
+
+    // Monotonic byte positions; the arena holds [arena_tail, arena_head)
+    uint64_t arena_head = 0;
+    uint64_t arena_tail = 0;
+};
+
+ProcessPool::ProcessPool(const TaskRegistry& registry, ProcessPoolOptions options)
+    : registry_(registry), options_(options) {
+    options_.num_workers = std::max<size_t>(options_.num_workers, 1);
+    options_.ring_slots = next_power_of_two(std::max<size_t>(options_.ring_slots, 1));
+}
+
+ProcessPool::~ProcessPool() {
+    shutdown();
+}
+
+bool ProcessPool::start() {
+    if (running_ || stopping_) {
+        return false;
+    }
+
+    completion_fd_ = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    submit_fd_ = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    bool ready = completion_fd_ >= 0 && submit_fd_ >= 0 && epoll_fd_ >= 0;
+    for (int fd : {completion_fd_, submit_fd_}) {
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        ready = ready && ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) == 0;
+    }
+
+    size_t dispatch_bytes = round_up(DispatchRing::bytes_for(options_.ring_slots), REGION_ALIGNMENT);
+    size_t completion_bytes = round_up(CompletionRing::bytes_for(options_.ring_slots), REGION_ALIGNMENT);
+    for (size_t i = 0; ready && i < options_.num_workers; ++i) {
+        auto worker = std::make_unique<Worker>();
+        worker->region_bytes = dispatch_bytes + completion_bytes + options_.arena_bytes;
+        worker->region = ::mmap(nullptr, worker->region_bytes, PROT_READ | PROT_WRITE,
+                                MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        worker->wake_fd = ::eventfd(0, EFD_CLOEXEC);
+        ready = worker->region != MAP_FAILED && worker->wake_fd >= 0;
+        if (ready) {
+            auto* base = static_cast<uint8_t*>(worker->region);
+            worker->arena = base + dispatch_bytes + completion_bytes;
+            ready = spawn_worker(*worker);
+        }
+        workers_.push_back(std::move(worker));
+    }
+
+    if (!ready) {
+        stop_workers();
+        return false;
+    }
+
+    running_ = true;
+    coordinator_ = std::thread(&ProcessPool::coordinator_loop, this);
+    return true;
+}
+
+bool ProcessPool::spawn_worker(Worker& worker) {
+    auto* base = static_cast<uint8_t*>(worker.region);
+    size_t dispatch_bytes = round_up(DispatchRing::bytes_for(options_.ring_slots), REGION_ALIGNMENT);
+    worker.dispatch = DispatchRing::create(base, options_.ring_slots);
+    worker.completions = CompletionRing::create(base + dispatch_bytes, options_.ring_slots);
+    worker.arena_head = 0;
+    worker.arena_tail = 0;
+
+    pid_t pid = ::fork();
+    if (pid == 0) {
+        run_worker(registry_, *worker.dispatch, *worker.completions, worker.arena,
+                   worker.wake_fd, completion_fd_);
+    }
+    worker.pid = pid;
+    return pid > 0;
+}
+
+void ProcessPool::shutdown() {
+    if (!running_ || stopping_.exchange(true)) {
+        return;
+    }
+
+    signal_eventfd(submit_fd_);
+    coordinator_.join();
+
+    // What is left waits on prerequisites that will never complete
+    drop_tasks(dependency_tracker_.drain());
+    running_ = false;
+    stop_workers();
+}
+
+void ProcessPool::stop_workers() {
+    for (auto& worker : workers_) {
+        pid_t pid = worker->pid;
+        if (pid > 0) {
+            worker->dispatch->try_push({STOP_WORKER, UNREGISTERED_TASK_TYPE, 0, 0});
+            signal_eventfd(worker->wake_fd);
+            ::waitpid(pid, nullptr, 0);
+            worker->pid = -1;
+        }
+        if (worker->region != MAP_FAILED) {
+            ::munmap(worker->region, worker->region_bytes);
+        }
+        if (worker->wake_fd >= 0) {
+            ::close(worker->wake_fd);
+        }
+    }
+    workers_.clear();
+
+    for (int* fd : {&completion_fd_, &submit_fd_, &epoll_fd_}) {
+        if (*fd >= 0) {
+            ::close(*fd);
+            *fd = -1;
+        }
+    }
+}
+
+TaskId ProcessPool::submit(const TaskSpec& spec) {
+    if (!running_ || stopping_ || !registry_.contains(spec.type) ||
+        spec.arguments.size() > options_.arena_bytes) {
+        return INVALID_TASK_ID;
+    }
+
+    // The closure never runs here; the worker looks the handler up by type
+    auto task = std::make_unique<Task>([]() {}, spec.priority, spec.dependencies);
+    task->set_task_type(spec.type);
+    task->set_task_class(spec.task_class);
+    if (spec.deadline.has_value()) {
+        task->set_deadline(spec.deadline.value());
+    }
+
+    TaskId task_id = dependency_tracker_.assign_id(task);
+    {
+        std::lock_guard<std::mutex> lock(arguments_mutex_);
+        arguments_.emplace(task_id, spec.arguments);
+    }
+    outstanding_.fetch_add(1);
+
+    if (task->dependency_list().empty()) {
+        queue_.push(std::move(task));
+    } else if (auto ready = dependency_tracker_.add_task(std::move(task))) {
+        if (ready->is_cancelled()) {
+            // Depends on an id that was never assigned
+            auto dropped = dependency_tracker_.cancel_dependents(task_id);
+            dropped.push_back(std::move(ready));
+            drop_tasks(std::move(dropped));
+            return INVALID_TASK_ID;
+        }
+        queue_.push(std::move(ready));
+    }
+    signal_eventfd(submit_fd_);
+    return task_id;
+}
+
+void ProcessPool::coordinator_loop() {
+    epoll_event events[2];
+    for (;;) {
+        int count = ::epoll_wait(epoll_fd_, events, 2, WORKER_CHECK_INTERVAL_MS);
+        for (int i = 0; i < count; ++i) {
+            clear_eventfd(events[i].data.fd);
+        }
+
+        for (auto& worker : workers_) {
+            collect_completions(*worker);
+            check_worker(*worker);
+        }
+        dispatch_ready();
+
+        bool idle = queue_.empty() &&
+            std::all_of(workers_.begin(), workers_.end(),
+                        [](const std::unique_ptr<Worker>& worker) { return worker->in_flight.empty(); });
+        if (stopping_ && idle) {
+            break;
+        }
+    }
+}
+
+void ProcessPool::collect_completions(Worker& worker) {
+    CompletionSlot completion;
+    while (worker.completions->try_pop(completion)) {
+        auto it = std::find_if(worker.in_flight.begin(), worker.in_flight.end(),
+                               [&completion](const Worker::InFlight& entry) {
+                                   return entry.task->id() == completion.id;
+                               });
+        if (it == worker.in_flight.end()) {
+            continue;
+        }
+        std::unique_ptr<Task> task = std::move(it->task);
+        worker.arena_tail = std::max(worker.arena_tail, it->arena_end);
+        worker.in_flight.erase(it);
+
+        bool succeeded = completion.status == CompletionStatus::SUCCEEDED;
+        if (succeeded) {
+            statistics_.record_task_completed(static_cast<double>(completion.execution_ns) / 1e6);
+        }
+        finish_task(std::move(task), succeeded);
+    }
+}
+
+void ProcessPool::check_worker(Worker& worker) {
+    pid_t pid = worker.pid;
+    if (pid <= 0 || ::waitpid(pid, nullptr, WNOHANG) != pid) {
+        return;
+    }
+
+    collect_completions(worker);  // Whatever it reported before it died
+
+    // A task it took but never reported is the one it died running
+    bool died_running = worker.dispatch->popped() > worker.completions->pushed();
+    if (died_running && !worker.in_flight.empty()) {
+        finish_task(std::move(worker.in_flight.front().task), false);
+        worker.in_flight.pop_front();
+    }
+    for (auto& entry : worker.in_flight) {
+        queue_.push(std::move(entry.task));
+    }
+    worker.in_flight.clear();
+
+    worker.pid = -1;
+    worker_restarts_.fetch_add(1, std::memory_order_relaxed);
+    spawn_worker(worker);
+}
+
+void ProcessPool::dispatch_ready() {
+    size_t capacity = options_.ring_slots;
+    for (;;) {
+        // Least loaded live workers first
+        std::vector<Worker*> candidates;
+        for (auto& worker : workers_) {
+            if (worker->pid > 0 && worker->in_flight.size() < capacity) {
+                candidates.push_back(worker.get());
+            }
+        }
+        if (candidates.empty()) {
+            return;
+        }
+        std::sort(candidates.begin(), candidates.end(), [](const Worker* a, const Worker* b) {
+            return a->in_flight.size() < b->in_flight.size();
+        });
+
+        auto task = queue_.pop_for(std::chrono::milliseconds(0));
+        if (!task) {
+            return;
+        }
+
+        bool dispatched = std::any_of(candidates.begin(), candidates.end(),
+                                      [this, &task](Worker* worker) { return dispatch_to(*worker, task); });
+        if (!dispatched) {
+            queue_.push(std::move(task));  // Every arena is full; wait for completions
+            return;
+        }
+    }
+}
+
+bool ProcessPool::dispatch_to(Worker& worker, std::unique_ptr<Task>& task) {
+    std::lock_guard<std::mutex> lock(arguments_mutex_);
+    const std::string& arguments = arguments_[task->id()];
+
+    // Arguments are contiguous; skip the end of the arena if they would wrap
+    uint64_t size = options_.arena_bytes;
+    uint64_t start = worker.arena_head;
+    if (start % size + arguments.size() > size) {
+        start += size - start % size;
+    }
+    uint64_t end = start + arguments.size();
+    if (end - worker.arena_tail > size) {
+        return false;
+    }
+
+    uint64_t offset = (arguments.size() > 0) ? start % size : 0;
+    std::memcpy(worker.arena + offset, arguments.data(), arguments.size());
+    DispatchSlot slot{task->id(), task->task_type(), static_cast<uint32_t>(arguments.size()), offset};
+    if (!worker.dispatch->try_push(slot)) {
+        return false;
+    }
+
+    worker.arena_head = end;
+    worker.in_flight.push_back({std::move(task), end});
+    signal_eventfd(worker.wake_fd);
+    return true;
+}
+
+void ProcessPool::finish_task(std::unique_ptr<Task> task, bool succeeded) {
+    TaskId task_id = task->id();
+    {
+        std::lock_guard<std::mutex> lock(arguments_mutex_);
+        arguments_.erase(task_id);
+    }
+
+    if (succeeded) {
+        for (auto& ready : dependency_tracker_.complete(task_id)) {
+            queue_.push(std::move(ready));
+        }
+    } else {
+        failed_tasks_.fetch_add(1, std::memory_order_relaxed);
+        drop_tasks(dependency_tracker_.cancel_dependents(task_id));
+    }
+    outstanding_.fetch_sub(1);
+}
+
+void ProcessPool::drop_tasks(std::vector<std::unique_ptr<Task>> tasks) {
+    std::lock_guard<std::mutex> lock(arguments_mutex_);
+    for (const auto& task : tasks) {
+        arguments_.erase(task->id());
+    }
+    outstanding_.fetch_sub(tasks.size());
+}
+
+size_t ProcessPool::worker_count() const {
+    return options_.num_workers;
+}
+
+std::vector<pid_t> ProcessPool::worker_pids() const {
+    std::vector<pid_t> pids;
+    if (!running_) {
+        return pids;
+    }
+    for (const auto& worker : workers_) {
+        pids.push_back(worker->pid);
+    }
+    return pids;
+}
+
+bool ProcessPool::is_running() const {
+    return running_ && !stopping_;
+}
+
+StatisticsSnapshot ProcessPool::get_statistics() const {
+    StatisticsSnapshot snapshot = statistics_.get_snapshot();
+    snapshot.queue_depth = queue_.size();
+    snapshot.pending_task_count = outstanding_.load();
+    snapshot.pending_dependencies = dependency_tracker_.pending_count();
+    return snapshot;
+}
+
+size_t ProcessPool::failed_tasks() const {
+    return failed_tasks_.load(std::memory_order_relaxed);
+}
+
+size_t ProcessPool::worker_restarts() const {
+    return worker_restarts_.load(std::memory_order_relaxed);
+}
+
+} // namespace taskscheduler
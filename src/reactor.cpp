@@ -0,0 +1,199 @@
+#include "taskscheduler/reactor.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+namespace taskscheduler {
+
+namespace {
+
+// Watches are keyed by task id; the wake-up eventfd uses the invalid id.
+constexpr uint64_t WAKE_KEY = INVALID_TASK_ID;
+constexpr int MAX_EVENTS = 64;
+
+uint32_t to_epoll_events(IoInterest interest) {
+    switch (interest) {
+        case IoInterest::READABLE:
+            return EPOLLIN;
+        case IoInterest::WRITABLE:
+            return EPOLLOUT;
+        case IoInterest::READ_WRITE:
+        default:
+            return EPOLLIN | EPOLLOUT;
+    }
+}
+
+} // namespace
+
+Reactor::Reactor(Dispatch dispatch) : dispatch_(std::move(dispatch)) {
+    epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    wake_fd_ = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (epoll_fd_ >= 0 && wake_fd_ >= 0) {
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = WAKE_KEY;
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &event);
+    }
+}
+
+Reactor::~Reactor() {
+    stop();
+    if (wake_fd_ >= 0) {
+        ::close(wake_fd_);
+    }
+    if (epoll_fd_ >= 0) {
+        ::close(epoll_fd_);
+    }
+}
+
+bool Reactor::watch(int fd, IoInterest interest, std::unique_ptr<Task>& task) {
+    return add_watch(fd, false, to_epoll_events(interest), task);
+}
+
+bool Reactor::watch_timer(std::chrono::nanoseconds delay, std::unique_ptr<Task>& task) {
+    int timer_fd = ::timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    if (timer_fd < 0) {
+        return false;
+    }
+
+    // A zero it_value disarms the timer, so fire immediate timers after 1ns
+    auto ns = std::max<int64_t>(delay.count(), 1);
+    itimerspec spec{};
+    spec.it_value.tv_sec = static_cast<time_t>(ns / 1000000000);
+    spec.it_value.tv_nsec = static_cast<long>(ns % 1000000000);
+    if (::timerfd_settime(timer_fd, 0, &spec, nullptr) != 0 ||
+        !add_watch(timer_fd, true, EPOLLIN, task)) {
+        ::close(timer_fd);
+        return false;
+    }
+    return true;
+}
+
+bool Reactor::add_watch(int fd, bool owns_fd, uint32_t events, std::unique_ptr<Task>& task) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopped_ || epoll_fd_ < 0 || fd < 0) {
+        return false;
+    }
+
+    TaskId id = task->id();
+    epoll_event event{};
+    event.events = events;
+    event.data.u64 = id;
+    if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) != 0) {
+        return false;  // Bad descriptor, regular file, or already watched
+    }
+
+    watches_.emplace(id, Watch{fd, owns_fd, std::move(task)});
+    pending_.store(watches_.size(), std::memory_order_release);
+    if (!owns_fd) {
+        pending_io_.fetch_add(1, std::memory_order_release);
+    }
+    ensure_started_locked();
+    return true;
+}
+
+std::unique_ptr<Task> Reactor::cancel(TaskId id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return remove_watch_locked(id);
+}
+
+std::unique_ptr<Task> Reactor::remove_watch_locked(TaskId id) {
+    auto it = watches_.find(id);
+    if (it == watches_.end()) {
+        return nullptr;
+    }
+
+    Watch watch = std::move(it->second);
+    watches_.erase(it);
+    pending_.store(watches_.size(), std::memory_order_release);
+
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, watch.fd, nullptr);
+    if (watch.owns_fd) {
+        ::close(watch.fd);
+    } else {
+        pending_io_.fetch_sub(1, std::memory_order_release);
+    }
+    return std::move(watch.task);
+}
+
+size_t Reactor::pending_count() const {
+    return pending_.load(std::memory_order_acquire);
+}
+
+size_t Reactor::pending_io_count() const {
+    return pending_io_.load(std::memory_order_acquire);
+}
+
+std::vector<std::unique_ptr<Task>> Reactor::stop() {
+    std::thread thread;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopped_ = true;
+        thread = std::move(thread_);
+    }
+
+    if (thread.joinable()) {
+        uint64_t one = 1;
+        ssize_t written = ::write(wake_fd_, &one, sizeof(one));
+        (void)written;
+        thread.join();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::unique_ptr<Task>> remaining;
+    remaining.reserve(watches_.size());
+    while (!watches_.empty()) {
+        remaining.push_back(remove_watch_locked(watches_.begin()->first));
+    }
+    return remaining;
+}
+
+void Reactor::ensure_started_locked() {
+    if (!thread_.joinable()) {
+        thread_ = std::thread(&Reactor::run, this);
+    }
+}
+
+void Reactor::run() {
+    epoll_event events[MAX_EVENTS];
+    std::vector<std::unique_ptr<Task>> ready;
+
+    for (;;) {
+        int count = ::epoll_wait(epoll_fd_, events, MAX_EVENTS, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopped_) {
+                return;
+            }
+            for (int i = 0; i < count; ++i) {
+                if (events[i].data.u64 == WAKE_KEY) {
+                    continue;
+                }
+                // Cancelled after epoll_wait returned, or an earlier event
+                // in this batch for the same watch
+                if (auto task = remove_watch_locked(events[i].data.u64)) {
+                    ready.push_back(std::move(task));
+                }
+            }
+        }
+
+        // Dispatched outside the lock so the pool may watch again from it
+        for (auto& task : ready) {
+            dispatch_(std::move(task));
+        }
+        ready.clear();
+    }
+}
+
+} // namespace taskscheduler
@@ -0,0 +1,132 @@
+#include "taskscheduler/result_cache.hpp"
+
+namespace taskscheduler {
+
+ResultCache::Ticket::Ticket(std::shared_ptr<ResultCache> cache, std::string key, uint64_t id)
+    : cache_(std::move(cache)), key_(std::move(key)), id_(id) {}
+
+ResultCache::Ticket::~Ticket() {
+    abandon();
+}
+
+void ResultCache::Ticket::submitted() {
+    cache_->submitted(key_, id_);
+}
+
+void ResultCache::Ticket::complete() {
+    if (!settled_) {
+        settled_ = true;
+        cache_->complete(key_, id_);
+    }
+}
+
+void ResultCache::Ticket::abandon() {
+    if (!settled_) {
+        settled_ = true;
+        cache_->abandon(key_, id_);
+    }
+}
+
+void ResultCache::set_limits(const ResultCacheLimits& limits) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    limits_ = limits;
+    evict_locked();
+}
+
+ResultCacheLimits ResultCache::limits() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return limits_;
+}
+
+ResultCache::Lookup ResultCache::acquire(const std::string& key, std::any& future,
+                                         std::shared_ptr<Ticket>& ticket) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it != entries_.end() && it->second.finished && limits_.ttl.count() > 0 &&
+        Clock::now() - it->second.finished_at >= limits_.ttl) {
+        erase_locked(it);
+        it = entries_.end();
+    }
+
+    if (it != entries_.end()) {
+        Entry& entry = it->second;
+        if (entry.future.type() != future.type()) {
+            return Lookup::MISS;  // Run it, but leave the other type's entry alone
+        }
+        if (!entry.submitted && !entry.finished) {
+            return Lookup::MISS;  // Its task may yet be rejected
+        }
+        future = entry.future;
+        if (!entry.finished) {
+            return Lookup::IN_FLIGHT;
+        }
+        finished_.splice(finished_.end(), finished_, entry.recency);
+        return Lookup::HIT;
+    }
+
+    uint64_t id = next_id_++;
+    entries_.emplace(key, Entry(future, id));
+    ticket.reset(new Ticket(shared_from_this(), key, id));
+    return Lookup::MISS;
+}
+
+void ResultCache::submitted(const std::string& key, uint64_t id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it != entries_.end() && it->second.id == id) {
+        it->second.submitted = true;
+    }
+}
+
+void ResultCache::complete(const std::string& key, uint64_t id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end() || it->second.id != id) {
+        return;  // Cleared while the task ran
+    }
+    if (limits_.max_entries == 0) {
+        entries_.erase(it);
+        return;
+    }
+
+    Entry& entry = it->second;
+    entry.finished = true;
+    entry.finished_at = Clock::now();
+    entry.recency = finished_.insert(finished_.end(), key);
+    evict_locked();
+}
+
+void ResultCache::abandon(const std::string& key, uint64_t id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it != entries_.end() && it->second.id == id) {
+        erase_locked(it);
+    }
+}
+
+void ResultCache::erase_locked(std::unordered_map<std::string, Entry>::iterator it) {
+    if (it->second.finished) {
+        finished_.erase(it->second.recency);
+    }
+    entries_.erase(it);
+}
+
+void ResultCache::evict_locked() {
+    while (finished_.size() > limits_.max_entries) {
+        entries_.erase(finished_.front());
+        finished_.pop_front();
+    }
+}
+
+void ResultCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    finished_.clear();
+}
+
+size_t ResultCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+} // namespace taskscheduler
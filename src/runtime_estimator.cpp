@@ -0,0 +1,55 @@
+#include "taskscheduler/runtime_estimator.hpp"
+
+namespace taskscheduler {
+
+namespace {
+
+constexpr double UNOBSERVED = -1.0;
+
+} // namespace
+
+RuntimeEstimator::RuntimeEstimator(double smoothing) : smoothing_(smoothing) {
+    for (auto& estimate : direct_estimates_) {
+        estimate.store(UNOBSERVED, std::memory_order_relaxed);
+    }
+}
+
+void RuntimeEstimator::record(TaskClassId task_class, double execution_time_ms) {
+    if (task_class == DEFAULT_TASK_CLASS) {
+        return;
+    }
+    if (task_class < DIRECT_CLASSES) {
+        auto& estimate = direct_estimates_[task_class];
+        double current = estimate.load(std::memory_order_relaxed);
+        double updated;
+        do {
+            updated = (current < 0.0)
+                ? execution_time_ms
+                : current + smoothing_ * (execution_time_ms - current);
+        } while (!estimate.compare_exchange_weak(current, updated, std::memory_order_relaxed));
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = estimates_.find(task_class);
+    if (it == estimates_.end()) {
+        estimates_.emplace(task_class, execution_time_ms);
+    } else {
+        it->second += smoothing_ * (execution_time_ms - it->second);
+    }
+}
+
+double RuntimeEstimator::estimate(TaskClassId task_class) const {
+    if (task_class < DIRECT_CLASSES) {
+        double current = direct_estimates_[task_class].load(std::memory_order_relaxed);
+        return current < 0.0 ? 0.0 : current;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = estimates_.find(task_class);
+    return it != estimates_.end() ? it->second : 0.0;
+}
+
+} // namespace taskscheduler
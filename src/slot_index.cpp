@@ -0,0 +1,86 @@
+#include "taskscheduler/slot_index.hpp"
+
+namespace taskscheduler {
+
+uint32_t SlotIndex::find(TaskId id) const {
+    if (entries_.empty() || id == INVALID_TASK_ID) {
+        return NO_SLOT;
+    }
+
+    size_t mask = entries_.size() - 1;
+    for (size_t i = home(id); ; i = (i + 1) & mask) {
+        if (entries_[i].id == id) {
+            return entries_[i].slot;
+        }
+        if (entries_[i].id == INVALID_TASK_ID) {
+            return NO_SLOT;
+        }
+    }
+}
+
+void SlotIndex::insert(TaskId id, uint32_t slot) {
+    // At most three quarters full, so probes stay short
+    if ((size_ + 1) * 4 > entries_.size() * 3) {
+        grow();
+    }
+
+    size_t mask = entries_.size() - 1;
+    size_t i = home(id);
+    while (entries_[i].id != INVALID_TASK_ID) {
+        i = (i + 1) & mask;
+    }
+    entries_[i] = Entry{id, slot};
+    ++size_;
+}
+
+void SlotIndex::erase(TaskId id) {
+    if (entries_.empty() || id == INVALID_TASK_ID) {
+        return;
+    }
+
+    size_t mask = entries_.size() - 1;
+    size_t hole = home(id);
+    while (entries_[hole].id != id) {
+        if (entries_[hole].id == INVALID_TASK_ID) {
+            return;
+        }
+        hole = (hole + 1) & mask;
+    }
+
+    // Shift later entries of the probe run back instead of leaving a
+    // tombstone, so lookups never walk over deleted entries.
+    for (size_t next = (hole + 1) & mask; entries_[next].id != INVALID_TASK_ID; next = (next + 1) & mask) {
+        size_t wanted = home(entries_[next].id);
+        bool stays = hole <= next ? (wanted > hole && wanted <= next)
+                                  : (wanted > hole || wanted <= next);
+        if (!stays) {
+            entries_[hole] = entries_[next];
+            hole = next;
+        }
+    }
+    entries_[hole] = Entry{};
+    --size_;
+}
+
+void SlotIndex::clear() {
+    std::vector<Entry>().swap(entries_);
+    size_ = 0;
+}
+
+size_t SlotIndex::home(TaskId id) const {
+    // Fibonacci hashing; the high bits mix all of the id
+    return static_cast<size_t>((id * 0x9E3779B97F4A7C15ULL) >> 32) & (entries_.size() - 1);
+}
+
+void SlotIndex::grow() {
+    std::vector<Entry> old = std::move(entries_);
+    entries_.assign(old.empty() ? 64 : old.size() * 2, Entry{});
+    size_ = 0;
+    for (const Entry& entry : old) {
+        if (entry.id != INVALID_TASK_ID) {
+            insert(entry.id, entry.slot);
+        }
+    }
+}
+
+} // namespace taskscheduler
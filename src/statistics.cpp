@@ -1,22 +1,55 @@
 #include "taskscheduler/statistics.hpp"
+#include <algorithm>
 
 namespace taskscheduler {
 
+const std::array<double, CumulativeStatistics::EXECUTION_TIME_BUCKETS>
+    CumulativeStatistics::EXECUTION_TIME_BUCKET_BOUNDS_MS = {
+        0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5,
+        5.0, 10.0, 25.0, 50.0, 100.0, 250.0, 1000.0, 10000.0
+    };
+
 Statistics::Statistics() {}
 
-void Statistics::record_task_completed(double execution_time_ms) {
-    completed_tasks_.fetch_add(1, std::memory_order_relaxed);
+namespace {
+
+// Lock-free read-modify-write helpers for std::atomic<double>, which has no
+// fetch_add/min/max before C++20.
+void atomic_add(std::atomic<double>& target, double value) {
+    double current = target.load(std::memory_order_relaxed);
+    while (!target.compare_exchange_weak(current, current + value, std::memory_order_relaxed)) {
+    }
+}
 
-    std::lock_guard<std::mutex> lock(execution_time_mutex_);
-    total_execution_time_ms_ += execution_time_ms;
-    if (execution_time_ms < min_execution_time_ms_) {
-        min_execution_time_ms_ = execution_time_ms;
+void atomic_min(std::atomic<double>& target, double value) {
+    double current = target.load(std::memory_order_relaxed);
+    while (value < current &&
+           !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
     }
-    if (execution_time_ms > max_execution_time_ms_) {
-        max_execution_time_ms_ = execution_time_ms;
+}
+
+void atomic_max(std::atomic<double>& target, double value) {
+    double current = target.load(std::memory_order_relaxed);
+    while (value > current &&
+           !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
     }
 }
 
+} // namespace
+
+void Statistics::record_task_completed(double execution_time_ms) {
+    atomic_add(total_execution_time_ms_, execution_time_ms);
+    atomic_min(min_execution_time_ms_, execution_time_ms);
+    atomic_max(max_execution_time_ms_, execution_time_ms);
+    completed_tasks_.fetch_add(1, std::memory_order_release);
+
+    const auto& bounds = CumulativeStatistics::EXECUTION_TIME_BUCKET_BOUNDS_MS;
+    size_t bucket = std::lower_bound(bounds.begin(), bounds.end(), execution_time_ms) - bounds.begin();
+    execution_time_buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+    atomic_add(lifetime_execution_time_ms_, execution_time_ms);
+    lifetime_completed_tasks_.fetch_add(1, std::memory_order_relaxed);
+}
+
 void Statistics::increment_active_workers() {
     active_workers_.fetch_add(1, std::memory_order_relaxed);
 }
@@ -25,35 +58,151 @@ void Statistics::decrement_active_workers() {
     active_workers_.fetch_sub(1, std::memory_order_relaxed);
 }
 
-void Statistics::set_queue_depth(size_t depth) {
-    queue_depth_.store(depth, std::memory_order_relaxed);
+void Statistics::record_task_rejected() {
+    rejected_tasks_.fetch_add(1, std::memory_order_relaxed);
+    lifetime_rejected_tasks_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Statistics::record_task_shed() {
+    shed_tasks_.fetch_add(1, std::memory_order_relaxed);
+    lifetime_shed_tasks_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Statistics::record_priority_inheritance(size_t boosted_tasks) {
+    priority_inheritance_boosts_.fetch_add(boosted_tasks, std::memory_order_relaxed);
+    lifetime_priority_inheritance_boosts_.fetch_add(boosted_tasks, std::memory_order_relaxed);
+}
+
+void Statistics::record_inline_continuation() {
+    inline_continuations_.fetch_add(1, std::memory_order_relaxed);
+    lifetime_inline_continuations_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Statistics::record_compensating_worker() {
+    compensating_workers_spawned_.fetch_add(1, std::memory_order_relaxed);
+    lifetime_compensating_workers_spawned_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Statistics::record_blocked(double blocked_time_ms) {
+    atomic_add(blocked_time_ms_, blocked_time_ms);
+    atomic_add(lifetime_blocked_time_ms_, blocked_time_ms);
+}
+
+void Statistics::record_result_cache_hit() {
+    result_cache_hits_.fetch_add(1, std::memory_order_relaxed);
+    lifetime_result_cache_hits_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Statistics::record_deduplicated_submit() {
+    deduplicated_submits_.fetch_add(1, std::memory_order_relaxed);
+    lifetime_deduplicated_submits_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Statistics::record_result_cache_miss() {
+    result_cache_misses_.fetch_add(1, std::memory_order_relaxed);
+    lifetime_result_cache_misses_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Statistics::record_coalesced_items(size_t items) {
+    coalesced_items_.fetch_add(items, std::memory_order_relaxed);
+    lifetime_coalesced_items_.fetch_add(items, std::memory_order_relaxed);
+}
+
+void Statistics::record_long_running_task() {
+    long_running_tasks_.fetch_add(1, std::memory_order_relaxed);
+    lifetime_long_running_tasks_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Statistics::record_stalled_worker() {
+    stalled_workers_.fetch_add(1, std::memory_order_relaxed);
+    lifetime_stalled_workers_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Statistics::record_shutdown(double shutdown_time_ms) {
+    last_shutdown_time_ms_.store(shutdown_time_ms, std::memory_order_relaxed);
 }
 
 StatisticsSnapshot Statistics::get_snapshot() const {
     StatisticsSnapshot snapshot;
-    snapshot.completed_tasks = completed_tasks_.load(std::memory_order_relaxed);
+    size_t completed = completed_tasks_.load(std::memory_order_acquire);
+    snapshot.completed_tasks = completed;
     snapshot.active_workers = active_workers_.load(std::memory_order_relaxed);
-    snapshot.queue_depth = queue_depth_.load(std::memory_order_relaxed);
+    snapshot.queue_depth = 0;
+    snapshot.pending_task_count = 0;
+    snapshot.pending_task_bytes = 0;
+    snapshot.rejected_tasks = rejected_tasks_.load(std::memory_order_relaxed);
+    snapshot.shed_tasks = shed_tasks_.load(std::memory_order_relaxed);
+    snapshot.priority_inheritance_boosts = priority_inheritance_boosts_.load(std::memory_order_relaxed);
+    snapshot.inline_continuations = inline_continuations_.load(std::memory_order_relaxed);
+    snapshot.last_shutdown_time_ms = last_shutdown_time_ms_.load(std::memory_order_relaxed);
+    snapshot.pending_dependencies = 0;
+    snapshot.blocked_workers = 0;
+    snapshot.compensating_workers_spawned = compensating_workers_spawned_.load(std::memory_order_relaxed);
+    snapshot.blocked_time_ms = blocked_time_ms_.load(std::memory_order_relaxed);
+    snapshot.result_cache_hits = result_cache_hits_.load(std::memory_order_relaxed);
+    snapshot.deduplicated_submits = deduplicated_submits_.load(std::memory_order_relaxed);
+    snapshot.result_cache_misses = result_cache_misses_.load(std::memory_order_relaxed);
+    snapshot.coalesced_items = coalesced_items_.load(std::memory_order_relaxed);
+    snapshot.longest_running_task = INVALID_TASK_ID;
+    snapshot.longest_running_task_ms = 0.0;
+    snapshot.long_running_tasks = long_running_tasks_.load(std::memory_order_relaxed);
+    snapshot.stalled_workers = stalled_workers_.load(std::memory_order_relaxed);
 
-    std::lock_guard<std::mutex> lock(execution_time_mutex_);
-    snapshot.min_execution_time_ms = (completed_tasks_.load() > 0) ? min_execution_time_ms_ : 0.0;
-    snapshot.max_execution_time_ms = max_execution_time_ms_;
-    snapshot.avg_execution_time_ms = (completed_tasks_.load() > 0) 
-        ? total_execution_time_ms_ / completed_tasks_.load() 
+    snapshot.min_execution_time_ms = (completed > 0)
+        ? min_execution_time_ms_.load(std::memory_order_relaxed)
+        : 0.0;
+    snapshot.max_execution_time_ms = max_execution_time_ms_.load(std::memory_order_relaxed);
+    snapshot.avg_execution_time_ms = (completed > 0)
+        ? total_execution_time_ms_.load(std::memory_order_relaxed) / completed
         : 0.0;
 
     return snapshot;
 }
 
+CumulativeStatistics Statistics::get_cumulative() const {
+    CumulativeStatistics cumulative;
+    cumulative.completed_tasks = lifetime_completed_tasks_.load(std::memory_order_relaxed);
+    cumulative.rejected_tasks = lifetime_rejected_tasks_.load(std::memory_order_relaxed);
+    cumulative.shed_tasks = lifetime_shed_tasks_.load(std::memory_order_relaxed);
+    cumulative.priority_inheritance_boosts =
+        lifetime_priority_inheritance_boosts_.load(std::memory_order_relaxed);
+    cumulative.inline_continuations = lifetime_inline_continuations_.load(std::memory_order_relaxed);
+    cumulative.compensating_workers_spawned =
+        lifetime_compensating_workers_spawned_.load(std::memory_order_relaxed);
+    cumulative.result_cache_hits = lifetime_result_cache_hits_.load(std::memory_order_relaxed);
+    cumulative.deduplicated_submits = lifetime_deduplicated_submits_.load(std::memory_order_relaxed);
+    cumulative.result_cache_misses = lifetime_result_cache_misses_.load(std::memory_order_relaxed);
+    cumulative.coalesced_items = lifetime_coalesced_items_.load(std::memory_order_relaxed);
+    cumulative.long_running_tasks = lifetime_long_running_tasks_.load(std::memory_order_relaxed);
+    cumulative.stalled_workers = lifetime_stalled_workers_.load(std::memory_order_relaxed);
+    cumulative.total_execution_time_ms = lifetime_execution_time_ms_.load(std::memory_order_relaxed);
+    cumulative.blocked_time_ms = lifetime_blocked_time_ms_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < execution_time_buckets_.size(); ++i) {
+        cumulative.execution_time_buckets[i] = execution_time_buckets_[i].load(std::memory_order_relaxed);
+    }
+    return cumulative;
+}
+
 void Statistics::reset() {
     completed_tasks_.store(0, std::memory_order_relaxed);
     active_workers_.store(0, std::memory_order_relaxed);
-    queue_depth_.store(0, std::memory_order_relaxed);
+    rejected_tasks_.store(0, std::memory_order_relaxed);
+    shed_tasks_.store(0, std::memory_order_relaxed);
+    priority_inheritance_boosts_.store(0, std::memory_order_relaxed);
+    inline_continuations_.store(0, std::memory_order_relaxed);
+    compensating_workers_spawned_.store(0, std::memory_order_relaxed);
+    blocked_time_ms_.store(0.0, std::memory_order_relaxed);
+    result_cache_hits_.store(0, std::memory_order_relaxed);
+    deduplicated_submits_.store(0, std::memory_order_relaxed);
+    result_cache_misses_.store(0, std::memory_order_relaxed);
+    coalesced_items_.store(0, std::memory_order_relaxed);
+    long_running_tasks_.store(0, std::memory_order_relaxed);
+    stalled_workers_.store(0, std::memory_order_relaxed);
+    last_shutdown_time_ms_.store(0.0, std::memory_order_relaxed);
 
-    std::lock_guard<std::mutex> lock(execution_time_mutex_);
-    min_execution_time_ms_ = std::numeric_limits<double>::max();
-    max_execution_time_ms_ = 0.0;
-    total_execution_time_ms_ = 0.0;
+    min_execution_time_ms_.store(std::numeric_limits<double>::max(), std::memory_order_relaxed);
+    max_execution_time_ms_.store(0.0, std::memory_order_relaxed);
+    total_execution_time_ms_.store(0.0, std::memory_order_relaxed);
 }
 
 } // namespace taskscheduler
@@ -1,12 +1,13 @@
 #include "taskscheduler/task.hpp"
+#include <algorithm>
 
 namespace taskscheduler {
 
 Task::Task(Callable callable, Priority priority)
-    : callable_(std::move(callable)), priority_(priority) {}
+    : callable_(std::move(callable)), base_priority_(priority) {}
 
 Task::Task(Callable callable, Priority priority, const std::vector<TaskId>& dependencies)
-    : callable_(std::move(callable)), priority_(priority), dependencies_(dependencies) {}
+    : callable_(std::move(callable)), base_priority_(priority), dependencies_(dependencies) {}
 
 void Task::execute() {
     if (!is_cancelled() && callable_) {
@@ -15,31 +16,122 @@ void Task::execute() {
 }
 
 Priority Task::priority() const {
-    return priority_;
+    return std::max(base_priority_, inherited_priority_);
+}
+
+Priority Task::base_priority() const {
+    return base_priority_;
+}
+
+void Task::set_priority(Priority priority) {
+    base_priority_ = priority;
 }
 
 TaskId Task::id() const {
     return id_;
 }
 
-const std::vector<TaskId>& Task::dependencies() const {
+std::vector<TaskId> Task::dependencies() const {
+    return std::vector<TaskId>(dependencies_.begin(), dependencies_.end());
+}
+
+const TaskIdList& Task::dependency_list() const {
     return dependencies_;
 }
 
+void Task::set_dependencies(TaskIdList dependencies) {
+    dependencies_ = std::move(dependencies);
+}
+
 void Task::set_id(TaskId id) {
     id_ = id;
 }
 
 void Task::set_deadline(TimePoint deadline) {
-    deadline_ = deadline;
+    // An earlier deadline inherited from a dependent still applies
+    deadline_ticks_ = std::min(to_ticks(deadline), inherited_deadline_ticks_);
 }
 
 std::optional<Task::TimePoint> Task::deadline() const {
-    return deadline_;
+    if (!has_deadline()) {
+        return std::nullopt;
+    }
+    return TimePoint(TimePoint::duration(deadline_ticks_));
 }
 
 bool Task::has_deadline() const {
-    return deadline_.has_value();
+    return deadline_ticks_ != NO_DEADLINE;
+}
+
+int64_t Task::to_ticks(TimePoint deadline) {
+    // TimePoint::max() would collide with the no-deadline sentinel
+    return std::min<int64_t>(deadline.time_since_epoch().count(), NO_DEADLINE - 1);
+}
+
+int64_t Task::deadline_key() const {
+    return deadline_ticks_;
+}
+
+bool Task::inherit_priority(Priority priority) {
+    bool raised = priority > this->priority();
+    inherited_priority_ = std::max(inherited_priority_, priority);
+    return raised;
+}
+
+bool Task::inherit_deadline(TimePoint deadline) {
+    int64_t ticks = to_ticks(deadline);
+    inherited_deadline_ticks_ = std::min(inherited_deadline_ticks_, ticks);
+    if (ticks >= deadline_ticks_) {
+        return false;
+    }
+    deadline_ticks_ = ticks;
+    return true;
+}
+
+void Task::set_task_class(TaskClassId task_class) {
+    task_class_ = task_class;
+}
+
+TaskClassId Task::task_class() const {
+    return task_class_;
+}
+
+void Task::set_task_type(TaskTypeId task_type) {
+    task_type_ = task_type;
+}
+
+TaskTypeId Task::task_type() const {
+    return task_type_;
+}
+
+void Task::set_lane(LaneId lane) {
+    lane_ = lane;
+}
+
+LaneId Task::lane() const {
+    return lane_;
+}
+
+void Task::set_runtime_estimate_ms(double estimate_ms) {
+    runtime_estimate_ms_ = static_cast<float>(estimate_ms);
+    critical_path_ms_ = runtime_estimate_ms_;
+}
+
+double Task::runtime_estimate_ms() const {
+    return runtime_estimate_ms_;
+}
+
+double Task::critical_path_ms() const {
+    return critical_path_ms_;
+}
+
+bool Task::extend_critical_path(double downstream_ms) {
+    float path = static_cast<float>(runtime_estimate_ms_ + downstream_ms);
+    if (path <= critical_path_ms_) {
+        return false;
+    }
+    critical_path_ms_ = path;
+    return true;
 }
 
 void Task::cancel() {
@@ -50,4 +142,16 @@ bool Task::is_cancelled() const {
     return cancelled_.load(std::memory_order_relaxed);
 }
 
+void Task::set_payload_bytes(size_t bytes) {
+    payload_bytes_ = static_cast<uint32_t>(std::min<size_t>(bytes, std::numeric_limits<uint32_t>::max()));
+}
+
+size_t Task::payload_bytes() const {
+    return payload_bytes_;
+}
+
+size_t Task::footprint_bytes() const {
+    return sizeof(Task) + dependencies_.heap_bytes() + payload_bytes_;
+}
+
 } // namespace taskscheduler
@@ -0,0 +1,73 @@
+#include "taskscheduler/task_id_list.hpp"
+#include <algorithm>
+
+namespace taskscheduler {
+
+TaskIdList::TaskIdList(const std::vector<TaskId>& ids) {
+    assign(ids.data(), ids.size());
+}
+
+TaskIdList::TaskIdList(std::initializer_list<TaskId> ids) {
+    assign(ids.begin(), ids.size());
+}
+
+TaskIdList::~TaskIdList() {
+    release();
+}
+
+TaskIdList::TaskIdList(const TaskIdList& other) {
+    assign(other.data(), other.size_);
+}
+
+TaskIdList& TaskIdList::operator=(const TaskIdList& other) {
+    if (this != &other) {
+        release();
+        assign(other.data(), other.size_);
+    }
+    return *this;
+}
+
+TaskIdList::TaskIdList(TaskIdList&& other) noexcept {
+    steal(other);
+}
+
+TaskIdList& TaskIdList::operator=(TaskIdList&& other) noexcept {
+    if (this != &other) {
+        release();
+        steal(other);
+    }
+    return *this;
+}
+
+size_t TaskIdList::heap_bytes() const {
+    return is_inline() ? 0 : size_ * sizeof(TaskId);
+}
+
+void TaskIdList::assign(const TaskId* ids, size_t count) {
+    size_ = static_cast<uint32_t>(count);
+    if (is_inline()) {
+        std::copy(ids, ids + count, inline_);
+    } else {
+        heap_ = new TaskId[count];
+        std::copy(ids, ids + count, heap_);
+    }
+}
+
+void TaskIdList::steal(TaskIdList& other) {
+    size_ = other.size_;
+    if (is_inline()) {
+        std::copy(other.inline_, other.inline_ + size_, inline_);
+    } else {
+        heap_ = other.heap_;
+    }
+    other.size_ = 0;
+}
+
+void TaskIdList::release() {
+    if (!is_inline()) {
+        delete[] heap_;
+    }
+    size_ = 0;
+}
+
+} // namespace taskscheduler
@@ -1,80 +1,268 @@
 #include "taskscheduler/task_queue.hpp"
-#include <queue>
 #include <vector>
 
 namespace taskscheduler {
 
 void TaskQueue::push(std::unique_ptr<Task> task) {
     {
-        std::lock_guard<std::mutex> lock(mutex_);
+        std::lock_guard<SchedulerMutex> lock(mutex_);
         if (closed_) {
             return;
         }
-        queue_.emplace(std::move(task), sequence_counter_++);
+        push_locked(std::move(task));
     }
     cv_.notify_one();
 }
 
+bool TaskQueue::try_push(std::unique_ptr<Task>& task) {
+    {
+        std::lock_guard<SchedulerMutex> lock(mutex_);
+        if (closed_) {
+            return false;
+        }
+        push_locked(std::move(task));
+    }
+    cv_.notify_one();
+    return true;
+}
+
 std::unique_ptr<Task> TaskQueue::pop() {
-    std::unique_lock<std::mutex> lock(mutex_);
-    cv_.wait(lock, [this] { return !queue_.empty() || closed_; });
+    std::unique_lock<SchedulerMutex> lock(mutex_);
+    cv_.wait(lock, [this] { return !heap_.empty() || closed_; });
 
-    if (queue_.empty()) {
+    if (heap_.empty()) {
         return nullptr;
     }
+    return remove_locked(0);
+}
 
-    auto task = std::move(queue_.top().task);
-    queue_.pop();
-    return task;
+std::unique_ptr<Task> TaskQueue::pop_for(std::chrono::milliseconds timeout) {
+    std::unique_lock<SchedulerMutex> lock(mutex_);
+    if (!cv_.wait_for(lock, timeout, [this] { return !heap_.empty() || closed_; }) ||
+        heap_.empty()) {
+        return nullptr;
+    }
+    return remove_locked(0);
 }
 
 size_t TaskQueue::size() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return queue_.size();
+    return size_.load(std::memory_order_relaxed);
 }
 
 bool TaskQueue::empty() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return queue_.empty();
+    return size_.load(std::memory_order_relaxed) == 0;
+}
+
+bool TaskQueue::has_work_ahead_of(const Task& task) const {
+    if (empty()) {
+        return false;
+    }
+    std::lock_guard<SchedulerMutex> lock(mutex_);
+    return !heap_.empty() && precedes(heap_.front().key, Key(task));
 }
 
 void TaskQueue::close() {
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        closed_ = true;
+        std::lock_guard<SchedulerMutex> lock(mutex_);
+        closed_.store(true, std::memory_order_release);
     }
     cv_.notify_all();
 }
 
 bool TaskQueue::is_closed() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return closed_;
+    return closed_.load(std::memory_order_acquire);
+}
+
+std::vector<std::unique_ptr<Task>> TaskQueue::close_and_drain() {
+    std::vector<std::unique_ptr<Task>> drained;
+    {
+        std::lock_guard<SchedulerMutex> lock(mutex_);
+        closed_.store(true, std::memory_order_release);
+        drained.reserve(heap_.size());
+        while (!heap_.empty()) {
+            drained.push_back(remove_locked(0));
+        }
+    }
+    cv_.notify_all();
+    return drained;
 }
 
 bool TaskQueue::cancel_task(TaskId id) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<SchedulerMutex> lock(mutex_);
+    size_t position = find_locked(id);
+    if (position == heap_.size()) {
+        return false;
+    }
 
-    // Extract all tasks from the priority queue to search for the target
-    std::vector<TaskWrapper> temp_tasks;
-    bool found = false;
+    // Left in place and skipped by the worker that dequeues it
+    heap_[position].task->cancel();
+    return true;
+}
 
-    while (!queue_.empty()) {
-        auto wrapper = std::move(const_cast<TaskWrapper&>(queue_.top()));
-        queue_.pop();
+bool TaskQueue::update_task(TaskId id, std::optional<Priority> priority,
+                            std::optional<Task::TimePoint> deadline) {
+    std::lock_guard<SchedulerMutex> lock(mutex_);
+    size_t position = find_locked(id);
+    if (position == heap_.size()) {
+        return false;
+    }
+
+    Task& task = *heap_[position].task;
+    if (priority.has_value()) {
+        task.set_priority(priority.value());
+    }
+    if (deadline.has_value()) {
+        task.set_deadline(deadline.value());
+    }
+    heap_[position].key = Key(task);
+    rekey_locked(position);
+    return true;
+}
 
-        if (wrapper.task->id() == id) {
-            wrapper.task->cancel();
-            found = true;
+size_t TaskQueue::inherit(const std::unordered_map<TaskId, double>& downstream_ms,
+                          Priority priority, std::optional<Task::TimePoint> deadline) {
+    std::lock_guard<SchedulerMutex> lock(mutex_);
+
+    size_t boosted = 0;
+    for (const auto& [id, downstream] : downstream_ms) {
+        size_t position = find_locked(id);
+        if (position == heap_.size()) {
+            continue;  // Running, done, or in another lane
+        }
+
+        Task& task = *heap_[position].task;
+        bool changed = task.inherit_priority(priority);
+        if (deadline.has_value()) {
+            changed = task.inherit_deadline(deadline.value()) || changed;
+        }
+        if (changed) {
+            ++boosted;
         }
-        temp_tasks.push_back(std::move(wrapper));
+        task.extend_critical_path(downstream);
+
+        // Inheritance only makes a task more urgent
+        heap_[position].key = Key(task);
+        sift_up(position);
     }
 
-    // Restore all tasks back to the queue
-    for (auto& wrapper : temp_tasks) {
-        queue_.push(std::move(wrapper));
+    return boosted;
+}
+
+std::unique_ptr<Task> TaskQueue::shed_lowest(Priority priority) {
+    std::lock_guard<SchedulerMutex> lock(mutex_);
+
+    // Lowest priority first; the most recently queued among equals
+    size_t victim = heap_.size();
+    for (size_t i = 0; i < heap_.size(); ++i) {
+        Priority candidate = heap_[i].key.priority;
+        if (candidate >= priority) {
+            continue;
+        }
+        if (victim == heap_.size() ||
+            candidate < heap_[victim].key.priority ||
+            (candidate == heap_[victim].key.priority &&
+             heap_[i].sequence > heap_[victim].sequence)) {
+            victim = i;
+        }
+    }
+
+    if (victim == heap_.size()) {
+        return nullptr;
+    }
+    return remove_locked(victim);
+}
+
+void TaskQueue::push_locked(std::unique_ptr<Task> task) {
+    uint32_t slot = NO_SLOT;
+    if (task->id() != INVALID_TASK_ID) {
+        if (free_slots_.empty()) {
+            slot = static_cast<uint32_t>(slot_positions_.size());
+            slot_positions_.push_back(0);
+        } else {
+            slot = free_slots_.back();
+            free_slots_.pop_back();
+        }
+        slots_.erase(task->id());  // A re-queued id points at its newest entry
+        slots_.insert(task->id(), slot);
+    }
+    heap_.emplace_back(std::move(task), sequence_counter_++, slot);
+    place(heap_.size() - 1);
+    sift_up(heap_.size() - 1);
+    size_.store(heap_.size(), std::memory_order_relaxed);
+}
+
+size_t TaskQueue::find_locked(TaskId id) const {
+    uint32_t slot = slots_.find(id);
+    return slot != NO_SLOT ? slot_positions_[slot] : heap_.size();
+}
+
+std::unique_ptr<Task> TaskQueue::remove_locked(size_t position) {
+    std::unique_ptr<Task> task = std::move(heap_[position].task);
+    uint32_t slot = heap_[position].slot;
+    if (slot != NO_SLOT) {
+        if (slots_.find(task->id()) == slot) {
+            slots_.erase(task->id());
+        }
+        free_slots_.push_back(slot);
+    }
+
+    size_t last = heap_.size() - 1;
+    if (position != last) {
+        heap_[position] = std::move(heap_[last]);
+        place(position);
     }
+    heap_.pop_back();
+    if (position < heap_.size()) {
+        rekey_locked(position);
+    }
+    size_.store(heap_.size(), std::memory_order_relaxed);
+    return task;
+}
+
+void TaskQueue::rekey_locked(size_t position) {
+    sift_down(sift_up(position));
+}
+
+size_t TaskQueue::sift_up(size_t position) {
+    while (position > 0) {
+        size_t parent = (position - 1) / 2;
+        if (!(heap_[parent] < heap_[position])) {
+            break;
+        }
+        std::swap(heap_[parent], heap_[position]);
+        place(parent);
+        place(position);
+        position = parent;
+    }
+    return position;
+}
 
-    return found;
+void TaskQueue::sift_down(size_t position) {
+    for (;;) {
+        size_t first = position;
+        size_t left = 2 * position + 1;
+        size_t right = left + 1;
+        if (left < heap_.size() && heap_[first] < heap_[left]) {
+            first = left;
+        }
+        if (right < heap_.size() && heap_[first] < heap_[right]) {
+            first = right;
+        }
+        if (first == position) {
+            return;
+        }
+        std::swap(heap_[first], heap_[position]);
+        place(first);
+        place(position);
+        position = first;
+    }
+}
+
+void TaskQueue::place(size_t position) {
+    uint32_t slot = heap_[position].slot;
+    if (slot != NO_SLOT) {
+        slot_positions_[slot] = position;
+    }
 }
 
 } // namespace taskscheduler
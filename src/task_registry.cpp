@@ -0,0 +1,43 @@
+#include "taskscheduler/task_registry.hpp"
+
+namespace taskscheduler {
+
+bool TaskRegistry::register_type(TaskTypeId type, Handler handler) {
+    if (type == UNREGISTERED_TASK_TYPE || !handler) {
+        return false;
+    }
+    return handlers_.emplace(type, std::make_shared<const Handler>(std::move(handler))).second;
+}
+
+bool TaskRegistry::contains(TaskTypeId type) const {
+    return handlers_.count(type) > 0;
+}
+
+bool TaskRegistry::invoke(TaskTypeId type, std::string_view arguments) const {
+    auto it = handlers_.find(type);
+    if (it == handlers_.end()) {
+        return false;
+    }
+    (*it->second)(arguments);
+    return true;
+}
+
+std::unique_ptr<Task> TaskRegistry::create(const TaskSpec& spec) const {
+    auto it = handlers_.find(spec.type);
+    if (it == handlers_.end()) {
+        return nullptr;
+    }
+
+    auto task = std::make_unique<Task>(
+        [handler = it->second, arguments = spec.arguments]() { (*handler)(arguments); },
+        spec.priority, spec.dependencies);
+    task->set_task_type(spec.type);
+    task->set_task_class(spec.task_class);
+    task->set_payload_bytes(spec.arguments.capacity());
+    if (spec.deadline.has_value()) {
+        task->set_deadline(spec.deadline.value());
+    }
+    return task;
+}
+
+} // namespace taskscheduler
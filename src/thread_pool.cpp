@@ -1,10 +1,86 @@
 #include "taskscheduler/thread_pool.hpp"
+#include <algorithm>
 #include <chrono>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace taskscheduler {
 
-ThreadPool::ThreadPool(size_t num_threads) : num_threads_(num_threads) {
-    threads_.reserve(num_threads_);
+namespace {
+
+// Pool whose worker (regular or compensating) is the current thread
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local bool in_blocking_region = false;
+
+// Counters of the current worker, if its pool reads them
+thread_local PerfCounters* current_counters = nullptr;
+
+// Where the current worker publishes what it is running
+thread_local WorkerActivity* current_activity = nullptr;
+
+// How often an idle compensating worker checks whether it can retire
+constexpr std::chrono::milliseconds COMPENSATOR_IDLE_POLL{10};
+
+// Lane ids must fit in Task's LaneId
+constexpr size_t MAX_LANES = static_cast<size_t>(std::numeric_limits<LaneId>::max()) + 1;
+
+// Readies tasks a shutdown hands back for another pool: edges to tasks
+// outside the set finished here and are dropped, and prerequisites are
+// moved ahead of their dependents.
+void order_for_resubmit(std::vector<std::unique_ptr<Task>>& tasks) {
+    std::unordered_map<TaskId, size_t> index;
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        index.emplace(tasks[i]->id(), i);
+    }
+
+    std::vector<size_t> waiting(tasks.size(), 0);
+    std::vector<std::vector<size_t>> dependents(tasks.size());
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        std::vector<TaskId> kept;
+        for (TaskId dep_id : tasks[i]->dependency_list()) {
+            auto it = index.find(dep_id);
+            if (it != index.end()) {
+                kept.push_back(dep_id);
+                dependents[it->second].push_back(i);
+                ++waiting[i];
+            }
+        }
+        if (kept.size() != tasks[i]->dependency_list().size()) {
+            tasks[i]->set_dependencies(kept);
+        }
+    }
+
+    std::vector<size_t> order;
+    order.reserve(tasks.size());
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        if (waiting[i] == 0) {
+            order.push_back(i);
+        }
+    }
+    for (size_t next = 0; next < order.size(); ++next) {
+        for (size_t dependent : dependents[order[next]]) {
+            if (--waiting[dependent] == 0) {
+                order.push_back(dependent);
+            }
+        }
+    }
+
+    std::vector<std::unique_ptr<Task>> ordered;
+    ordered.reserve(tasks.size());
+    for (size_t i : order) {
+        ordered.push_back(std::move(tasks[i]));
+    }
+    tasks = std::move(ordered);
+}
+
+} // namespace
+
+thread_local ThreadPool::Lane* ThreadPool::current_lane_ = nullptr;
+
+ThreadPool::ThreadPool(size_t num_threads)
+    : num_threads_(num_threads), max_compensating_workers_(num_threads) {
+    lanes_.push_back(std::make_unique<Lane>("default", num_threads_));
 }
 
 ThreadPool::~ThreadPool() {
@@ -17,13 +93,56 @@ void ThreadPool::start() {
     }
 
     running_ = true;
-    for (size_t i = 0; i < num_threads_; ++i) {
-        threads_.emplace_back(&ThreadPool::worker_loop, this);
+    for (auto& lane : lanes_) {
+        lane->threads.reserve(lane->num_threads);
+        for (size_t i = 0; i < lane->num_threads; ++i) {
+            lane->threads.emplace_back(&ThreadPool::worker_loop, this, lane.get(), i);
+        }
+    }
+
+    if (watchdog_) {
+        watchdog_->start([this] { return get_worker_states(); },
+                         [this](const WatchdogEvent& event) { on_watchdog_event(event); });
+    }
+}
+
+bool ThreadPool::add_lane(const std::string& name, size_t num_threads) {
+    if (running_ || num_threads == 0 || lanes_.size() >= MAX_LANES || lane_index(name).has_value()) {
+        return false;
     }
+    lanes_.push_back(std::make_unique<Lane>(name, num_threads));
+    return true;
+}
+
+bool ThreadPool::route_class(TaskClassId task_class, const std::string& lane) {
+    auto index = lane_index(lane);
+    if (!index.has_value() || running_) {
+        return false;
+    }
+    class_lanes_[task_class] = index.value();
+    return true;
+}
+
+std::vector<std::string> ThreadPool::lane_names() const {
+    std::vector<std::string> names;
+    names.reserve(lanes_.size());
+    for (const auto& lane : lanes_) {
+        names.push_back(lane->name);
+    }
+    return names;
+}
+
+std::optional<LaneId> ThreadPool::lane_index(const std::string& name) const {
+    for (size_t i = 0; i < lanes_.size(); ++i) {
+        if (lanes_[i]->name == name) {
+            return static_cast<LaneId>(i);
+        }
+    }
+    return std::nullopt;
 }
 
 void ThreadPool::stop() {
-    shutdown_immediate();
+    shutdown_graceful();
 }
 
 void ThreadPool::shutdown_graceful() {
@@ -31,84 +150,464 @@ void ThreadPool::shutdown_graceful() {
         return;
     }
 
-    running_ = false;
-    task_queue_.close();
+    auto start_time = std::chrono::steady_clock::now();
+    flush_batches();
+    shutting_down_ = true;
+    wait_for_drain(std::nullopt);
 
-    for (auto& thread : threads_) {
-        if (thread.joinable()) {
-            thread.join();
-        }
+    // Whatever is left waits on dependencies that can no longer finish
+    stop_workers(false);
+    record_shutdown(start_time);
+}
+
+std::vector<std::unique_ptr<Task>> ThreadPool::shutdown_graceful(std::chrono::milliseconds drain_timeout) {
+    if (!running_) {
+        return {};
     }
 
-    threads_.clear();
+    auto start_time = std::chrono::steady_clock::now();
+    flush_batches();
+    shutting_down_ = true;
+    bool drained = wait_for_drain(start_time + drain_timeout);
+
+    auto unrun = stop_workers(!drained);
+    record_shutdown(start_time);
+    return unrun;
 }
 
-void ThreadPool::shutdown_immediate() {
+std::vector<std::unique_ptr<Task>> ThreadPool::shutdown_immediate() {
     if (!running_) {
-        return;
+        return {};
     }
 
+    auto start_time = std::chrono::steady_clock::now();
+    shutting_down_ = true;
+
+    auto unrun = stop_workers(true);
+    record_shutdown(start_time);
+    return unrun;
+}
+
+bool ThreadPool::wait_for_drain(std::optional<std::chrono::steady_clock::time_point> deadline) {
+    // Drained once every outstanding task is a dependent that nothing
+    // running or queued can release any more, or waits on a descriptor.
+    // Timers fire on their own, so their tasks are waited for.
+    auto drained = [this] {
+        return admission_.pending_tasks() ==
+               dependency_tracker_.pending_count() + reactor_.pending_io_count();
+    };
+
+    std::unique_lock<std::mutex> lock(drain_mutex_);
+    if (deadline.has_value()) {
+        return drain_cv_.wait_until(lock, deadline.value(), drained);
+    }
+    drain_cv_.wait(lock, drained);
+    return true;
+}
+
+bool ThreadPool::wait_idle() {
+    return wait_idle_until(std::nullopt);
+}
+
+bool ThreadPool::wait_idle(std::chrono::milliseconds timeout) {
+    return wait_idle_until(std::chrono::steady_clock::now() + timeout);
+}
+
+bool ThreadPool::wait_idle_until(std::optional<std::chrono::steady_clock::time_point> deadline) {
+    if (current_pool == this) {
+        return false;
+    }
+
+    // Registered before checking, so the release that empties the pool
+    // either sees this waiter or is seen by the check.
+    idle_waiters_.fetch_add(1);
+    auto idle = [this] { return admission_.pending_tasks() == 0; };
+    bool done = true;
+    {
+        std::unique_lock<std::mutex> lock(idle_mutex_);
+        if (deadline.has_value()) {
+            done = idle_cv_.wait_until(lock, deadline.value(), idle);
+        } else {
+            idle_cv_.wait(lock, idle);
+        }
+    }
+    idle_waiters_.fetch_sub(1);
+    return done;
+}
+
+bool ThreadPool::wait_for(TaskId id) {
+    return dependency_tracker_.wait_finished(id);
+}
+
+bool ThreadPool::wait_for(TaskId id, std::chrono::milliseconds timeout) {
+    return dependency_tracker_.wait_finished(id, std::chrono::steady_clock::now() + timeout);
+}
+
+std::vector<std::unique_ptr<Task>> ThreadPool::stop_workers(bool discard_queued) {
+    admission_.close();
+
+    // Tasks still waiting on I/O are handed back; stopping first also means
+    // nothing is dispatched into the queue while it closes.
+    std::vector<std::unique_ptr<Task>> unrun = reactor_.stop();
+    if (discard_queued) {
+        stop_requested_ = true;
+        for (auto& lane : lanes_) {
+            for (auto& task : lane->queue.close_and_drain()) {
+                unrun.push_back(std::move(task));
+            }
+        }
+    }
     running_ = false;
-    task_queue_.close();
+    for (auto& lane : lanes_) {
+        lane->queue.close();
+    }
 
-    for (auto& thread : threads_) {
-        if (thread.joinable()) {
-            thread.join();
+    // Workers finish the task they are running and exit
+    for (auto& lane : lanes_) {
+        for (auto& thread : lane->threads) {
+            if (thread.joinable()) {
+                thread.join();
+            }
         }
+        lane->threads.clear();
+    }
+    join_compensators();
+    if (watchdog_) {
+        watchdog_->stop();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(unrun_mutex_);
+        for (auto& task : unrun_tasks_) {
+            unrun.push_back(std::move(task));
+        }
+        unrun_tasks_.clear();
+    }
+    for (auto& task : dependency_tracker_.drain()) {
+        unrun.push_back(std::move(task));
     }
 
-    threads_.clear();
+    // Hand back only work that was still meant to run; none of it will
+    // run here, so wait_for() callers are let go
+    release_tasks(unrun);
+    for (const auto& task : unrun) {
+        dependency_tracker_.retire(task->id());
+    }
+    unrun.erase(std::remove_if(unrun.begin(), unrun.end(),
+                               [](const std::unique_ptr<Task>& task) { return task->is_cancelled(); }),
+                unrun.end());
+    order_for_resubmit(unrun);
+    return unrun;
+}
+
+std::vector<TaskId> ThreadPool::resubmit(std::vector<std::unique_ptr<Task>> tasks) {
+    std::unordered_map<TaskId, TaskId> new_ids;
+    std::vector<TaskId> ids;
+    ids.reserve(tasks.size());
+    for (auto& task : tasks) {
+        std::vector<TaskId> dependencies;
+        for (TaskId dep_id : task->dependency_list()) {
+            auto it = new_ids.find(dep_id);
+            dependencies.push_back(it != new_ids.end() ? it->second : INVALID_TASK_ID);
+        }
+        task->set_dependencies(dependencies);
+
+        TaskId old_id = task->id();
+        TaskId id = submit_with_id(std::move(task));
+        new_ids.emplace(old_id, id);
+        ids.push_back(id);
+    }
+    return ids;
+}
+
+void ThreadPool::record_shutdown(std::chrono::steady_clock::time_point start_time) {
+    std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start_time;
+    statistics_.record_shutdown(duration.count());
+}
+
+void ThreadPool::enqueue(std::unique_ptr<Task> task) {
+    if (!lanes_[task->lane()]->queue.try_push(task)) {
+        // The queue closed under an immediate shutdown; keep the task so it
+        // can be handed back to the caller.
+        std::lock_guard<std::mutex> lock(unrun_mutex_);
+        unrun_tasks_.push_back(std::move(task));
+    }
 }
 
 void ThreadPool::submit(std::unique_ptr<Task> task) {
-    if (!running_ && !task_queue_.is_closed()) {
-        start();
+    submit_with_id(std::move(task));
+}
+
+TaskId ThreadPool::submit_with_id(std::unique_ptr<Task> task) {
+    return submit_to_lane(std::nullopt, std::move(task));
+}
+
+TaskId ThreadPool::submit_with_id(const std::string& lane, std::unique_ptr<Task> task) {
+    auto index = lane_index(lane);
+    if (!index.has_value()) {
+        return INVALID_TASK_ID;
     }
+    return submit_to_lane(index, std::move(task));
+}
 
-    if (task_queue_.is_closed()) {
-        return;  // Don't accept new tasks after shutdown
+TaskId ThreadPool::submit_to_lane(std::optional<LaneId> lane, std::unique_ptr<Task> task) {
+    TaskId task_id = prepare(task, lane);
+    if (task_id != INVALID_TASK_ID) {
+        dispatch(std::move(task));
     }
+    return task_id;
+}
 
-    TaskId task_id = dependency_tracker_.assign_id(task);
+TaskId ThreadPool::submit_when_ready(int fd, IoInterest interest, std::unique_ptr<Task> task) {
+    TaskId task_id = prepare(task);
+    if (task_id != INVALID_TASK_ID && !reactor_.watch(fd, interest, task)) {
+        dependency_tracker_.retire(task_id);
+        release_task(*task);
+        return INVALID_TASK_ID;
+    }
+    return task_id;
+}
 
-    if (task->dependencies().empty()) {
-        task_queue_.push(std::move(task));
-    } else {
-        dependency_tracker_.add_task(std::move(task));
-        process_ready_tasks();
+TaskId ThreadPool::submit_after(std::chrono::nanoseconds delay, std::unique_ptr<Task> task) {
+    TaskId task_id = prepare(task);
+    if (task_id != INVALID_TASK_ID && !reactor_.watch_timer(delay, task)) {
+        dependency_tracker_.retire(task_id);
+        release_task(*task);
+        return INVALID_TASK_ID;
     }
+    return task_id;
 }
 
-TaskId ThreadPool::submit_with_id(std::unique_ptr<Task> task) {
-    if (!running_) {
+TaskId ThreadPool::submit_registered(const TaskSpec& spec) {
+    const TaskRegistry* registry = task_registry_.load(std::memory_order_acquire);
+    auto task = registry != nullptr ? registry->create(spec) : nullptr;
+    if (!task) {
+        return INVALID_TASK_ID;
+    }
+
+    TaskId task_id = prepare(task);
+    if (task_id == INVALID_TASK_ID) {
+        return INVALID_TASK_ID;
+    }
+
+    if (Journal* journal = journal_.load(std::memory_order_acquire)) {
+        uint64_t offset = journal->append_submit(task_id, spec);
+        if (offset == 0) {
+            dependency_tracker_.retire(task_id);
+            release_task(*task);
+            return INVALID_TASK_ID;
+        }
+        if (journal->options().wait_for_commit) {
+            journal->wait_durable(offset);
+        }
+    }
+
+    dispatch(std::move(task));
+    return task_id;
+}
+
+size_t ThreadPool::attach_journal(Journal& journal) {
+    journal_.store(&journal, std::memory_order_release);
+
+    // Ids of the previous process that were not recovered finished there
+    const auto& entries = journal.recovered();
+    std::vector<TaskId> outstanding;
+    outstanding.reserve(entries.size());
+    for (const auto& entry : entries) {
+        outstanding.push_back(entry.id);
+    }
+    dependency_tracker_.reserve_ids(journal.max_task_id() + 1, outstanding);
+
+    // Rebuild first so dependents of tasks that cannot be rebuilt are left
+    // out too. Recovered entries are in id order and prerequisites have
+    // smaller ids than their dependents.
+    const TaskRegistry* registry = task_registry_.load(std::memory_order_acquire);
+    std::vector<std::unique_ptr<Task>> tasks(entries.size());
+    std::unordered_set<TaskId> skipped;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const auto& dependencies = entries[i].spec.dependencies;
+        bool orphaned = std::any_of(dependencies.begin(), dependencies.end(),
+                                    [&skipped](TaskId dep) { return skipped.count(dep) > 0; });
+        if (registry != nullptr && !orphaned) {
+            tasks[i] = registry->create(entries[i].spec);
+        }
+        if (!tasks[i]) {
+            skipped.insert(entries[i].id);
+        }
+    }
+
+    // Dependents go first so they are tracked before their prerequisites
+    // can run and complete.
+    size_t resubmitted = 0;
+    for (size_t i = entries.size(); i-- > 0; ) {
+        if (tasks[i] && prepare(tasks[i], std::nullopt, entries[i].id) != INVALID_TASK_ID) {
+            dispatch(std::move(tasks[i]));
+            ++resubmitted;
+        }
+    }
+    return resubmitted;
+}
+
+void ThreadPool::set_task_registry(const TaskRegistry* registry) {
+    task_registry_.store(registry, std::memory_order_release);
+}
+
+void ThreadPool::journal_cancel(const Task& task) {
+    if (task.task_type() == UNREGISTERED_TASK_TYPE) {
+        return;
+    }
+    if (Journal* journal = journal_.load(std::memory_order_acquire)) {
+        journal->append_cancel(task.id());
+    }
+}
+
+TaskId ThreadPool::prepare(std::unique_ptr<Task>& task, std::optional<LaneId> lane, TaskId recovered_id) {
+    const TaskQueue& default_queue = lanes_.front()->queue;
+    if (!running_ && !default_queue.is_closed()) {
         start();
     }
 
-    TaskId task_id = dependency_tracker_.assign_id(task);
+    if (shutting_down_ || default_queue.is_closed()) {
+        return INVALID_TASK_ID;  // Don't accept new tasks after shutdown
+    }
 
-    if (task->dependencies().empty()) {
-        task_queue_.push(std::move(task));
-    } else {
-        dependency_tracker_.add_task(std::move(task));
-        process_ready_tasks();
+    if (!admit(*task)) {
+        statistics_.record_task_rejected();
+        return INVALID_TASK_ID;
     }
 
+    if (!lane.has_value()) {
+        auto route = class_lanes_.find(task->task_class());
+        lane = (route != class_lanes_.end()) ? route->second : DEFAULT_LANE;
+    }
+    task->set_lane(lane.value());
+
+    TaskId task_id = recovered_id;
+    if (task_id == INVALID_TASK_ID) {
+        task_id = dependency_tracker_.assign_id(task);
+    } else {
+        task->set_id(task_id);
+    }
+    task->set_runtime_estimate_ms(runtime_estimator_.estimate(task->task_class()));
+    if (TraceRecorder* recorder = trace_recorder_.load(std::memory_order_acquire)) {
+        recorder->record_submit(*task);
+    }
     return task_id;
 }
 
-void ThreadPool::process_ready_tasks() {
-    auto ready = dependency_tracker_.get_ready_tasks();
-    for (auto& task : ready) {
-        task_queue_.push(std::move(task));
+void ThreadPool::dispatch(std::unique_ptr<Task> task) {
+    if (task->dependency_list().empty()) {
+        enqueue(std::move(task));
+    } else {
+        propagate_to_dependencies(*task);
+        if (auto ready = dependency_tracker_.add_task(std::move(task))) {
+            enqueue(std::move(ready));  // Its prerequisites finished already
+        }
+    }
+}
+
+void ThreadPool::propagate_to_dependencies(const Task& task) {
+    if (task.priority() == Priority::LOW && !task.has_deadline() &&
+        task.critical_path_ms() == 0.0) {
+        return;  // Nothing to pass on
+    }
+
+    size_t boosted = 0;
+    auto not_pending = dependency_tracker_.inherit(
+        task.dependency_list(), task.priority(), task.deadline(), task.critical_path_ms(), boosted);
+
+    // Prerequisites that already left the tracker may be waiting in the
+    // queue behind less urgent work.
+    for (auto& lane : lanes_) {
+        boosted += lane->queue.inherit(not_pending, task.priority(), task.deadline());
+    }
+
+    if (boosted > 0) {
+        statistics_.record_priority_inheritance(boosted);
+    }
+}
+
+void ThreadPool::set_admission_limits(const AdmissionLimits& limits) {
+    admission_.set_limits(limits);
+}
+
+AdmissionLimits ThreadPool::admission_limits() const {
+    return admission_.limits();
+}
+
+bool ThreadPool::admit(const Task& task) {
+    size_t bytes = task.footprint_bytes();
+    if (admission_.try_acquire(bytes)) {
+        return true;
+    }
+
+    switch (admission_.limits().overflow_policy) {
+        case OverflowPolicy::BLOCK:
+            return admission_.acquire(bytes);
+
+        case OverflowPolicy::SHED_LOWEST_PRIORITY:
+            while (auto victim = shed_lowest(task.priority())) {
+                statistics_.record_task_shed();
+                victim->cancel();
+                journal_cancel(*victim);
+                release_task(*victim);
+                auto dependents = dependency_tracker_.cancel_dependents(victim->id());
+                release_tasks(dependents);
+
+                if (admission_.try_acquire(bytes)) {
+                    return true;
+                }
+            }
+            return false;
+
+        case OverflowPolicy::REJECT:
+        default:
+            return false;
+    }
+}
+
+void ThreadPool::release_task(const Task& task) {
+    if (admission_.release(task.footprint_bytes()) == 0 && idle_waiters_.load() != 0) {
+        { std::lock_guard<std::mutex> lock(idle_mutex_); }
+        idle_cv_.notify_all();
+    }
+    if (shutting_down_) {
+        // A timer cancelled during a graceful shutdown may be the last
+        // thing it waits for
+        { std::lock_guard<std::mutex> lock(drain_mutex_); }
+        drain_cv_.notify_all();
     }
 }
 
+void ThreadPool::release_tasks(const std::vector<std::unique_ptr<Task>>& tasks) {
+    for (const auto& task : tasks) {
+        release_task(*task);
+    }
+}
+
+std::unique_ptr<Task> ThreadPool::shed_lowest(Priority priority) {
+    for (auto& lane : lanes_) {
+        if (auto victim = lane->queue.shed_lowest(priority)) {
+            return victim;
+        }
+    }
+    return nullptr;
+}
+
 size_t ThreadPool::thread_count() const {
-    return threads_.size();
+    size_t count = 0;
+    for (const auto& lane : lanes_) {
+        count += lane->threads.size();
+    }
+    return count;
 }
 
 size_t ThreadPool::pending_tasks() const {
-    return task_queue_.size();
+    size_t queued = 0;
+    for (const auto& lane : lanes_) {
+        queued += lane->queue.size();
+    }
+    return queued;
 }
 
 bool ThreadPool::is_running() const {
@@ -116,47 +615,535 @@ bool ThreadPool::is_running() const {
 }
 
 StatisticsSnapshot ThreadPool::get_statistics() const {
-    return statistics_.get_snapshot();
+    StatisticsSnapshot snapshot = statistics_.get_snapshot();
+    snapshot.queue_depth = pending_tasks();
+    snapshot.pending_task_count = admission_.pending_tasks();
+    snapshot.pending_task_bytes = admission_.pending_bytes();
+    snapshot.pending_dependencies = dependency_tracker_.pending_count();
+    snapshot.blocked_workers = 0;
+    auto now = std::chrono::steady_clock::now();
+    for (const auto& lane : lanes_) {
+        snapshot.blocked_workers += lane->blocked_workers.load(std::memory_order_relaxed);
+        longest_running(*lane, now, snapshot);
+    }
+    return snapshot;
+}
+
+std::optional<StatisticsSnapshot> ThreadPool::get_lane_statistics(const std::string& name) const {
+    auto index = lane_index(name);
+    if (!index.has_value()) {
+        return std::nullopt;
+    }
+    const Lane* lane = lanes_[index.value()].get();
+    StatisticsSnapshot snapshot = lane->statistics.get_snapshot();
+    snapshot.queue_depth = lane->queue.size();
+    snapshot.blocked_workers = lane->blocked_workers.load(std::memory_order_relaxed);
+    longest_running(*lane, std::chrono::steady_clock::now(), snapshot);
+    return snapshot;
+}
+
+void ThreadPool::longest_running(const Lane& lane, std::chrono::steady_clock::time_point now,
+                                 StatisticsSnapshot& snapshot) const {
+    // Fixed workers only: the compensator list takes a lock
+    for (size_t i = 0; i < lane.num_threads; ++i) {
+        WorkerActivity::Reading reading = lane.workers[i].read();
+        if (reading.task == INVALID_TASK_ID) {
+            continue;
+        }
+        std::chrono::duration<double, std::milli> running = now - reading.started;
+        if (running.count() > snapshot.longest_running_task_ms) {
+            snapshot.longest_running_task_ms = running.count();
+            snapshot.longest_running_task = reading.task;
+        }
+    }
+}
+
+CumulativeStatistics ThreadPool::get_cumulative_statistics() const {
+    return statistics_.get_cumulative();
+}
+
+std::vector<LockStatistics> ThreadPool::get_lock_statistics() const {
+    std::vector<LockStatistics> locks;
+    for (const auto& lane : lanes_) {
+        if (auto statistics = lane->queue.lock_statistics()) {
+            statistics->name = "task_queue/" + lane->name;
+            locks.push_back(std::move(statistics.value()));
+        }
+    }
+    if (auto statistics = dependency_tracker_.lock_statistics()) {
+        statistics->name = "dependency_tracker";
+        locks.push_back(std::move(statistics.value()));
+    }
+    return locks;
 }
 
 void ThreadPool::reset_statistics() {
     statistics_.reset();
+    for (auto& lane : lanes_) {
+        lane->statistics.reset();
+    }
 }
 
 bool ThreadPool::cancel_task(TaskId id) {
-    // Try to cancel in the task queue
-    bool cancelled_in_queue = task_queue_.cancel_task(id);
+    bool cancelled = false;
 
-    // Try to cancel in the dependency tracker
-    bool cancelled_in_tracker = dependency_tracker_.cancel_task(id);
+    // Try to cancel in the lane queues
+    for (auto& lane : lanes_) {
+        if (lane->queue.cancel_task(id)) {
+            // The task itself will be skipped when dequeued; its dependents
+            // would only ever wait on it, so release them now.
+            release_tasks(dependency_tracker_.cancel_dependents(id));
+            cancelled = true;
+            break;
+        }
+    }
+
+    // Try to cancel a task parked on the reactor
+    if (!cancelled) {
+        if (auto parked = reactor_.cancel(id)) {
+            parked->cancel();
+            release_task(*parked);
+            release_tasks(dependency_tracker_.cancel_dependents(id));
+            cancelled = true;
+        }
+    }
 
-    return cancelled_in_queue || cancelled_in_tracker;
+    // Try to cancel in the dependency tracker (cascades to dependents)
+    if (!cancelled) {
+        auto removed = dependency_tracker_.remove_task(id);
+        release_tasks(removed);
+        cancelled = !removed.empty();
+    }
+
+    // Recovery cascades the cancellation to dependents itself
+    if (cancelled) {
+        if (Journal* journal = journal_.load(std::memory_order_acquire)) {
+            journal->append_cancel(id);
+        }
+    }
+    return cancelled;
 }
 
-void ThreadPool::worker_loop() {
-    while (running_ || !task_queue_.is_closed()) {
-        statistics_.set_queue_depth(task_queue_.size());
-        auto task = task_queue_.pop();
-        if (task) {
-            statistics_.increment_active_workers();
+bool ThreadPool::update_priority(TaskId id, Priority priority) {
+    return update_task(id, priority, std::nullopt);
+}
+
+bool ThreadPool::update_deadline(TaskId id, Task::TimePoint deadline) {
+    return update_task(id, std::nullopt, deadline);
+}
+
+bool ThreadPool::update_task(TaskId id, std::optional<Priority> priority,
+                             std::optional<Task::TimePoint> deadline) {
+    // The tracker first: its tasks only ever move on to a queue
+    if (auto propagation = dependency_tracker_.update_task(id, priority, deadline)) {
+        size_t boosted = propagation->boosted;
+        if (!propagation->downstream_ms.empty()) {
+            for (auto& lane : lanes_) {
+                boosted += lane->queue.inherit(propagation->downstream_ms, propagation->priority,
+                                               propagation->deadline);
+            }
+        }
+        if (boosted > 0) {
+            statistics_.record_priority_inheritance(boosted);
+        }
+        return true;
+    }
+
+    for (auto& lane : lanes_) {
+        if (lane->queue.update_task(id, priority, deadline)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::set_trace_recorder(TraceRecorder* recorder) {
+    trace_recorder_.store(recorder, std::memory_order_release);
+}
+
+void ThreadPool::flush_batches() {
+    for (auto& [task_class, collector] : batch_collectors_) {
+        if (auto batch = collector->take(); batch.task) {
+            submit_batch(task_class, std::move(batch));
+        }
+    }
+}
+
+void ThreadPool::submit_batch(TaskClassId task_class, BatchCollector::Taken batch) {
+    // The batch's flush timer, if it has one, has nothing left to do
+    cancel_batch_timer(batch.timer);
+    batch.task->set_task_class(task_class);
+    submit(std::move(batch.task));
+}
+
+void ThreadPool::cancel_batch_timer(TaskId timer_id) {
+    if (auto timer = reactor_.cancel(timer_id)) {
+        timer->cancel();
+        dependency_tracker_.retire(timer->id());
+        release_task(*timer);
+    }
+}
+
+void ThreadPool::schedule_batch_flush(TaskClassId task_class, const std::shared_ptr<BatchCollector>& collector,
+                                      uint64_t generation) {
+    // Runs the batch in place if it is still open when the flush task runs
+    auto flush = std::make_unique<Task>([collector, generation]() {
+        if (auto batch = collector->take(generation); batch.task) {
+            batch.task->execute();
+        }
+    }, collector->options().priority);
+    flush->set_task_class(task_class);
+
+    auto delay = collector->options().max_delay;
+    if (delay.count() > 0) {
+        TaskId timer = submit_after(delay, std::move(flush));
+        if (timer != INVALID_TASK_ID) {
+            if (!collector->set_timer(generation, timer)) {
+                cancel_batch_timer(timer);  // The batch filled in the meantime
+            }
+            return;
+        }
+    } else if (submit_with_id(std::move(flush)) != INVALID_TASK_ID) {
+        return;
+    }
+
+    // Nothing would ever flush the batch: run it here rather than leave its
+    // callers waiting
+    if (auto batch = collector->take(generation); batch.task) {
+        batch.task->execute();
+    }
+}
+
+void ThreadPool::set_result_cache_limits(const ResultCacheLimits& limits) {
+    result_cache_->set_limits(limits);
+}
+
+ResultCacheLimits ThreadPool::result_cache_limits() const {
+    return result_cache_->limits();
+}
+
+void ThreadPool::clear_result_cache() {
+    result_cache_->clear();
+}
+
+void ThreadPool::set_inline_continuations(bool enabled) {
+    inline_continuations_.store(enabled, std::memory_order_relaxed);
+}
+
+bool ThreadPool::inline_continuations() const {
+    return inline_continuations_.load(std::memory_order_relaxed);
+}
+
+bool ThreadPool::set_performance_counters(bool enabled) {
+    if (running_) {
+        return false;
+    }
+    performance_counters_ = enabled;
+    return true;
+}
+
+bool ThreadPool::performance_counters() const {
+    return performance_counters_;
+}
+
+std::vector<TaskClassCounters> ThreadPool::get_task_class_counters() const {
+    return task_class_counters_.snapshot();
+}
+
+std::vector<WorkerState> ThreadPool::get_worker_states() const {
+    std::vector<WorkerState> states;
+    auto now = std::chrono::steady_clock::now();
+    for (const auto& lane : lanes_) {
+        for (size_t i = 0; i < lane->num_threads; ++i) {
+            states.push_back(worker_state(*lane, i, false, lane->workers[i], now));
+        }
+    }
 
-            auto start_time = std::chrono::high_resolution_clock::now();
-            TaskId task_id = task->id();
-            task->execute();
-            auto end_time = std::chrono::high_resolution_clock::now();
+    std::lock_guard<std::mutex> lock(compensator_mutex_);
+    for (const auto& compensator : compensators_) {
+        if (!compensator.finished) {
+            states.push_back(worker_state(*compensator.lane, compensator.worker, true,
+                                          compensator.activity, now));
+        }
+    }
+    return states;
+}
+
+WorkerState ThreadPool::worker_state(const Lane& lane, size_t worker, bool compensating,
+                                     const WorkerActivity& activity,
+                                     std::chrono::steady_clock::time_point now) const {
+    WorkerActivity::Reading reading = activity.read();
+    WorkerState state;
+    state.lane = lane.name;
+    state.worker = worker;
+    state.compensating = compensating;
+    state.task = reading.task;
+    state.task_class = reading.task_class;
+    if (reading.task != INVALID_TASK_ID) {
+        state.running_ms = std::chrono::duration<double, std::milli>(now - reading.started).count();
+    }
+    state.tasks_started = reading.tasks_started;
+    state.blocking = reading.blocking;
+    state.lane_queue_depth = lane.queue.size();
+    return state;
+}
+
+bool ThreadPool::set_watchdog(const WatchdogOptions& options, Watchdog::Callback callback) {
+    if (running_) {
+        return false;
+    }
+    watchdog_ = std::make_unique<Watchdog>(options);
+    watchdog_callback_ = std::move(callback);
+    return true;
+}
+
+void ThreadPool::on_watchdog_event(const WatchdogEvent& event) {
+    if (event.kind == WatchdogEvent::Kind::LONG_RUNNING_TASK) {
+        statistics_.record_long_running_task();
+    } else {
+        statistics_.record_stalled_worker();
+    }
+    if (auto index = lane_index(event.worker.lane)) {
+        Statistics& lane_statistics = lanes_[index.value()]->statistics;
+        if (event.kind == WatchdogEvent::Kind::LONG_RUNNING_TASK) {
+            lane_statistics.record_long_running_task();
+        } else {
+            lane_statistics.record_stalled_worker();
+        }
+    }
+    if (watchdog_callback_) {
+        watchdog_callback_(event);
+    }
+}
+
+void ThreadPool::worker_loop(Lane* lane, size_t worker) {
+    current_pool = this;
+    current_lane_ = lane;
+    current_activity = &lane->workers[worker];
+    std::optional<PerfCounters> counters;
+    if (performance_counters_) {
+        current_counters = &counters.emplace();
+    }
+    TaskQueue& queue = lane->queue;
+    while (running_ || !queue.is_closed()) {
+        run_chain(*lane, queue.pop());
+
+        if (queue.is_closed() && queue.empty()) {
+            break;
+        }
+    }
+    current_counters = nullptr;
+    current_activity = nullptr;
+}
+
+void ThreadPool::run_chain(Lane& lane, std::unique_ptr<Task> task) {
+    while (task) {
+        if (stop_requested_) {
+            enqueue(std::move(task));  // Inline continuation; hand it back
+            break;
+        }
+        task = run_task(lane, std::move(task));
+    }
+
+    if (shutting_down_) {
+        { std::lock_guard<std::mutex> lock(drain_mutex_); }
+        drain_cv_.notify_all();
+    }
+}
+
+ThreadPool::BlockingRegion::BlockingRegion(ThreadPool* pool, Lane* lane)
+    : pool_(pool), lane_(lane), start_time_(std::chrono::steady_clock::now()) {}
+
+ThreadPool::BlockingRegion::~BlockingRegion() {
+    if (pool_ == nullptr) {
+        return;
+    }
+    in_blocking_region = false;
+    if (current_activity) {
+        current_activity->set_blocking(false);
+    }
+    std::chrono::duration<double, std::milli> blocked = std::chrono::steady_clock::now() - start_time_;
+    pool_->leave_blocking_region(*lane_, blocked.count());
+}
+
+ThreadPool::BlockingRegion ThreadPool::blocking_region() {
+    if (current_pool != this || in_blocking_region) {
+        return BlockingRegion(nullptr, nullptr);
+    }
+    in_blocking_region = true;
+    if (current_activity) {
+        current_activity->set_blocking(true);
+    }
+    enter_blocking_region(*current_lane_);
+    return BlockingRegion(this, current_lane_);
+}
+
+void ThreadPool::set_max_compensating_workers(size_t max_workers) {
+    max_compensating_workers_.store(max_workers, std::memory_order_relaxed);
+}
+
+size_t ThreadPool::max_compensating_workers() const {
+    return max_compensating_workers_.load(std::memory_order_relaxed);
+}
 
-            std::chrono::duration<double, std::milli> duration = end_time - start_time;
-            statistics_.record_task_completed(duration.count());
-            statistics_.decrement_active_workers();
+void ThreadPool::enter_blocking_region(Lane& lane) {
+    size_t wanted = std::min(lane.blocked_workers.fetch_add(1) + 1,
+                             max_compensating_workers_.load(std::memory_order_relaxed));
 
-            dependency_tracker_.mark_completed(task_id);
-            process_ready_tasks();
+    size_t live = lane.live_compensators.load();
+    while (live < wanted) {
+        if (!lane.live_compensators.compare_exchange_weak(live, live + 1)) {
+            continue;
         }
 
-        if (task_queue_.is_closed() && task_queue_.empty()) {
+        std::lock_guard<std::mutex> lock(compensator_mutex_);
+        if (lane.queue.is_closed()) {
+            lane.live_compensators.fetch_sub(1);
+            return;
+        }
+
+        // Reap compensators that already retired
+        for (auto it = compensators_.begin(); it != compensators_.end(); ) {
+            if (it->finished) {
+                it->thread.join();
+                it = compensators_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        Compensator& compensator = compensators_.emplace_back();
+        compensator.lane = &lane;
+        compensator.worker = lane.num_threads + lane.compensators_started++;
+        compensator.thread = std::thread(&ThreadPool::compensating_worker_loop, this, &lane, &compensator);
+        statistics_.record_compensating_worker();
+        lane.statistics.record_compensating_worker();
+        return;
+    }
+}
+
+void ThreadPool::leave_blocking_region(Lane& lane, double blocked_time_ms) {
+    lane.blocked_workers.fetch_sub(1);
+    statistics_.record_blocked(blocked_time_ms);
+    lane.statistics.record_blocked(blocked_time_ms);
+}
+
+void ThreadPool::compensating_worker_loop(Lane* lane, Compensator* self) {
+    current_pool = this;
+    current_lane_ = lane;
+    current_activity = &self->activity;
+    std::optional<PerfCounters> counters;
+    if (performance_counters_) {
+        current_counters = &counters.emplace();
+    }
+    while (!retire_compensator(*lane)) {
+        auto task = lane->queue.pop_for(COMPENSATOR_IDLE_POLL);
+        if (task) {
+            run_chain(*lane, std::move(task));
+        } else if (lane->queue.is_closed()) {
+            lane->live_compensators.fetch_sub(1);
             break;
         }
     }
+    current_counters = nullptr;
+    current_activity = nullptr;
+    self->finished = true;
+}
+
+bool ThreadPool::retire_compensator(Lane& lane) {
+    // Retire while more compensators are alive than workers are blocked
+    size_t live = lane.live_compensators.load();
+    while (live > lane.blocked_workers.load()) {
+        if (lane.live_compensators.compare_exchange_weak(live, live - 1)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::join_compensators() {
+    // Joined outside the lock: a compensator finishing a task may still
+    // enter a blocking region, which takes it.
+    std::list<Compensator> compensators;
+    {
+        std::lock_guard<std::mutex> lock(compensator_mutex_);
+        compensators.splice(compensators.end(), compensators_);
+    }
+    for (auto& compensator : compensators) {
+        compensator.thread.join();
+    }
+}
+
+std::unique_ptr<Task> ThreadPool::run_task(Lane& lane, std::unique_ptr<Task> task) {
+    statistics_.increment_active_workers();
+    lane.statistics.increment_active_workers();
+
+    PerfCounters* counters = current_counters;
+    PerfSample counters_before;
+    if (counters) {
+        counters_before = counters->read();
+    }
+    WorkerActivity* activity = current_activity;
+    auto start_time = std::chrono::steady_clock::now();
+    TaskId task_id = task->id();
+    if (activity) {
+        activity->begin(task_id, task->task_class(), start_time);
+    }
+    task->execute();
+    auto end_time = std::chrono::steady_clock::now();
+    if (activity) {
+        activity->end();
+    }
+    if (counters && !task->is_cancelled()) {
+        task_class_counters_.record(task->task_class(), counters->read() - counters_before,
+                                    counters->hardware());
+    }
+
+    std::chrono::duration<double, std::milli> duration = end_time - start_time;
+    statistics_.record_task_completed(duration.count());
+    lane.statistics.record_task_completed(duration.count());
+    if (!task->is_cancelled()) {
+        runtime_estimator_.record(task->task_class(), duration.count());
+        if (TraceRecorder* recorder = trace_recorder_.load(std::memory_order_acquire)) {
+            recorder->record_completion(
+                *task, std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time));
+        }
+        if (task->task_type() != UNREGISTERED_TASK_TYPE) {
+            if (Journal* journal = journal_.load(std::memory_order_acquire)) {
+                journal->append_complete(task_id);
+            }
+        }
+    }
+    lane.statistics.decrement_active_workers();
+    statistics_.decrement_active_workers();
+
+    if (task->is_cancelled()) {
+        // Dependents of a cancelled task are skipped, not run
+        release_tasks(dependency_tracker_.cancel_dependents(task_id));
+        release_task(*task);
+        return nullptr;
+    }
+
+    auto ready = dependency_tracker_.complete(task_id);
+
+    // Released only after its dependents have left the tracker, so the
+    // pool never looks drained while they are in transit.
+    release_task(*task);
+
+    // Fast path: keep a lone continuation on this worker instead of a
+    // round trip through the shared queue and another thread. Only for
+    // continuations that belong to this worker's lane.
+    if (ready.size() == 1 && inline_continuations_.load(std::memory_order_relaxed) &&
+        lanes_[ready.front()->lane()].get() == &lane &&
+        !lane.queue.has_work_ahead_of(*ready.front())) {
+        statistics_.record_inline_continuation();
+        return std::move(ready.front());
+    }
+
+    for (auto& ready_task : ready) {
+        enqueue(std::move(ready_task));
+    }
+    return nullptr;
 }
 
 } // namespace taskscheduler
@@ -0,0 +1,174 @@
+#include "taskscheduler/trace.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+
+namespace taskscheduler {
+
+namespace {
+
+constexpr char TRACE_MAGIC[4] = {'T', 'S', 'T', 'R'};
+constexpr uint32_t TRACE_VERSION = 1;
+constexpr int64_t NO_DEADLINE = std::numeric_limits<int64_t>::max();
+
+// Fixed part of every encoded event; SUBMIT events are followed by
+// `dependency_count` task ids.
+struct EncodedEvent {
+    uint8_t type;
+    uint8_t priority;
+    uint16_t dependency_count;
+    uint32_t task_class;
+    int64_t timestamp_ns;
+    uint64_t task_id;
+    int64_t value_ns;  // Deadline for SUBMIT, duration for COMPLETE
+};
+static_assert(sizeof(EncodedEvent) == 32, "trace events must stay compact");
+
+template<typename T>
+void append(std::vector<uint8_t>& buffer, const T& value) {
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+bool decode(const uint8_t* data, size_t size, std::vector<TraceEvent>& events) {
+    size_t offset = 0;
+    while (offset < size) {
+        EncodedEvent encoded;
+        if (size - offset < sizeof(encoded)) {
+            return false;
+        }
+        std::memcpy(&encoded, data + offset, sizeof(encoded));
+        offset += sizeof(encoded);
+
+        TraceEvent event{};
+        event.type = static_cast<TraceEventType>(encoded.type);
+        event.timestamp_ns = encoded.timestamp_ns;
+        event.task_id = encoded.task_id;
+        event.priority = static_cast<Priority>(encoded.priority);
+        event.task_class = encoded.task_class;
+
+        if (event.type == TraceEventType::SUBMIT) {
+            if (encoded.value_ns != NO_DEADLINE) {
+                event.deadline_ns = encoded.value_ns;
+            }
+            size_t dependency_bytes = encoded.dependency_count * sizeof(TaskId);
+            if (size - offset < dependency_bytes) {
+                return false;
+            }
+            event.dependencies.resize(encoded.dependency_count);
+            std::memcpy(event.dependencies.data(), data + offset, dependency_bytes);
+            offset += dependency_bytes;
+        } else if (event.type == TraceEventType::COMPLETE) {
+            event.duration_ns = encoded.value_ns;
+        } else {
+            return false;
+        }
+        events.push_back(std::move(event));
+    }
+    return true;
+}
+
+} // namespace
+
+TraceRecorder::TraceRecorder() : start_time_(std::chrono::steady_clock::now()) {}
+
+int64_t TraceRecorder::now_ns() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start_time_).count();
+}
+
+void TraceRecorder::record_submit(const Task& task) {
+    auto now = std::chrono::steady_clock::now();
+    const auto& dependencies = task.dependency_list();
+
+    EncodedEvent encoded{};
+    encoded.type = static_cast<uint8_t>(TraceEventType::SUBMIT);
+    encoded.priority = static_cast<uint8_t>(task.base_priority());
+    encoded.dependency_count = static_cast<uint16_t>(
+        std::min<size_t>(dependencies.size(), std::numeric_limits<uint16_t>::max()));
+    encoded.task_class = task.task_class();
+    encoded.timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now - start_time_).count();
+    encoded.task_id = task.id();
+    encoded.value_ns = NO_DEADLINE;
+    if (auto deadline = task.deadline()) {
+        encoded.value_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.value() - now).count();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    append(buffer_, encoded);
+    for (size_t i = 0; i < encoded.dependency_count; ++i) {
+        append(buffer_, dependencies[i]);
+    }
+    ++event_count_;
+}
+
+void TraceRecorder::record_completion(const Task& task, std::chrono::nanoseconds duration) {
+    EncodedEvent encoded{};
+    encoded.type = static_cast<uint8_t>(TraceEventType::COMPLETE);
+    encoded.task_class = task.task_class();
+    encoded.timestamp_ns = now_ns();
+    encoded.task_id = task.id();
+    encoded.value_ns = duration.count();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    append(buffer_, encoded);
+    ++event_count_;
+}
+
+size_t TraceRecorder::event_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return event_count_;
+}
+
+std::vector<TraceEvent> TraceRecorder::events() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<TraceEvent> events;
+    events.reserve(event_count_);
+    decode(buffer_.data(), buffer_.size(), events);
+    return events;
+}
+
+void TraceRecorder::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    buffer_.clear();
+    event_count_ = 0;
+}
+
+bool TraceRecorder::write(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    out.write(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    out.write(reinterpret_cast<const char*>(&TRACE_VERSION), sizeof(TRACE_VERSION));
+    out.write(reinterpret_cast<const char*>(buffer_.data()), static_cast<std::streamsize>(buffer_.size()));
+    return static_cast<bool>(out);
+}
+
+std::optional<std::vector<TraceEvent>> TraceRecorder::read(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return std::nullopt;
+    }
+
+    char magic[sizeof(TRACE_MAGIC)];
+    uint32_t version = 0;
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&version), sizeof(version));
+    if (!in || std::memcmp(magic, TRACE_MAGIC, sizeof(magic)) != 0 || version != TRACE_VERSION) {
+        return std::nullopt;
+    }
+
+    std::vector<uint8_t> data{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    std::vector<TraceEvent> events;
+    if (!decode(data.data(), data.size(), events)) {
+        return std::nullopt;
+    }
+    return events;
+}
+
+} // namespace taskscheduler
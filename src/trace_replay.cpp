@@ -0,0 +1,138 @@
+#include "taskscheduler/trace_replay.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace taskscheduler {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+void spin_for(std::chrono::nanoseconds duration) {
+    auto until = Clock::now() + duration;
+    while (Clock::now() < until) {
+    }
+}
+
+double percentile(const std::vector<double>& sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t rank = static_cast<size_t>(fraction * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+// Shared with the task bodies, which may outlive a replay that timed out
+struct ReplayState {
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t completed = 0;
+    Clock::time_point last_completion;
+    std::vector<Clock::time_point> completed_at;
+};
+
+} // namespace
+
+ReplayReport replay_trace(const std::vector<TraceEvent>& events, ThreadPool& pool,
+                          const ReplayOptions& options) {
+    std::unordered_map<TaskId, int64_t> durations;
+    std::vector<const TraceEvent*> submits;
+    for (const auto& event : events) {
+        if (event.type == TraceEventType::COMPLETE) {
+            durations[event.task_id] = event.duration_ns;
+        } else if (event.type == TraceEventType::SUBMIT) {
+            submits.push_back(&event);
+        }
+    }
+    std::stable_sort(submits.begin(), submits.end(), [](const TraceEvent* a, const TraceEvent* b) {
+        return a->timestamp_ns < b->timestamp_ns;
+    });
+
+    auto state = std::make_shared<ReplayState>();
+    state->completed_at.resize(submits.size());
+    std::vector<Clock::time_point> submitted_at(submits.size());
+    std::unordered_map<TaskId, TaskId> replayed_ids;
+    size_t submitted = 0;
+
+    auto start = Clock::now();
+    int64_t first_timestamp = submits.empty() ? 0 : submits.front()->timestamp_ns;
+
+    for (size_t i = 0; i < submits.size(); ++i) {
+        const TraceEvent& event = *submits[i];
+        if (options.time_scale > 0.0) {
+            auto offset = std::chrono::nanoseconds(static_cast<int64_t>(
+                static_cast<double>(event.timestamp_ns - first_timestamp) * options.time_scale));
+            std::this_thread::sleep_until(start + offset);
+        }
+
+        std::vector<TaskId> dependencies;
+        for (TaskId recorded : event.dependencies) {
+            auto it = replayed_ids.find(recorded);
+            if (it != replayed_ids.end()) {
+                dependencies.push_back(it->second);
+            }
+        }
+
+        auto found = durations.find(event.task_id);
+        std::chrono::nanoseconds duration(found != durations.end() ? found->second : 0);
+        auto task = std::make_unique<Task>([duration, i, state]() {
+            spin_for(duration);
+            auto now = Clock::now();
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->completed_at[i] = now;
+                ++state->completed;
+                state->last_completion = std::max(state->last_completion, now);
+            }
+            state->cv.notify_all();
+        }, event.priority, dependencies);
+        task->set_task_class(event.task_class);
+
+        submitted_at[i] = Clock::now();
+        if (event.deadline_ns.has_value()) {
+            task->set_deadline(submitted_at[i] + std::chrono::nanoseconds(event.deadline_ns.value()));
+        }
+
+        TaskId id = pool.submit_with_id(std::move(task));
+        if (id != INVALID_TASK_ID) {
+            replayed_ids[event.task_id] = id;
+            ++submitted;
+        } else {
+            submitted_at[i] = Clock::time_point{};  // Not replayed
+        }
+    }
+
+    ReplayReport report{};
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->cv.wait_for(lock, options.timeout, [&] { return state->completed >= submitted; });
+
+    report.submitted_tasks = submitted;
+    report.completed_tasks = state->completed;
+    if (state->completed > 0) {
+        std::chrono::duration<double, std::milli> makespan = state->last_completion - start;
+        report.makespan_ms = makespan.count();
+        report.throughput_per_second = report.makespan_ms > 0.0
+            ? static_cast<double>(state->completed) * 1000.0 / report.makespan_ms
+            : 0.0;
+    }
+
+    std::vector<double> latencies;
+    latencies.reserve(state->completed);
+    for (size_t i = 0; i < submits.size(); ++i) {
+        if (submitted_at[i] != Clock::time_point{} && state->completed_at[i] != Clock::time_point{}) {
+            std::chrono::duration<double, std::milli> latency = state->completed_at[i] - submitted_at[i];
+            latencies.push_back(latency.count());
+        }
+    }
+    std::sort(latencies.begin(), latencies.end());
+    report.latency_p50_ms = percentile(latencies, 0.50);
+    report.latency_p90_ms = percentile(latencies, 0.90);
+    report.latency_p99_ms = percentile(latencies, 0.99);
+    report.latency_max_ms = latencies.empty() ? 0.0 : latencies.back();
+    return report;
+}
+
+} // namespace taskscheduler
@@ -0,0 +1,137 @@
+#include "taskscheduler/watchdog.hpp"
+
+namespace taskscheduler {
+
+void WorkerActivity::begin(TaskId task, TaskClassId task_class,
+                           std::chrono::steady_clock::time_point started) {
+    begin_update();
+    task_.store(task, std::memory_order_relaxed);
+    task_class_.store(task_class, std::memory_order_relaxed);
+    started_ns_.store(std::chrono::duration_cast<std::chrono::nanoseconds>(started.time_since_epoch()).count(),
+                      std::memory_order_relaxed);
+    tasks_started_.store(tasks_started_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    end_update();
+}
+
+void WorkerActivity::end() {
+    begin_update();
+    task_.store(INVALID_TASK_ID, std::memory_order_relaxed);
+    end_update();
+}
+
+void WorkerActivity::set_blocking(bool blocking) {
+    begin_update();
+    blocking_.store(blocking, std::memory_order_relaxed);
+    end_update();
+}
+
+WorkerActivity::Reading WorkerActivity::read() const {
+    Reading reading;
+    while (true) {
+        uint64_t before = sequence_.load(std::memory_order_acquire);
+        reading.task = task_.load(std::memory_order_relaxed);
+        reading.task_class = task_class_.load(std::memory_order_relaxed);
+        int64_t started_ns = started_ns_.load(std::memory_order_relaxed);
+        reading.tasks_started = tasks_started_.load(std::memory_order_relaxed);
+        reading.blocking = blocking_.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (before % 2 == 0 && sequence_.load(std::memory_order_relaxed) == before) {
+            reading.started = std::chrono::steady_clock::time_point(std::chrono::nanoseconds(started_ns));
+            return reading;
+        }
+        std::this_thread::yield();
+    }
+}
+
+void WorkerActivity::begin_update() {
+    sequence_.store(sequence_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void WorkerActivity::end_update() {
+    sequence_.store(sequence_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+std::chrono::milliseconds WatchdogOptions::threshold(TaskClassId task_class) const {
+    auto it = class_thresholds.find(task_class);
+    return it != class_thresholds.end() ? it->second : default_threshold;
+}
+
+Watchdog::Watchdog(WatchdogOptions options) : options_(std::move(options)) {}
+
+Watchdog::~Watchdog() {
+    stop();
+}
+
+void Watchdog::start(Sampler sampler, Callback callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (thread_.joinable()) {
+        return;
+    }
+    sampler_ = std::move(sampler);
+    callback_ = std::move(callback);
+    stopping_ = false;
+    thread_ = std::thread(&Watchdog::run, this);
+}
+
+void Watchdog::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+std::vector<WatchdogEvent> Watchdog::check(const std::vector<WorkerState>& workers) {
+    std::vector<WatchdogEvent> events;
+    std::map<std::pair<std::string, size_t>, Reported> reported;
+
+    for (const WorkerState& worker : workers) {
+        if (worker.task == INVALID_TASK_ID) {
+            continue;
+        }
+
+        // Workers that are idle or gone are forgotten
+        auto key = std::make_pair(worker.lane, worker.worker);
+        auto previous = reported_.find(key);
+        Reported& entry = reported[key];
+        if (previous != reported_.end()) {
+            entry = previous->second;
+        }
+
+        std::chrono::duration<double, std::milli> threshold = options_.threshold(worker.task_class);
+        if (threshold.count() > 0 && worker.running_ms >= threshold.count() &&
+            entry.long_running != worker.tasks_started) {
+            entry.long_running = worker.tasks_started;
+            events.push_back(WatchdogEvent{WatchdogEvent::Kind::LONG_RUNNING_TASK, worker});
+        }
+
+        std::chrono::duration<double, std::milli> stall_timeout = options_.stall_timeout;
+        if (stall_timeout.count() > 0 && worker.running_ms >= stall_timeout.count() &&
+            !worker.blocking && worker.lane_queue_depth > 0 && entry.stalled != worker.tasks_started) {
+            entry.stalled = worker.tasks_started;
+            events.push_back(WatchdogEvent{WatchdogEvent::Kind::STALLED_WORKER, worker});
+        }
+    }
+
+    reported_ = std::move(reported);
+    return events;
+}
+
+void Watchdog::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!cv_.wait_for(lock, options_.interval, [this] { return stopping_; })) {
+        lock.unlock();
+        for (const WatchdogEvent& event : check(sampler_())) {
+            if (callback_) {
+                callback_(event);
+            }
+        }
+        lock.lock();
+    }
+}
+
+} // namespace taskscheduler
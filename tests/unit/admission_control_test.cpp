@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+
+#include "taskscheduler/thread_pool.hpp"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace taskscheduler;
+
+TEST(AdmissionControlTest, Issue27_TaskCountLimit) {
+    AdmissionController admission;
+    admission.set_limits({2, 0, OverflowPolicy::REJECT});
+
+    EXPECT_TRUE(admission.try_acquire(100));
+    EXPECT_TRUE(admission.try_acquire(100));
+    EXPECT_FALSE(admission.try_acquire(100));
+    EXPECT_EQ(admission.pending_tasks(), 2);
+    EXPECT_EQ(admission.pending_bytes(), 200);
+
+    admission.release(100);
+    EXPECT_TRUE(admission.try_acquire(100));
+}
+
+TEST(AdmissionControlTest, Issue27_ByteLimit) {
+    AdmissionController admission;
+    admission.set_limits({0, 1000, OverflowPolicy::REJECT});
+
+    // A single oversized task is admitted into an empty controller
+    EXPECT_TRUE(admission.try_acquire(5000));
+    EXPECT_FALSE(admission.try_acquire(10));
+
+    admission.release(5000);
+    EXPECT_TRUE(admission.try_acquire(600));
+    EXPECT_FALSE(admission.try_acquire(600));
+}
+
+TEST(AdmissionControlTest, Issue27_PoolRejectsWhenFull) {
+    ThreadPool pool(1);
+    pool.set_admission_limits({2, 0, OverflowPolicy::REJECT});
+    std::atomic<bool> release{false};
+    std::atomic<int> executed{0};
+
+    auto blocker = [&release, &executed]() {
+        while (!release) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        executed++;
+    };
+
+    EXPECT_NE(pool.submit_with_id(std::make_unique<Task>(blocker)), INVALID_TASK_ID);
+    EXPECT_NE(pool.submit_with_id(std::make_unique<Task>(blocker)), INVALID_TASK_ID);
+    EXPECT_EQ(pool.submit_with_id(std::make_unique<Task>(blocker)), INVALID_TASK_ID);
+
+    auto stats = pool.get_statistics();
+    EXPECT_EQ(stats.pending_task_count, 2);
+    EXPECT_GE(stats.pending_task_bytes, 2 * sizeof(Task));
+    EXPECT_EQ(stats.rejected_tasks, 1);
+
+    release = true;
+    while (pool.get_statistics().pending_task_count > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    pool.shutdown_graceful();
+
+    EXPECT_EQ(executed, 2);
+}
+
+TEST(AdmissionControlTest, Issue27_ShedsLowestPriority) {
+    ThreadPool pool(1);
+    pool.set_admission_limits({3, 0, OverflowPolicy::SHED_LOWEST_PRIORITY});
+    std::atomic<bool> release{false};
+    std::atomic<bool> started{false};
+    std::atomic<int> low_executed{0};
+    std::atomic<int> high_executed{0};
+
+    pool.submit(std::make_unique<Task>([&release, &started]() {
+        started = true;
+        while (!release) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }));
+    while (!started) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    pool.submit(std::make_unique<Task>([&low_executed]() { low_executed++; }, Priority::LOW));
+    pool.submit(std::make_unique<Task>([&high_executed]() { high_executed++; }, Priority::HIGH));
+
+    // Queue holds LOW and HIGH; a CRITICAL submission displaces LOW
+    EXPECT_NE(pool.submit_with_id(std::make_unique<Task>(
+        [&high_executed]() { high_executed++; }, Priority::CRITICAL)), INVALID_TASK_ID);
+
+    // Nothing lower than LOW can be shed
+    EXPECT_EQ(pool.submit_with_id(std::make_unique<Task>([]() {}, Priority::LOW)), INVALID_TASK_ID);
+
+    release = true;
+    while (pool.get_statistics().pending_task_count > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    pool.shutdown_graceful();
+
+    auto stats = pool.get_statistics();
+    EXPECT_EQ(low_executed, 0);
+    EXPECT_EQ(high_executed, 2);
+    EXPECT_EQ(stats.shed_tasks, 1);
+    EXPECT_EQ(stats.rejected_tasks, 1);
+}
+
+TEST(AdmissionControlTest, Issue27_BlockWaitsForCapacity) {
+    ThreadPool pool(1);
+    pool.set_admission_limits({1, 0, OverflowPolicy::BLOCK});
+    std::atomic<int> executed{0};
+
+    pool.submit(std::make_unique<Task>([&executed]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        executed++;
+    }));
+
+    auto start = std::chrono::steady_clock::now();
+    TaskId id = pool.submit_with_id(std::make_unique<Task>([&executed]() { executed++; }));
+    auto waited = std::chrono::steady_clock::now() - start;
+
+    EXPECT_NE(id, INVALID_TASK_ID);
+    EXPECT_GE(waited, std::chrono::milliseconds(15));
+
+    while (pool.get_statistics().pending_task_count > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    pool.shutdown_graceful();
+    EXPECT_EQ(executed, 2);
+}
+
+TEST(AdmissionControlTest, Issue27_BlockedAcquireWaitsForBytes) {
+    AdmissionController admission;
+    admission.set_limits({0, 1000, OverflowPolicy::BLOCK});
+    ASSERT_TRUE(admission.try_acquire(600));
+
+    std::atomic<bool> admitted{false};
+    std::thread waiter([&admission, &admitted] {
+        admitted = admission.acquire(600);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(admitted);
+    EXPECT_EQ(admission.pending_tasks(), 1);
+
+    admission.release(600);
+    waiter.join();
+    EXPECT_TRUE(admitted);
+    EXPECT_EQ(admission.pending_bytes(), 600);
+}
+
+TEST(AdmissionControlTest, Issue27_UnlimitedAdmitsUntilClosed) {
+    AdmissionController admission;
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_TRUE(admission.try_acquire(10));
+    }
+    EXPECT_EQ(admission.pending_bytes(), 1000);
+
+    admission.close();
+    EXPECT_FALSE(admission.try_acquire(10));
+    EXPECT_FALSE(admission.acquire(10));
+    EXPECT_EQ(admission.release(10), 99);
+}
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+
+#include "taskscheduler/basic_thread_pool.hpp"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace taskscheduler;
+
+namespace {
+
+// Occupies the pool's only worker until `release` is set, so the tasks
+// submitted meanwhile are ordered purely by the queue.
+template<typename Pool>
+void block_worker(Pool& pool, std::atomic<bool>& release) {
+    std::atomic<bool> started{false};
+    pool.submit(std::make_unique<Task>([&release, &started]() {
+        started = true;
+        while (!release) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }, Priority::CRITICAL));
+    while (!started) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+} // namespace
+
+TEST(BasicThreadPoolTest, Issue35_FifoIgnoresPriority) {
+    FifoThreadPool pool(1);
+    std::atomic<bool> release{false};
+    std::mutex mutex;
+    std::vector<int> order;
+
+    block_worker(pool, release);
+    for (int i = 0; i < 4; ++i) {
+        Priority priority = (i % 2 == 0) ? Priority::LOW : Priority::CRITICAL;
+        pool.submit(std::make_unique<Task>([i, &mutex, &order]() {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(i);
+        }, priority));
+    }
+    release = true;
+    pool.stop();
+
+    EXPECT_EQ(order, (std::vector<int>{0, 1, 2, 3}));
+    EXPECT_EQ(pool.get_statistics().completed_tasks, 0);  // NoStatistics
+}
+
+TEST(BasicThreadPoolTest, Issue35_EdfOrdersByDeadline) {
+    EdfThreadPool pool(1);
+    std::atomic<bool> release{false};
+    std::mutex mutex;
+    std::vector<int> order;
+    auto now = std::chrono::steady_clock::now();
+
+    block_worker(pool, release);
+    auto record = [&mutex, &order](int value) {
+        return [value, &mutex, &order]() {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(value);
+        };
+    };
+
+    pool.submit(std::make_unique<Task>(record(3), Priority::CRITICAL));
+    auto late = std::make_unique<Task>(record(2), Priority::LOW);
+    late->set_deadline(now + std::chrono::seconds(2));
+    pool.submit(std::move(late));
+    auto early = std::make_unique<Task>(record(1), Priority::LOW);
+    early->set_deadline(now + std::chrono::seconds(1));
+    pool.submit(std::move(early));
+
+    release = true;
+    pool.stop();
+
+    EXPECT_EQ(order, (std::vector<int>{1, 2, 3}));
+    EXPECT_EQ(pool.get_statistics().completed_tasks, 4);
+}
+
+TEST(BasicThreadPoolTest, Issue35_DependenciesAndCounters) {
+    BasicThreadPool<policy::PriorityOrder, policy::WithDependencies, policy::CounterStatistics> pool(2);
+    std::atomic<int> stage{0};
+
+    TaskId first = pool.submit_with_id(std::make_unique<Task>([&stage]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        stage = 1;
+    }));
+    std::atomic<int> seen{-1};
+    pool.submit(std::make_unique<Task>([&stage, &seen]() { seen = stage.load(); },
+                                       Priority::NORMAL, std::vector<TaskId>{first}));
+    pool.stop();
+
+    EXPECT_EQ(seen, 1);
+    auto stats = pool.get_statistics();
+    EXPECT_EQ(stats.completed_tasks, 2);
+    EXPECT_EQ(stats.max_execution_time_ms, 0.0);  // Counters only, no timing
+}
+
+TEST(BasicThreadPoolTest, Issue35_RejectsDependenciesWhenDisabled) {
+    FifoThreadPool pool(1);
+    auto future = pool.submit([]() { return 7; });
+    EXPECT_EQ(future.get(), 7);
+
+    EXPECT_EQ(pool.submit_with_id(std::make_unique<Task>([]() {}, Priority::NORMAL,
+                                                         std::vector<TaskId>{1})),
+              INVALID_TASK_ID);
+    pool.stop();
+    EXPECT_EQ(pool.submit_with_id(std::make_unique<Task>([]() {})), INVALID_TASK_ID);
+}
+
+TEST(BasicThreadPoolTest, Issue49_UnassignedPrerequisiteIsDropped) {
+    EdfThreadPool pool(1);
+    std::atomic<int> ran{0};
+
+    EXPECT_EQ(pool.submit_with_id(std::make_unique<Task>([&ran]() { ran++; }, Priority::NORMAL,
+                                                         std::vector<TaskId>{999999})),
+              INVALID_TASK_ID);
+    EXPECT_EQ(pool.submit_with_id(std::make_unique<Task>([&ran]() { ran++; }, Priority::NORMAL,
+                                                         std::vector<TaskId>{INVALID_TASK_ID})),
+              INVALID_TASK_ID);
+    EXPECT_NE(pool.submit_with_id(std::make_unique<Task>([&ran]() { ran++; })), INVALID_TASK_ID);
+    pool.stop();
+
+    EXPECT_EQ(ran, 1);
+    EXPECT_EQ(pool.get_statistics().pending_dependencies, 0);
+}
@@ -2,6 +2,8 @@
 
 #include "taskscheduler/dependency_tracker.hpp"
 #include <atomic>
+#include <thread>
+#include <vector>
 
 using namespace taskscheduler;
 
@@ -64,3 +66,279 @@ TEST(DependencyTrackerTest, Issue7_MultipleDependenciesResolved) {
     ready = tracker.get_ready_tasks();
     EXPECT_EQ(ready.size(), 1);
 }
+
+TEST(DependencyTrackerTest, Issue26_CancelCascadesToDependents) {
+    DependencyTracker tracker;
+
+    auto task1 = std::make_unique<Task>([]() {});
+    TaskId id1 = tracker.assign_id(task1);
+
+    auto task2 = std::make_unique<Task>([]() {}, Priority::NORMAL, std::vector<TaskId>{id1});
+    TaskId id2 = tracker.assign_id(task2);
+    tracker.add_task(std::move(task2));
+
+    auto task3 = std::make_unique<Task>([]() {}, Priority::NORMAL, std::vector<TaskId>{id2});
+    tracker.assign_id(task3);
+    tracker.add_task(std::move(task3));
+
+    EXPECT_EQ(tracker.pending_count(), 2);
+
+    EXPECT_TRUE(tracker.cancel_task(id2));
+    EXPECT_FALSE(tracker.has_pending_tasks());
+
+    tracker.mark_completed(id1);
+    EXPECT_EQ(tracker.get_ready_tasks().size(), 0);
+}
+
+TEST(DependencyTrackerTest, Issue26_CancelDependentsKeepsUnrelatedTasks) {
+    DependencyTracker tracker;
+
+    auto task1 = std::make_unique<Task>([]() {});
+    TaskId id1 = tracker.assign_id(task1);
+
+    auto task2 = std::make_unique<Task>([]() {});
+    TaskId id2 = tracker.assign_id(task2);
+
+    auto task3 = std::make_unique<Task>([]() {}, Priority::NORMAL, std::vector<TaskId>{id1, id2});
+    tracker.assign_id(task3);
+    tracker.add_task(std::move(task3));
+
+    auto task4 = std::make_unique<Task>([]() {}, Priority::NORMAL, std::vector<TaskId>{id2});
+    tracker.assign_id(task4);
+    tracker.add_task(std::move(task4));
+
+    EXPECT_EQ(tracker.cancel_dependents(id1).size(), 1);
+    EXPECT_EQ(tracker.pending_count(), 1);
+
+    tracker.mark_completed(id2);
+    EXPECT_EQ(tracker.get_ready_tasks().size(), 1);
+}
+
+TEST(DependencyTrackerTest, Issue28_InheritPropagatesTransitively) {
+    DependencyTracker tracker;
+
+    auto task1 = std::make_unique<Task>([]() {}, Priority::LOW);
+    TaskId id1 = tracker.assign_id(task1);
+
+    auto task2 = std::make_unique<Task>([]() {}, Priority::LOW, std::vector<TaskId>{id1});
+    TaskId id2 = tracker.assign_id(task2);
+    tracker.add_task(std::move(task2));
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+    size_t boosted = 0;
+    auto not_pending = tracker.inherit({id2}, Priority::CRITICAL, deadline, 0.0, boosted);
+
+    EXPECT_EQ(boosted, 1);
+    ASSERT_EQ(not_pending.size(), 1);
+    EXPECT_EQ(not_pending.count(id1), 1);
+
+    tracker.mark_completed(id1);
+    auto ready = tracker.get_ready_tasks();
+    ASSERT_EQ(ready.size(), 1);
+    EXPECT_EQ(ready[0]->priority(), Priority::CRITICAL);
+    EXPECT_EQ(ready[0]->deadline(), deadline);
+}
+
+TEST(DependencyTrackerTest, Issue30_CompleteReturnsNewlyReadyDependents) {
+    DependencyTracker tracker;
+
+    auto task1 = std::make_unique<Task>([]() {});
+    TaskId id1 = tracker.assign_id(task1);
+    auto task2 = std::make_unique<Task>([]() {});
+    TaskId id2 = tracker.assign_id(task2);
+
+    auto task3 = std::make_unique<Task>([]() {}, Priority::NORMAL, std::vector<TaskId>{id1});
+    TaskId id3 = tracker.assign_id(task3);
+    tracker.add_task(std::move(task3));
+
+    auto task4 = std::make_unique<Task>([]() {}, Priority::NORMAL, std::vector<TaskId>{id1, id2});
+    tracker.assign_id(task4);
+    tracker.add_task(std::move(task4));
+
+    auto ready = tracker.complete(id1);
+    ASSERT_EQ(ready.size(), 1);
+    EXPECT_EQ(ready[0]->id(), id3);
+
+    ready = tracker.complete(id2);
+    EXPECT_EQ(ready.size(), 1);
+    EXPECT_FALSE(tracker.has_pending_tasks());
+}
+
+TEST(DependencyTrackerTest, Issue46_DependencyOnFinishedTaskIsSatisfied) {
+    DependencyTracker tracker;
+
+    auto task1 = std::make_unique<Task>([]() {});
+    TaskId id1 = tracker.assign_id(task1);
+    auto task2 = std::make_unique<Task>([]() {});
+    TaskId id2 = tracker.assign_id(task2);
+    EXPECT_TRUE(tracker.complete(id1).empty());
+    EXPECT_TRUE(tracker.is_finished(id1));
+    EXPECT_FALSE(tracker.is_finished(id2));
+
+    // Only the unfinished prerequisite is waited for, however often listed
+    auto task3 = std::make_unique<Task>([]() {}, Priority::NORMAL, std::vector<TaskId>{id1, id2, id2});
+    tracker.assign_id(task3);
+    EXPECT_EQ(tracker.add_task(std::move(task3)), nullptr);
+    EXPECT_EQ(tracker.pending_count(), 1);
+    EXPECT_EQ(tracker.complete(id2).size(), 1);
+
+    auto task4 = std::make_unique<Task>([]() {}, Priority::NORMAL, std::vector<TaskId>{id1, id2});
+    tracker.assign_id(task4);
+    EXPECT_NE(tracker.add_task(std::move(task4)), nullptr);
+    EXPECT_EQ(tracker.pending_count(), 0);
+}
+
+TEST(DependencyTrackerTest, Issue46_ReservedIdsCountAsFinishedUnlessOutstanding) {
+    DependencyTracker tracker;
+    tracker.reserve_ids(100, {42});
+    EXPECT_TRUE(tracker.is_finished(41));
+    EXPECT_FALSE(tracker.is_finished(42));
+    EXPECT_TRUE(tracker.is_finished(99));
+    EXPECT_FALSE(tracker.is_finished(100));
+
+    auto task = std::make_unique<Task>([]() {});
+    EXPECT_EQ(tracker.assign_id(task), 100);
+}
+
+TEST(DependencyTrackerTest, Issue46_CompletionSetStaysCompact) {
+    CompletionSet finished;
+    constexpr TaskId IDS = 1000000;
+    constexpr TaskId STRAGGLER = 5000;
+
+    // Finish out of order within windows, leaving one id outstanding
+    for (TaskId base = 1; base <= IDS; base += 64) {
+        for (TaskId offset = 64; offset-- > 0; ) {
+            TaskId id = base + offset;
+            if (id <= IDS && id != STRAGGLER) {
+                finished.insert(id);
+            }
+        }
+    }
+    EXPECT_EQ(finished.watermark(), STRAGGLER);
+    EXPECT_LE(finished.page_count(), 2u);
+    EXPECT_TRUE(finished.contains(1));
+    EXPECT_FALSE(finished.contains(STRAGGLER));
+    EXPECT_TRUE(finished.contains(IDS));
+    EXPECT_FALSE(finished.contains(IDS + 1));
+
+    finished.insert(STRAGGLER);
+    EXPECT_EQ(finished.watermark(), IDS + 1);
+    EXPECT_EQ(finished.page_count(), 1u);
+
+    finished.insert_range(IDS + 1, 50 * IDS);
+    EXPECT_EQ(finished.watermark(), 50 * IDS);
+    EXPECT_LE(finished.page_count(), 1u);
+}
+
+TEST(DependencyTrackerTest, Issue46_CompletionSetConcurrentInserts) {
+    CompletionSet finished;
+    constexpr TaskId IDS = 200000;
+    constexpr TaskId THREADS = 4;
+    constexpr TaskId STRAGGLER = 7;
+
+    // Each thread finishes every THREADS-th id while looking up the others
+    std::vector<std::thread> threads;
+    std::atomic<bool> wrong{false};
+    for (TaskId t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&finished, &wrong, t]() {
+            for (TaskId id = 1 + t; id <= IDS; id += THREADS) {
+                if (id == STRAGGLER) {
+                    continue;
+                }
+                finished.insert(id);
+                if (!finished.contains(id) || finished.contains(STRAGGLER)) {
+                    wrong = true;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_FALSE(wrong);
+    EXPECT_EQ(finished.watermark(), STRAGGLER);
+    EXPECT_TRUE(finished.contains(IDS));
+    EXPECT_FALSE(finished.contains(IDS + 1));
+
+    finished.insert(STRAGGLER);
+    EXPECT_EQ(finished.watermark(), IDS + 1);
+}
+
+TEST(DependencyTrackerTest, Issue49_FanOutSkipsCancelledDependents) {
+    DependencyTracker tracker;
+
+    auto root = std::make_unique<Task>([]() {});
+    TaskId root_id = tracker.assign_id(root);
+
+    constexpr size_t DEPENDENTS = 10000;
+    std::vector<TaskId> dependents;
+    for (size_t i = 0; i < DEPENDENTS; ++i) {
+        auto task = std::make_unique<Task>([]() {}, Priority::NORMAL, std::vector<TaskId>{root_id});
+        dependents.push_back(tracker.assign_id(task));
+        EXPECT_EQ(tracker.add_task(std::move(task)), nullptr);
+    }
+
+    // Every other dependent goes; a grandchild of a cancelled one goes too
+    auto grandchild = std::make_unique<Task>([]() {}, Priority::NORMAL,
+                                             std::vector<TaskId>{dependents[0], dependents[1]});
+    tracker.assign_id(grandchild);
+    EXPECT_EQ(tracker.add_task(std::move(grandchild)), nullptr);
+    size_t removed = 0;
+    for (size_t i = 0; i < DEPENDENTS; i += 2) {
+        removed += tracker.remove_task(dependents[i]).size();
+    }
+    EXPECT_EQ(removed, DEPENDENTS / 2 + 1);
+    EXPECT_EQ(tracker.pending_count(), DEPENDENTS / 2);
+
+    auto ready = tracker.complete(root_id);
+    EXPECT_EQ(ready.size(), DEPENDENTS / 2);
+    for (const auto& task : ready) {
+        EXPECT_EQ(task->id() % 2, dependents[1] % 2);
+    }
+    EXPECT_FALSE(tracker.has_pending_tasks());
+}
+
+TEST(DependencyTrackerTest, Issue49_SlotsAreRecycled) {
+    DependencyTracker tracker;
+
+    for (int round = 0; round < 1000; ++round) {
+        auto first = std::make_unique<Task>([]() {});
+        TaskId first_id = tracker.assign_id(first);
+        auto second = std::make_unique<Task>([]() {}, Priority::NORMAL, std::vector<TaskId>{first_id});
+        TaskId second_id = tracker.assign_id(second);
+        EXPECT_EQ(tracker.add_task(std::move(second)), nullptr);
+
+        auto third = std::make_unique<Task>([]() {}, Priority::NORMAL, std::vector<TaskId>{second_id});
+        tracker.assign_id(third);
+        EXPECT_EQ(tracker.add_task(std::move(third)), nullptr);
+
+        ASSERT_EQ(tracker.complete(first_id).size(), 1u);
+        ASSERT_EQ(tracker.complete(second_id).size(), 1u);
+    }
+    EXPECT_FALSE(tracker.has_pending_tasks());
+    EXPECT_LE(tracker.slot_count(), 4u);
+}
+
+TEST(DependencyTrackerTest, Issue49_UnassignedPrerequisiteIsRejected) {
+    DependencyTracker tracker;
+
+    auto first = std::make_unique<Task>([]() {});
+    TaskId first_id = tracker.assign_id(first);
+
+    // As left by a rejected submit, and an id nobody was given yet
+    for (TaskId bad_id : {INVALID_TASK_ID, first_id + 100}) {
+        auto task = std::make_unique<Task>([]() {}, Priority::NORMAL, std::vector<TaskId>{first_id, bad_id});
+        tracker.assign_id(task);
+        auto rejected = tracker.add_task(std::move(task));
+        ASSERT_NE(rejected, nullptr);
+        EXPECT_TRUE(rejected->is_cancelled());
+    }
+    EXPECT_FALSE(tracker.has_pending_tasks());
+    EXPECT_EQ(tracker.slot_count(), 0u);
+
+    // The index still finds real prerequisites
+    auto second = std::make_unique<Task>([]() {}, Priority::NORMAL, std::vector<TaskId>{first_id});
+    tracker.assign_id(second);
+    EXPECT_EQ(tracker.add_task(std::move(second)), nullptr);
+    EXPECT_EQ(tracker.complete(first_id).size(), 1u);
+}
@@ -0,0 +1,215 @@
+#include <gtest/gtest.h>
+
+#include "taskscheduler/thread_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+using namespace taskscheduler;
+
+namespace {
+
+std::string journal_path(const char* name) {
+    return "/tmp/taskscheduler_journal_" + std::string(name) + "_" + std::to_string(::getpid()) + ".log";
+}
+
+TaskSpec make_spec(TaskTypeId type, std::string arguments, std::vector<TaskId> dependencies = {}) {
+    TaskSpec spec;
+    spec.type = type;
+    spec.arguments = std::move(arguments);
+    spec.dependencies = std::move(dependencies);
+    return spec;
+}
+
+} // namespace
+
+TEST(JournalTest, Issue40_RecoveryKeepsOnlyLiveTasks) {
+    std::string path = journal_path("recovery");
+    {
+        Journal journal;
+        ASSERT_TRUE(journal.open(path));
+        journal.append_submit(1, make_spec(7, "done"));
+        journal.append_submit(2, make_spec(7, "live", {1}));
+        journal.append_submit(3, make_spec(7, "cancelled"));
+        journal.append_submit(4, make_spec(7, "orphan", {3}));
+        journal.append_submit(5, make_spec(7, "waits", {2, 99}));
+        journal.append_complete(1);
+        journal.append_cancel(3);
+        journal.sync();
+        EXPECT_EQ(journal.durable_bytes(), journal.size_bytes());
+        EXPECT_GE(journal.commit_count(), 1);
+    }
+
+    Journal journal;
+    ASSERT_TRUE(journal.open(path));
+    const auto& entries = journal.recovered();
+    ASSERT_EQ(entries.size(), 2);
+    EXPECT_EQ(entries[0].id, 2);
+    EXPECT_EQ(entries[0].spec.arguments, "live");
+    EXPECT_TRUE(entries[0].spec.dependencies.empty());
+    EXPECT_EQ(entries[1].id, 5);
+    EXPECT_EQ(entries[1].spec.dependencies, (std::vector<TaskId>{2}));
+    EXPECT_EQ(journal.max_task_id(), 5);
+    journal.close();
+
+    // The log was compacted, so a second recovery sees the same tasks
+    Journal reopened;
+    ASSERT_TRUE(reopened.open(path));
+    EXPECT_EQ(reopened.recovered().size(), 2);
+    reopened.close();
+    std::remove(path.c_str());
+}
+
+TEST(JournalTest, Issue40_TornTailIsDiscarded) {
+    std::string path = journal_path("torn");
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::hours(1);
+    {
+        Journal journal;
+        ASSERT_TRUE(journal.open(path));
+        TaskSpec spec = make_spec(3, "kept");
+        spec.priority = Priority::HIGH;
+        spec.deadline = deadline;
+        spec.task_class = 12;
+        journal.append_submit(1, spec);
+        journal.append_submit(2, make_spec(3, "also kept"));
+    }
+    {
+        // Half a record, as left by a crash in the middle of an append
+        std::ofstream out(path, std::ios::binary | std::ios::app);
+        uint32_t length = 200;
+        uint32_t crc = 0xDEADBEEF;
+        out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        out.write(reinterpret_cast<const char*>(&crc), sizeof(crc));
+        out.write("partial", 7);
+    }
+
+    Journal journal;
+    ASSERT_TRUE(journal.open(path));
+    const auto& entries = journal.recovered();
+    ASSERT_EQ(entries.size(), 2);
+    EXPECT_EQ(entries[0].spec.arguments, "kept");
+    EXPECT_EQ(entries[0].spec.priority, Priority::HIGH);
+    EXPECT_EQ(entries[0].spec.task_class, 12);
+    ASSERT_TRUE(entries[0].spec.deadline.has_value());
+    EXPECT_LT(std::chrono::abs(entries[0].spec.deadline.value() - deadline), std::chrono::seconds(1));
+    EXPECT_EQ(entries[1].spec.arguments, "also kept");
+    journal.close();
+    std::remove(path.c_str());
+}
+
+TEST(JournalTest, Issue40_PoolResubmitsUnfinishedTasks) {
+    std::string path = journal_path("pool");
+    std::mutex mutex;
+    std::vector<std::string> ran;
+
+    TaskRegistry registry;
+    ASSERT_TRUE(registry.register_type(1, [&](std::string_view arguments) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ran.emplace_back(arguments);
+    }));
+    EXPECT_FALSE(registry.register_type(1, [](std::string_view) {}));
+    EXPECT_FALSE(registry.register_type(UNREGISTERED_TASK_TYPE, [](std::string_view) {}));
+
+    TaskId finished_id;
+    TaskId waiting_id;
+    TaskId dependent_id;
+    {
+        Journal journal;
+        ASSERT_TRUE(journal.open(path));
+        ThreadPool pool(1);
+        pool.set_task_registry(&registry);
+        EXPECT_EQ(pool.attach_journal(journal), 0);
+
+        finished_id = pool.submit_registered(make_spec(1, "first"));
+        ASSERT_NE(finished_id, INVALID_TASK_ID);
+        pool.shutdown_graceful();
+    }
+    ASSERT_EQ(ran, (std::vector<std::string>{"first"}));
+    {
+        // Simulate a crash: the pool stops before these run
+        Journal journal;
+        ASSERT_TRUE(journal.open(path));
+        EXPECT_TRUE(journal.recovered().empty());
+        ThreadPool pool(1);
+        pool.set_task_registry(&registry);
+        pool.attach_journal(journal);
+
+        std::atomic<bool> release{false};
+        pool.submit_with_id(std::make_unique<Task>([&release]() {
+            while (!release) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }));
+        waiting_id = pool.submit_registered(make_spec(1, "second"));
+        dependent_id = pool.submit_registered(make_spec(1, "third", {waiting_id}));
+        EXPECT_GT(waiting_id, finished_id);
+
+        std::thread releaser([&release]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            release = true;
+        });
+        auto unrun = pool.shutdown_immediate();
+        releaser.join();
+        EXPECT_EQ(unrun.size(), 2);
+    }
+    ASSERT_EQ(ran.size(), 1);
+
+    Journal journal;
+    ASSERT_TRUE(journal.open(path));
+    ASSERT_EQ(journal.recovered().size(), 2);
+    ThreadPool pool(2);
+    pool.set_task_registry(&registry);
+    EXPECT_EQ(pool.attach_journal(journal), 2);
+
+    // New ids continue after the recovered ones
+    TaskId next = pool.submit_registered(make_spec(1, "fourth"));
+    EXPECT_GT(next, dependent_id);
+    pool.shutdown_graceful();
+
+    ASSERT_EQ(ran.size(), 4);
+    auto second = std::find(ran.begin(), ran.end(), "second");
+    auto third = std::find(ran.begin(), ran.end(), "third");
+    ASSERT_NE(second, ran.end());
+    ASSERT_NE(third, ran.end());
+    EXPECT_LT(second, third);
+    journal.close();
+
+    Journal drained;
+    ASSERT_TRUE(drained.open(path));
+    EXPECT_TRUE(drained.recovered().empty());
+    drained.close();
+    std::remove(path.c_str());
+}
+
+TEST(JournalTest, Issue40_CancelledTasksAreNotRecovered) {
+    std::string path = journal_path("cancel");
+    TaskRegistry registry;
+    registry.register_type(2, [](std::string_view) {});
+    {
+        Journal journal;
+        ASSERT_TRUE(journal.open(path));
+        ThreadPool pool(1);
+        pool.set_task_registry(&registry);
+        pool.attach_journal(journal);
+
+        TaskId blocker = pool.submit_with_id(std::make_unique<Task>([]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }));
+        TaskId cancelled = pool.submit_registered(make_spec(2, "", {blocker}));
+        pool.submit_registered(make_spec(2, "", {cancelled}));
+        EXPECT_TRUE(pool.cancel_task(cancelled));
+        pool.shutdown_immediate();
+    }
+
+    Journal journal;
+    ASSERT_TRUE(journal.open(path));
+    EXPECT_TRUE(journal.recovered().empty());
+    journal.close();
+    std::remove(path.c_str());
+}
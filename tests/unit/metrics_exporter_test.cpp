@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+
+#include "taskscheduler/metrics_exporter.hpp"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+using namespace taskscheduler;
+
+TEST(MetricsExporterTest, Issue33_RendersCountersGaugesAndHistogram) {
+    ThreadPool pool(2);
+    for (int i = 0; i < 5; ++i) {
+        pool.submit(std::make_unique<Task>([]() {}));
+    }
+    pool.shutdown_graceful();
+
+    MetricsExporter exporter(pool);
+    std::string text = exporter.render();
+
+    EXPECT_NE(text.find("# TYPE taskscheduler_tasks_completed_total counter"), std::string::npos);
+    EXPECT_NE(text.find("taskscheduler_tasks_completed_total 5\n"), std::string::npos);
+    EXPECT_NE(text.find("# TYPE taskscheduler_queue_depth gauge"), std::string::npos);
+    EXPECT_NE(text.find("taskscheduler_pending_dependencies 0\n"), std::string::npos);
+    EXPECT_NE(text.find("# TYPE taskscheduler_task_execution_seconds histogram"), std::string::npos);
+    EXPECT_NE(text.find("taskscheduler_task_execution_seconds_bucket{le=\"+Inf\"} 5\n"), std::string::npos);
+    EXPECT_NE(text.find("taskscheduler_task_execution_seconds_count 5\n"), std::string::npos);
+}
+
+TEST(MetricsExporterTest, Issue33_CountersSurviveStatisticsReset) {
+    ThreadPool pool(1);
+    for (int i = 0; i < 3; ++i) {
+        pool.submit(std::make_unique<Task>([]() {}));
+    }
+    pool.shutdown_graceful();
+    pool.reset_statistics();
+
+    EXPECT_EQ(pool.get_statistics().completed_tasks, 0);
+    EXPECT_EQ(pool.get_cumulative_statistics().completed_tasks, 3);
+
+    MetricsExporter exporter(pool, "sched");
+    EXPECT_NE(exporter.render().find("sched_tasks_completed_total 3\n"), std::string::npos);
+}
+
+TEST(MetricsExporterTest, Issue33_ServesOverHttp) {
+    ThreadPool pool(1);
+    MetricsExporter exporter(pool);
+    ASSERT_TRUE(exporter.start_http_listener(0));
+    ASSERT_NE(exporter.http_port(), 0);
+
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_GE(fd, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(exporter.http_port());
+    ASSERT_EQ(::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+
+    std::string request = "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    ASSERT_EQ(::send(fd, request.data(), request.size(), 0), static_cast<ssize_t>(request.size()));
+
+    std::string response;
+    char buffer[4096];
+    ssize_t n;
+    while ((n = ::recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+        response.append(buffer, static_cast<size_t>(n));
+    }
+    ::close(fd);
+    exporter.stop();
+
+    EXPECT_EQ(response.rfind("HTTP/1.1 200 OK", 0), 0);
+    EXPECT_NE(response.find("taskscheduler_active_workers"), std::string::npos);
+}
+
+TEST(MetricsExporterTest, Issue33_WritesFilePeriodically) {
+    ThreadPool pool(1);
+    MetricsExporter exporter(pool);
+    std::string path = ::testing::TempDir() + "taskscheduler_metrics_test.prom";
+
+    ASSERT_TRUE(exporter.start_file_writer(path, std::chrono::milliseconds(10)));
+    exporter.stop();
+
+    std::ifstream file(path);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    EXPECT_NE(contents.str().find("taskscheduler_tasks_completed_total 0\n"), std::string::npos);
+    std::remove(path.c_str());
+}
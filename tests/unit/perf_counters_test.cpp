@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include "taskscheduler/thread_pool.hpp"
+#include <chrono>
+#include <cmath>
+
+using namespace taskscheduler;
+
+namespace {
+
+// Burns CPU for roughly `duration` of thread time
+void spin_for(std::chrono::milliseconds duration) {
+    auto end = std::chrono::steady_clock::now() + duration;
+    volatile double sink = 0.0;
+    while (std::chrono::steady_clock::now() < end) {
+        for (int i = 0; i < 1000; ++i) {
+            sink = sink + std::sqrt(static_cast<double>(i));
+        }
+    }
+}
+
+} // namespace
+
+TEST(PerfCountersTest, Issue45_SoftwareModeMeasuresCpuTime) {
+    PerfCounters counters(false);
+    EXPECT_FALSE(counters.hardware());
+
+    PerfSample before = counters.read();
+    spin_for(std::chrono::milliseconds(20));
+    PerfSample delta = counters.read() - before;
+
+    EXPECT_GE(delta.cpu_time_ns, 5000000u);
+    EXPECT_EQ(delta.cycles, 0u);
+    EXPECT_EQ(delta.instructions, 0u);
+}
+
+TEST(PerfCountersTest, Issue45_PoolAggregatesByTaskClass) {
+    ThreadPool pool(2);
+    EXPECT_TRUE(pool.set_performance_counters(true));
+    pool.start();
+    EXPECT_FALSE(pool.set_performance_counters(false));
+
+    for (int i = 0; i < 4; ++i) {
+        auto task = std::make_unique<Task>([]() { spin_for(std::chrono::milliseconds(5)); });
+        task->set_task_class(3);
+        pool.submit(std::move(task));
+    }
+    auto other = std::make_unique<Task>([]() {});
+    other->set_task_class(1000);
+    pool.submit(std::move(other));
+    pool.shutdown_graceful();
+
+    auto classes = pool.get_task_class_counters();
+    ASSERT_EQ(classes.size(), 2);
+    EXPECT_EQ(classes[0].task_class, 3);
+    EXPECT_EQ(classes[0].tasks, 4);
+    EXPECT_GE(classes[0].cpu_time_ms, 5.0);
+    if (classes[0].hardware_samples > 0) {
+        EXPECT_GT(classes[0].instructions, 0u);
+        EXPECT_GT(classes[0].cycles, 0u);
+    } else {
+        EXPECT_EQ(classes[0].instructions, 0u);
+    }
+    EXPECT_EQ(classes[1].task_class, 1000);
+    EXPECT_EQ(classes[1].tasks, 1);
+}
+
+TEST(PerfCountersTest, Issue45_DisabledByDefault) {
+    ThreadPool pool(1);
+    EXPECT_FALSE(pool.performance_counters());
+    pool.start();
+    pool.submit([]() {});
+    pool.shutdown_graceful();
+    EXPECT_TRUE(pool.get_task_class_counters().empty());
+}
@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+
+#include "taskscheduler/process_pool.hpp"
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace taskscheduler;
+
+namespace {
+
+constexpr size_t SHARED_SLOTS = 64;
+
+// Memory the test and the worker processes both see
+struct SharedState {
+    std::atomic<int> pids[SHARED_SLOTS];
+    std::atomic<int> first_done;
+    std::atomic<int> second_saw_first;
+    std::atomic<int> runs;
+};
+
+SharedState* map_shared_state() {
+    void* memory = ::mmap(nullptr, sizeof(SharedState), PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    return memory == MAP_FAILED ? nullptr : new (memory) SharedState{};
+}
+
+TaskSpec make_spec(TaskTypeId type, std::string arguments = {}, std::vector<TaskId> dependencies = {}) {
+    TaskSpec spec;
+    spec.type = type;
+    spec.arguments = std::move(arguments);
+    spec.dependencies = std::move(dependencies);
+    return spec;
+}
+
+} // namespace
+
+TEST(ProcessPoolTest, Issue41_RunsTasksInWorkerProcesses) {
+    SharedState* shared = map_shared_state();
+    ASSERT_NE(shared, nullptr);
+
+    TaskRegistry registry;
+    registry.register_type(1, [shared](std::string_view arguments) {
+        size_t slot = std::stoul(std::string(arguments));
+        shared->pids[slot] = static_cast<int>(::getpid());
+    });
+
+    ProcessPoolOptions options;
+    options.num_workers = 3;
+    options.ring_slots = 4;
+    options.arena_bytes = 64;  // Forces the arena to wrap
+    ProcessPool pool(registry, options);
+    ASSERT_TRUE(pool.start());
+    EXPECT_EQ(pool.worker_pids().size(), 3);
+    EXPECT_EQ(pool.submit(make_spec(99)), INVALID_TASK_ID);
+    EXPECT_EQ(pool.submit(make_spec(1, std::string(65, '1'))), INVALID_TASK_ID);
+
+    for (size_t i = 0; i < SHARED_SLOTS; ++i) {
+        EXPECT_NE(pool.submit(make_spec(1, std::to_string(i))), INVALID_TASK_ID);
+    }
+    pool.shutdown();
+
+    for (size_t i = 0; i < SHARED_SLOTS; ++i) {
+        EXPECT_NE(shared->pids[i].load(), 0) << "slot " << i;
+        EXPECT_NE(shared->pids[i].load(), static_cast<int>(::getpid()));
+    }
+    EXPECT_EQ(pool.get_statistics().completed_tasks, SHARED_SLOTS);
+    EXPECT_EQ(pool.get_statistics().pending_task_count, 0);
+    EXPECT_EQ(pool.failed_tasks(), 0);
+    ::munmap(shared, sizeof(SharedState));
+}
+
+TEST(ProcessPoolTest, Issue41_DependenciesHoldAcrossWorkers) {
+    SharedState* shared = map_shared_state();
+    ASSERT_NE(shared, nullptr);
+
+    TaskRegistry registry;
+    registry.register_type(1, [shared](std::string_view) {
+        ::usleep(20000);
+        shared->first_done = 1;
+    });
+    registry.register_type(2, [shared](std::string_view) {
+        shared->second_saw_first = shared->first_done.load();
+    });
+
+    ProcessPoolOptions options;
+    options.num_workers = 4;
+    ProcessPool pool(registry, options);
+    ASSERT_TRUE(pool.start());
+
+    TaskId first = pool.submit(make_spec(1));
+    pool.submit(make_spec(2, {}, {first}));
+    pool.shutdown();
+
+    EXPECT_EQ(shared->second_saw_first.load(), 1);
+    EXPECT_EQ(pool.get_statistics().completed_tasks, 2);
+    ::munmap(shared, sizeof(SharedState));
+}
+
+TEST(ProcessPoolTest, Issue49_UnassignedPrerequisiteIsDropped) {
+    SharedState* shared = map_shared_state();
+    ASSERT_NE(shared, nullptr);
+
+    TaskRegistry registry;
+    registry.register_type(1, [shared](std::string_view) { shared->runs++; });
+
+    ProcessPoolOptions options;
+    options.num_workers = 1;
+    ProcessPool pool(registry, options);
+    ASSERT_TRUE(pool.start());
+
+    EXPECT_EQ(pool.submit(make_spec(1, {}, {999999})), INVALID_TASK_ID);
+    EXPECT_EQ(pool.submit(make_spec(1, {}, {INVALID_TASK_ID})), INVALID_TASK_ID);
+    EXPECT_NE(pool.submit(make_spec(1)), INVALID_TASK_ID);
+    pool.shutdown();
+
+    EXPECT_EQ(shared->runs.load(), 1);
+    EXPECT_EQ(pool.get_statistics().completed_tasks, 1);
+    EXPECT_EQ(pool.get_statistics().pending_task_count, 0);
+    ::munmap(shared, sizeof(SharedState));
+}
+
+TEST(ProcessPoolTest, Issue41_CrashedWorkerIsRestarted) {
+    SharedState* shared = map_shared_state();
+    ASSERT_NE(shared, nullptr);
+
+    TaskRegistry registry;
+    registry.register_type(1, [](std::string_view) { ::_exit(3); });
+    registry.register_type(2, [shared](std::string_view) { shared->runs.fetch_add(1); });
+    registry.register_type(3, [](std::string_view) { throw std::runtime_error("handler failed"); });
+
+    ProcessPoolOptions options;
+    options.num_workers = 1;
+    ProcessPool pool(registry, options);
+    ASSERT_TRUE(pool.start());
+    pid_t original = pool.worker_pids().front();
+
+    TaskId crash = pool.submit(make_spec(1));
+    pool.submit(make_spec(2, {}, {crash}));  // Dropped with its prerequisite
+    TaskId thrown = pool.submit(make_spec(3));
+    pool.submit(make_spec(2, {}, {thrown}));
+    for (int i = 0; i < 5; ++i) {
+        pool.submit(make_spec(2));
+    }
+
+    // Give the crash time to be noticed before checking the new worker
+    while (pool.worker_restarts() == 0) {
+        ::usleep(1000);
+    }
+    EXPECT_NE(pool.worker_pids().front(), original);
+    pool.shutdown();
+
+    EXPECT_EQ(shared->runs.load(), 5);
+    EXPECT_EQ(pool.failed_tasks(), 2);
+    EXPECT_EQ(pool.worker_restarts(), 1);
+    EXPECT_EQ(pool.get_statistics().pending_task_count, 0);
+    ::munmap(shared, sizeof(SharedState));
+}
@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+
+#include "taskscheduler/thread_pool.hpp"
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace taskscheduler;
+
+namespace {
+
+template<typename Predicate>
+bool wait_until(Predicate predicate, std::chrono::milliseconds timeout = std::chrono::seconds(5)) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!predicate()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+} // namespace
+
+TEST(ReactorTest, Issue36_PipeReadDoesNotHoldWorker) {
+    int fds[2];
+    ASSERT_EQ(::pipe(fds), 0);
+
+    ThreadPool pool(1);
+    std::atomic<char> received{0};
+    std::atomic<bool> cpu_done{false};
+
+    TaskId id = pool.submit_when_ready(fds[0], IoInterest::READABLE, std::make_unique<Task>([&]() {
+        char c = 0;
+        if (::read(fds[0], &c, 1) == 1) {
+            received = c;
+        }
+    }));
+    ASSERT_NE(id, INVALID_TASK_ID);
+
+    // The only worker is free while the read waits
+    pool.submit(std::make_unique<Task>([&cpu_done]() { cpu_done = true; }));
+    EXPECT_TRUE(wait_until([&] { return cpu_done.load(); }));
+    EXPECT_EQ(received, 0);
+    EXPECT_EQ(pool.get_statistics().pending_task_count, 1);
+
+    char c = 'x';
+    ASSERT_EQ(::write(fds[1], &c, 1), 1);
+    EXPECT_TRUE(wait_until([&] { return received.load() == 'x'; }));
+
+    pool.shutdown_graceful();
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+TEST(ReactorTest, Issue36_SocketpairWritableAndDependents) {
+    int fds[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+    ThreadPool pool(2);
+    std::atomic<int> stage{0};
+
+    TaskId writer = pool.submit_when_ready(fds[0], IoInterest::WRITABLE, std::make_unique<Task>([&]() {
+        const char message[] = "ping";
+        if (::write(fds[0], message, sizeof(message)) == sizeof(message)) {
+            stage = 1;
+        }
+    }));
+    ASSERT_NE(writer, INVALID_TASK_ID);
+    pool.submit(std::make_unique<Task>([&stage]() {
+        if (stage == 1) {
+            stage = 2;
+        }
+    }, Priority::NORMAL, std::vector<TaskId>{writer}));
+
+    EXPECT_TRUE(wait_until([&] { return stage.load() == 2; }));
+    pool.shutdown_graceful();
+
+    char buffer[8] = {};
+    EXPECT_EQ(::read(fds[1], buffer, sizeof(buffer)), 5);
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+TEST(ReactorTest, Issue36_TimerFiresAfterDelay) {
+    ThreadPool pool(1);
+    std::atomic<bool> fired{false};
+    auto start = std::chrono::steady_clock::now();
+    std::atomic<std::chrono::steady_clock::duration::rep> elapsed{0};
+
+    ASSERT_NE(pool.submit_after(std::chrono::milliseconds(20), std::make_unique<Task>([&]() {
+        elapsed = (std::chrono::steady_clock::now() - start).count();
+        fired = true;
+    })), INVALID_TASK_ID);
+
+    EXPECT_TRUE(wait_until([&] { return fired.load(); }));
+    EXPECT_GE(std::chrono::steady_clock::duration(elapsed.load()), std::chrono::milliseconds(20));
+    pool.shutdown_graceful();
+}
+
+TEST(ReactorTest, Issue36_GracefulShutdownWaitsForTimers) {
+    ThreadPool pool(1);
+    auto ran = std::make_shared<std::promise<void>>();
+    std::future<void> result = ran->get_future();
+
+    ASSERT_NE(pool.submit_after(std::chrono::milliseconds(30), std::make_unique<Task>([ran]() {
+        ran->set_value();
+    })), INVALID_TASK_ID);
+    pool.shutdown_graceful();
+
+    // Ran rather than dropped with a broken promise
+    ASSERT_EQ(result.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+    EXPECT_NO_THROW(result.get());
+    EXPECT_EQ(pool.get_statistics().pending_task_count, 0);
+}
+
+TEST(ReactorTest, Issue36_CancelAndShutdownHandBack) {
+    int fds[2];
+    ASSERT_EQ(::pipe(fds), 0);
+
+    ThreadPool pool(1);
+    std::atomic<int> executed{0};
+    auto count = [&executed]() { executed++; };
+
+    TaskId cancelled = pool.submit_when_ready(fds[0], IoInterest::READABLE, std::make_unique<Task>(count));
+    EXPECT_TRUE(pool.cancel_task(cancelled));
+    EXPECT_FALSE(pool.cancel_task(cancelled));
+
+    // Watching an unusable descriptor fails without leaking admission
+    EXPECT_EQ(pool.submit_when_ready(-1, IoInterest::READABLE, std::make_unique<Task>(count)),
+              INVALID_TASK_ID);
+
+    TaskId parked = pool.submit_when_ready(fds[0], IoInterest::READABLE, std::make_unique<Task>(count));
+    ASSERT_NE(parked, INVALID_TASK_ID);
+    EXPECT_EQ(pool.get_statistics().pending_task_count, 1);
+
+    // Graceful shutdown does not wait for I/O that may never arrive
+    auto unrun = pool.shutdown_graceful(std::chrono::seconds(5));
+    ASSERT_EQ(unrun.size(), 1);
+    EXPECT_EQ(unrun.front()->id(), parked);
+    EXPECT_EQ(executed, 0);
+    EXPECT_EQ(pool.get_statistics().pending_task_count, 0);
+
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+
+#include "taskscheduler/runtime_estimator.hpp"
+#include "taskscheduler/task_queue.hpp"
+
+using namespace taskscheduler;
+
+TEST(RuntimeEstimatorTest, Issue29_UnknownClassEstimatesZero) {
+    RuntimeEstimator estimator;
+    EXPECT_EQ(estimator.estimate(42), 0.0);
+}
+
+TEST(RuntimeEstimatorTest, Issue29_DefaultClassIsNotLearned) {
+    RuntimeEstimator estimator;
+    estimator.record(DEFAULT_TASK_CLASS, 10.0);
+    EXPECT_EQ(estimator.estimate(DEFAULT_TASK_CLASS), 0.0);
+}
+
+TEST(RuntimeEstimatorTest, Issue29_TracksMovingAverage) {
+    RuntimeEstimator estimator(0.5);
+
+    estimator.record(1, 10.0);
+    EXPECT_DOUBLE_EQ(estimator.estimate(1), 10.0);
+
+    estimator.record(1, 20.0);
+    EXPECT_DOUBLE_EQ(estimator.estimate(1), 15.0);
+
+    estimator.record(2, 3.0);
+    EXPECT_DOUBLE_EQ(estimator.estimate(1), 15.0);
+    EXPECT_DOUBLE_EQ(estimator.estimate(2), 3.0);
+}
+
+TEST(RuntimeEstimatorTest, Issue29_CriticalPathBreaksPriorityTies) {
+    TaskQueue queue;
+
+    auto short_path = std::make_unique<Task>([]() {}, Priority::NORMAL);
+    short_path->set_runtime_estimate_ms(1.0);
+    auto long_path = std::make_unique<Task>([]() {}, Priority::NORMAL);
+    long_path->set_runtime_estimate_ms(1.0);
+    EXPECT_TRUE(long_path->extend_critical_path(5.0));
+    EXPECT_FALSE(long_path->extend_critical_path(2.0));
+    EXPECT_DOUBLE_EQ(long_path->critical_path_ms(), 6.0);
+
+    Task* expected_first = long_path.get();
+    queue.push(std::move(short_path));
+    queue.push(std::move(long_path));
+
+    EXPECT_EQ(queue.pop().get(), expected_first);
+}
@@ -118,3 +118,81 @@ TEST(StatisticsTest, Issue11_DoesNotAffectExecution) {
     auto stats = pool.get_statistics();
     EXPECT_EQ(stats.completed_tasks, 20);
 }
+
+TEST(StatisticsTest, Issue44_InstrumentedMutexCountsContention) {
+    InstrumentedMutex mutex;
+    {
+        std::lock_guard<InstrumentedMutex> lock(mutex);
+    }
+
+    std::unique_lock<InstrumentedMutex> held(mutex);
+    std::atomic<bool> started{false};
+    std::thread waiter([&mutex, &started]() {
+        started = true;
+        std::lock_guard<InstrumentedMutex> lock(mutex);
+    });
+    while (!started) {
+        std::this_thread::yield();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    held.unlock();
+    waiter.join();
+
+    LockStatistics statistics = mutex.statistics();
+    EXPECT_EQ(statistics.acquisitions, 3);
+    EXPECT_EQ(statistics.contended_acquisitions, 1);
+    EXPECT_GE(statistics.wait_time_ms, 10.0);
+    EXPECT_GE(statistics.hold_time_ms, 10.0);
+
+    size_t holds = 0;
+    for (size_t count : statistics.hold_time_buckets) {
+        holds += count;
+    }
+    EXPECT_EQ(holds, 3);
+    EXPECT_EQ(statistics.hold_time_buckets.back(), 1);  // The 20ms hold overflows
+}
+
+TEST(StatisticsTest, Issue44_HoldTimeBoundsMatchBuckets) {
+    const auto& bounds = LockStatistics::HOLD_TIME_BUCKET_BOUNDS_US;
+    EXPECT_DOUBLE_EQ(bounds.front(), 0.25);
+    EXPECT_DOUBLE_EQ(bounds.back(), 8192.0);
+    for (size_t i = 1; i < bounds.size(); ++i) {
+        EXPECT_DOUBLE_EQ(bounds[i], 2 * bounds[i - 1]);
+    }
+
+    // A hold well inside bucket i is counted there
+    InstrumentedMutex mutex;
+    {
+        std::lock_guard<InstrumentedMutex> lock(mutex);
+        std::this_thread::sleep_for(std::chrono::microseconds(1000));
+    }
+    LockStatistics statistics = mutex.statistics();
+    size_t bucket = 0;
+    while (statistics.hold_time_buckets[bucket] == 0) {
+        ++bucket;
+    }
+    ASSERT_LT(bucket, bounds.size());
+    EXPECT_GE(bounds[bucket], statistics.hold_time_ms * 1000.0);
+    EXPECT_TRUE(bucket == 0 || bounds[bucket - 1] < statistics.hold_time_ms * 1000.0);
+}
+
+TEST(StatisticsTest, Issue44_PoolReportsSchedulerLocks) {
+    ThreadPool pool(2);
+    pool.add_lane("io", 1);
+    pool.start();
+    TaskId first = pool.submit_with_id(std::make_unique<Task>([]() {}));
+    pool.submit_with_id(std::make_unique<Task>([]() {}, Priority::NORMAL, std::vector<TaskId>{first}));
+    pool.shutdown_graceful();
+
+    auto locks = pool.get_lock_statistics();
+#ifdef TASKSCHEDULER_LOCK_STATS
+    ASSERT_EQ(locks.size(), 3);
+    EXPECT_EQ(locks[0].name, "task_queue/default");
+    EXPECT_EQ(locks[1].name, "task_queue/io");
+    EXPECT_EQ(locks[2].name, "dependency_tracker");
+    EXPECT_GT(locks[0].acquisitions, 0);
+    EXPECT_GT(locks[2].acquisitions, 0);
+#else
+    EXPECT_TRUE(locks.empty());
+#endif
+}
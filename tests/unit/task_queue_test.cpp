@@ -216,3 +216,140 @@ TEST(TaskQueueTest, Issue9_DeadlineGettersWork) {
     EXPECT_TRUE(task1->deadline().has_value());
     EXPECT_EQ(task1->deadline().value(), deadline);
 }
+
+// F2P Test: Inherited priority re-keys a task that is already queued
+TEST(TaskQueueTest, Issue28_InheritRekeysQueuedTask) {
+    TaskQueue queue;
+    std::vector<int> execution_order;
+
+    auto low = std::make_unique<Task>([&execution_order]() { execution_order.push_back(1); }, Priority::LOW);
+    low->set_id(1);
+    auto high = std::make_unique<Task>([&execution_order]() { execution_order.push_back(2); }, Priority::HIGH);
+    high->set_id(2);
+
+    queue.push(std::move(low));
+    queue.push(std::move(high));
+
+    EXPECT_EQ(queue.inherit({{1, 0.0}}, Priority::CRITICAL, std::nullopt), 1);
+    EXPECT_EQ(queue.inherit({{1, 0.0}}, Priority::HIGH, std::nullopt), 0);
+
+    auto t1 = queue.pop();
+    auto t2 = queue.pop();
+    EXPECT_EQ(t1->priority(), Priority::CRITICAL);
+    EXPECT_EQ(t1->base_priority(), Priority::LOW);
+
+    t1->execute();
+    t2->execute();
+
+    ASSERT_EQ(execution_order.size(), 2);
+    EXPECT_EQ(execution_order[0], 1);
+    EXPECT_EQ(execution_order[1], 2);
+}
+
+// P2P Test: Published size and closed state track every queue mutation
+TEST(TaskQueueTest, Issue32_PublishedStateTracksMutations) {
+    TaskQueue queue;
+
+    queue.push(std::make_unique<Task>([]() {}, Priority::LOW));
+    queue.push(std::make_unique<Task>([]() {}, Priority::HIGH));
+    queue.push(std::make_unique<Task>([]() {}, Priority::NORMAL));
+    EXPECT_EQ(queue.size(), 3);
+
+    queue.pop();
+    EXPECT_EQ(queue.size(), 2);
+
+    auto shed = queue.shed_lowest(Priority::CRITICAL);
+    ASSERT_NE(shed, nullptr);
+    EXPECT_EQ(shed->priority(), Priority::LOW);
+    EXPECT_EQ(queue.size(), 1);
+    EXPECT_FALSE(queue.is_closed());
+
+    auto drained = queue.close_and_drain();
+    EXPECT_EQ(drained.size(), 1);
+    EXPECT_TRUE(queue.empty());
+    EXPECT_TRUE(queue.is_closed());
+}
+
+TEST(TaskQueueTest, Issue47_UpdateTaskRekeysInPlace) {
+    TaskQueue queue;
+    const Priority priorities[] = {Priority::LOW, Priority::NORMAL, Priority::HIGH};
+    for (TaskId id = 1; id <= 3; ++id) {
+        auto task = std::make_unique<Task>([]() {}, priorities[id - 1]);
+        task->set_id(id);
+        queue.push(std::move(task));
+    }
+
+    EXPECT_TRUE(queue.update_task(1, Priority::CRITICAL, std::nullopt));
+    EXPECT_TRUE(queue.update_task(2, std::nullopt, std::chrono::steady_clock::now() + std::chrono::seconds(1)));
+    EXPECT_FALSE(queue.update_task(4, Priority::CRITICAL, std::nullopt));
+
+    EXPECT_EQ(queue.pop()->id(), 2);  // Deadline first
+    auto first = queue.pop();
+    EXPECT_EQ(first->id(), 1);
+    EXPECT_EQ(first->priority(), Priority::CRITICAL);
+    EXPECT_EQ(queue.pop()->id(), 3);
+    EXPECT_FALSE(queue.update_task(1, Priority::LOW, std::nullopt));
+}
+
+TEST(TaskQueueTest, Issue47_UpdateKeepsInheritedUrgency) {
+    TaskQueue queue;
+    auto now = std::chrono::steady_clock::now();
+    for (TaskId id = 1; id <= 2; ++id) {
+        auto task = std::make_unique<Task>([]() {}, Priority::NORMAL);
+        task->set_id(id);
+        task->set_deadline(now + std::chrono::seconds(id == 1 ? 30 : 20));
+        queue.push(std::move(task));
+    }
+
+    // A dependent passes on an earlier deadline and a higher priority...
+    EXPECT_EQ(queue.inherit({{1, 0.0}}, Priority::HIGH, now + std::chrono::seconds(10)), 1);
+
+    // ...which outlast later updates of the task's own values
+    EXPECT_TRUE(queue.update_task(1, Priority::LOW, now + std::chrono::seconds(40)));
+    auto first = queue.pop();
+    EXPECT_EQ(first->id(), 1);
+    EXPECT_EQ(first->priority(), Priority::HIGH);
+    EXPECT_EQ(first->base_priority(), Priority::LOW);
+    EXPECT_EQ(first->deadline().value(), now + std::chrono::seconds(10));
+
+    // Own values earlier or higher than the inherited ones still win
+    first->set_deadline(now + std::chrono::seconds(5));
+    first->set_priority(Priority::CRITICAL);
+    EXPECT_EQ(first->deadline().value(), now + std::chrono::seconds(5));
+    EXPECT_EQ(first->priority(), Priority::CRITICAL);
+    first->set_deadline(now + std::chrono::seconds(50));
+    first->set_priority(Priority::NORMAL);
+    EXPECT_EQ(first->deadline().value(), now + std::chrono::seconds(10));
+    EXPECT_EQ(first->priority(), Priority::HIGH);
+}
+
+TEST(TaskQueueTest, Issue47_HeapOrderSurvivesManyUpdates) {
+    TaskQueue queue;
+    const Priority priorities[] = {Priority::LOW, Priority::NORMAL, Priority::HIGH, Priority::CRITICAL};
+    uint32_t state = 12345;
+    auto next = [&state]() {
+        state = state * 1103515245 + 12345;
+        return (state >> 16) & 0x7fff;
+    };
+
+    for (TaskId id = 1; id <= 500; ++id) {
+        auto task = std::make_unique<Task>([]() {}, priorities[next() % 4]);
+        task->set_id(id);
+        queue.push(std::move(task));
+    }
+    for (int i = 0; i < 2000; ++i) {
+        EXPECT_TRUE(queue.update_task(1 + next() % 500, priorities[next() % 4], std::nullopt));
+    }
+    EXPECT_TRUE(queue.cancel_task(250));
+    ASSERT_NE(queue.shed_lowest(Priority::CRITICAL), nullptr);
+
+    Priority previous = Priority::CRITICAL;
+    size_t popped = 0;
+    while (!queue.empty()) {
+        auto task = queue.pop();
+        EXPECT_LE(task->priority(), previous);
+        previous = task->priority();
+        ++popped;
+    }
+    EXPECT_EQ(popped, 499);
+}
@@ -1,6 +1,9 @@
 #include <gtest/gtest.h>
 
 #include "taskscheduler/task.hpp"
+#include <limits>
+#include <type_traits>
+#include <vector>
 
 using namespace taskscheduler;
 
@@ -10,3 +13,55 @@ TEST(TaskTest, ExecutesCallable) {
     task.execute();
     EXPECT_EQ(counter, 1);
 }
+
+TEST(TaskTest, Issue34_DependenciesStoredInlineUpToFour) {
+    Task few([]() {}, Priority::NORMAL, {1, 2, 3, 4});
+    ASSERT_EQ(few.dependency_list().size(), 4);
+    EXPECT_EQ(few.dependency_list()[3], 4);
+    EXPECT_EQ(few.dependency_list().heap_bytes(), 0);
+    EXPECT_EQ(few.footprint_bytes(), sizeof(Task));
+
+    Task many([]() {}, Priority::NORMAL, {1, 2, 3, 4, 5, 6});
+    ASSERT_EQ(many.dependency_list().size(), 6);
+    EXPECT_EQ(many.dependency_list()[5], 6);
+    EXPECT_EQ(many.dependency_list().heap_bytes(), 6 * sizeof(TaskId));
+
+    TaskIdList copy = many.dependency_list();
+    TaskIdList moved = std::move(copy);
+    EXPECT_TRUE(copy.empty());
+    EXPECT_EQ(moved.size(), 6);
+    EXPECT_EQ(moved[0], 1);
+}
+
+TEST(TaskTest, Issue34_DependenciesStillReadAsVector) {
+    Task task([]() {}, Priority::NORMAL, {3, 1, 2, 5, 8});
+    const std::vector<TaskId>& ids = task.dependencies();
+    EXPECT_EQ(ids, (std::vector<TaskId>{3, 1, 2, 5, 8}));
+    EXPECT_TRUE(Task([]() {}).dependencies().empty());
+}
+
+TEST(TaskTest, Issue34_CompactLayout) {
+    EXPECT_LE(sizeof(Task), 2 * 64);
+    EXPECT_FALSE(std::has_virtual_destructor<Task>::value);
+}
+
+TEST(TaskTest, Issue34_DeadlineSentinel) {
+    Task task([]() {});
+    EXPECT_FALSE(task.has_deadline());
+    EXPECT_FALSE(task.deadline().has_value());
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    task.set_deadline(deadline);
+    ASSERT_TRUE(task.has_deadline());
+    EXPECT_EQ(task.deadline().value(), deadline);
+
+    // The latest representable deadline must not read back as "none"
+    Task latest([]() {});
+    latest.set_deadline(Task::TimePoint::max());
+    EXPECT_TRUE(latest.has_deadline());
+    EXPECT_LT(latest.deadline_key(), std::numeric_limits<int64_t>::max());
+
+    EXPECT_FALSE(task.inherit_deadline(deadline + std::chrono::seconds(1)));
+    EXPECT_TRUE(task.inherit_deadline(deadline - std::chrono::seconds(1)));
+    EXPECT_EQ(task.deadline().value(), deadline - std::chrono::seconds(1));
+}
@@ -1,9 +1,15 @@
 #include <gtest/gtest.h>
 
 #include "taskscheduler/thread_pool.hpp"
+#include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <future>
+#include <stdexcept>
 #include <thread>
+#include <mutex>
+#include <vector>
+#include <string>
 
 using namespace taskscheduler;
 
@@ -222,7 +228,11 @@ TEST(ThreadPoolTest, Issue15_CancelTaskWithDependencies) {
     std::atomic<int> task1_executed{0};
     std::atomic<int> task2_executed{0};
 
-    TaskId task1_id = pool.submit_with_id(std::make_unique<Task>([&task1_executed]() {
+    // Held until the dependent is cancelled, so it is still outstanding
+    std::promise<void> gate;
+    std::shared_future<void> opened = gate.get_future().share();
+    TaskId task1_id = pool.submit_with_id(std::make_unique<Task>([&task1_executed, opened]() {
+        opened.wait();
         task1_executed++;
     }));
 
@@ -236,6 +246,7 @@ TEST(ThreadPoolTest, Issue15_CancelTaskWithDependencies) {
 
     // Cancel the dependent task immediately
     bool cancelled = pool.cancel_task(task2_id);
+    gate.set_value();
 
     // Wait for task1 to complete
     std::this_thread::sleep_for(std::chrono::milliseconds(50));
@@ -301,3 +312,902 @@ TEST(ThreadPoolTest, Issue15_StatisticsWithCancellation) {
     auto stats = pool.get_statistics();
     EXPECT_GE(stats.completed_tasks, 2);
 }
+
+// F2P Test: Cancelling a queued task skips its whole dependent chain
+TEST(ThreadPoolTest, Issue26_CancelCascadesThroughDependencies) {
+    ThreadPool pool(1);
+    std::atomic<int> executed{0};
+
+    pool.submit(std::make_unique<Task>([]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }));
+
+    TaskId root_id = pool.submit_with_id(std::make_unique<Task>([&executed]() {
+        executed++;
+    }));
+    TaskId child_id = pool.submit_with_id(std::make_unique<Task>(
+        [&executed]() { executed++; }, Priority::NORMAL, std::vector<TaskId>{root_id}));
+    pool.submit_with_id(std::make_unique<Task>(
+        [&executed]() { executed++; }, Priority::NORMAL, std::vector<TaskId>{child_id}));
+
+    EXPECT_TRUE(pool.cancel_task(root_id));
+
+    // Dependents were released along with the root
+    EXPECT_FALSE(pool.cancel_task(child_id));
+
+    pool.shutdown_graceful();
+
+    EXPECT_EQ(executed, 0);
+}
+
+// F2P Test: A CRITICAL dependent pulls its queued LOW prerequisite forward
+TEST(ThreadPoolTest, Issue28_PriorityInheritedByQueuedDependency) {
+    ThreadPool pool(1);
+    std::atomic<bool> release{false};
+    std::atomic<bool> started{false};
+    std::mutex order_mutex;
+    std::vector<int> order;
+
+    auto record = [&order_mutex, &order](int value) {
+        std::lock_guard<std::mutex> lock(order_mutex);
+        order.push_back(value);
+    };
+
+    pool.submit(std::make_unique<Task>([&release, &started]() {
+        started = true;
+        while (!release) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }));
+    while (!started) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    for (int i = 0; i < 3; ++i) {
+        pool.submit(std::make_unique<Task>([&record]() { record(0); }, Priority::NORMAL));
+    }
+    TaskId low_id = pool.submit_with_id(std::make_unique<Task>([&record]() { record(1); }, Priority::LOW));
+    pool.submit(std::make_unique<Task>([&record]() { record(2); }, Priority::CRITICAL,
+                                       std::vector<TaskId>{low_id}));
+
+    EXPECT_EQ(pool.get_statistics().priority_inheritance_boosts, 1);
+
+    release = true;
+    while (pool.get_statistics().completed_tasks < 6) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    pool.shutdown_graceful();
+
+    ASSERT_EQ(order.size(), 5);
+    EXPECT_EQ(order[0], 1);  // Boosted LOW prerequisite
+    EXPECT_EQ(order[1], 2);  // CRITICAL dependent
+}
+
+// F2P Test: Learned runtimes start the longest dependency chain first
+TEST(ThreadPoolTest, Issue29_CriticalPathRunsFirst) {
+    constexpr TaskClassId SLOW_CLASS = 7;
+    ThreadPool pool(1);
+
+    for (int i = 0; i < 3; ++i) {
+        auto training = std::make_unique<Task>([]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        });
+        training->set_task_class(SLOW_CLASS);
+        pool.submit(std::move(training));
+    }
+
+    std::atomic<bool> release{false};
+    std::atomic<bool> started{false};
+    std::mutex order_mutex;
+    std::vector<int> order;
+    auto record = [&order_mutex, &order](int value) {
+        std::lock_guard<std::mutex> lock(order_mutex);
+        order.push_back(value);
+    };
+
+    pool.submit(std::make_unique<Task>([&release, &started]() {
+        started = true;
+        while (!release) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }));
+    while (!started) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    pool.submit(std::make_unique<Task>([&record]() { record(0); }));
+
+    auto head = std::make_unique<Task>([&record]() { record(1); });
+    head->set_task_class(SLOW_CLASS);
+    TaskId head_id = pool.submit_with_id(std::move(head));
+
+    auto tail = std::make_unique<Task>([&record]() { record(2); }, Priority::NORMAL,
+                                       std::vector<TaskId>{head_id});
+    tail->set_task_class(SLOW_CLASS);
+    pool.submit(std::move(tail));
+
+    release = true;
+    while (pool.get_statistics().completed_tasks < 7) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    pool.shutdown_graceful();
+
+    ASSERT_EQ(order.size(), 3);
+    EXPECT_EQ(order[0], 1);  // Head of the longer chain jumps the FIFO order
+}
+
+// Submitting at the end of a long pending chain must not walk the chain,
+// also once runtimes have been learned
+TEST(ThreadPoolTest, Issue29_ChainSubmitStaysLinearAfterWarmUp) {
+    constexpr TaskClassId SLOW_CLASS = 7;
+    ThreadPool pool(1);
+    for (TaskClassId task_class : {DEFAULT_TASK_CLASS, SLOW_CLASS}) {
+        auto training = std::make_unique<Task>([]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        });
+        training->set_task_class(task_class);
+        pool.submit(std::move(training));
+    }
+    pool.wait_idle();
+
+    std::atomic<bool> release{false};
+    pool.submit(std::make_unique<Task>([&release]() {
+        while (!release) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }));
+
+    auto submit_chain = [&pool](size_t length, TaskClassId task_class) {
+        auto start = std::chrono::steady_clock::now();
+        TaskId previous = pool.submit_with_id(std::make_unique<Task>([]() {}));
+        for (size_t i = 1; i < length; ++i) {
+            auto task = std::make_unique<Task>([]() {}, Priority::LOW, std::vector<TaskId>{previous});
+            task->set_task_class(task_class);
+            previous = pool.submit_with_id(std::move(task));
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    // Eight times the chain costs eight times as much if linear, 64 if not
+    for (TaskClassId task_class : {DEFAULT_TASK_CLASS, SLOW_CLASS}) {
+        double short_chain = submit_chain(1000, task_class);
+        double long_chain = submit_chain(8000, task_class);
+        EXPECT_LT(long_chain, 24 * short_chain) << "class " << task_class;
+    }
+
+    release = true;
+    pool.shutdown_graceful();
+}
+
+// F2P Test: A dependency chain runs inline on the completing worker
+TEST(ThreadPoolTest, Issue30_ChainRunsInlineOnSameWorker) {
+    ThreadPool pool(4);
+    pool.set_inline_continuations(true);
+
+    constexpr int CHAIN_LENGTH = 20;
+    std::mutex ids_mutex;
+    std::vector<std::thread::id> worker_ids;
+    std::atomic<bool> release{false};
+
+    auto record = [&ids_mutex, &worker_ids]() {
+        std::lock_guard<std::mutex> lock(ids_mutex);
+        worker_ids.push_back(std::this_thread::get_id());
+    };
+
+    TaskId previous = pool.submit_with_id(std::make_unique<Task>([&release, &record]() {
+        while (!release) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        record();
+    }));
+    for (int i = 1; i < CHAIN_LENGTH; ++i) {
+        previous = pool.submit_with_id(std::make_unique<Task>(
+            record, Priority::NORMAL, std::vector<TaskId>{previous}));
+    }
+
+    release = true;
+    while (pool.get_statistics().completed_tasks < CHAIN_LENGTH) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    pool.shutdown_graceful();
+
+    ASSERT_EQ(worker_ids.size(), CHAIN_LENGTH);
+    for (const auto& id : worker_ids) {
+        EXPECT_EQ(id, worker_ids.front());
+    }
+    EXPECT_EQ(pool.get_statistics().inline_continuations, CHAIN_LENGTH - 1);
+}
+
+// F2P Test: Graceful shutdown drains queued tasks and released dependents
+TEST(ThreadPoolTest, Issue31_GracefulShutdownDrainsDependents) {
+    ThreadPool pool(2);
+    std::atomic<int> executed{0};
+
+    TaskId root = pool.submit_with_id(std::make_unique<Task>([&executed]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        executed++;
+    }));
+    for (int i = 0; i < 5; ++i) {
+        pool.submit(std::make_unique<Task>([&executed]() { executed++; }, Priority::NORMAL,
+                                           std::vector<TaskId>{root}));
+    }
+
+    pool.shutdown_graceful();
+
+    EXPECT_EQ(executed, 6);
+    EXPECT_GT(pool.get_statistics().last_shutdown_time_ms, 0.0);
+}
+
+// F2P Test: Immediate shutdown hands back every task that did not run
+TEST(ThreadPoolTest, Issue31_ImmediateShutdownReturnsUnrunTasks) {
+    ThreadPool pool(1);
+    std::atomic<bool> started{false};
+    std::atomic<int> executed{0};
+
+    TaskId blocker = pool.submit_with_id(std::make_unique<Task>([&started, &executed]() {
+        started = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        executed++;
+    }));
+    while (!started) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    for (int i = 0; i < 4; ++i) {
+        pool.submit(std::make_unique<Task>([&executed]() { executed++; }));
+    }
+    pool.submit(std::make_unique<Task>([&executed]() { executed++; }, Priority::NORMAL,
+                                       std::vector<TaskId>{blocker}));
+    TaskId cancelled = pool.submit_with_id(std::make_unique<Task>([&executed]() { executed++; }));
+    pool.cancel_task(cancelled);
+
+    // A dependent handed back together with its prerequisite
+    std::atomic<bool> prerequisite_ran{false};
+    TaskId prerequisite = pool.submit_with_id(std::make_unique<Task>([&prerequisite_ran, &executed]() {
+        prerequisite_ran = true;
+        executed++;
+    }));
+    pool.submit(std::make_unique<Task>([&prerequisite_ran, &executed]() {
+        if (prerequisite_ran) {
+            executed += 10;
+        }
+    }, Priority::HIGH, std::vector<TaskId>{prerequisite}));
+
+    auto unrun = pool.shutdown_immediate();
+
+    EXPECT_EQ(executed, 1);
+    EXPECT_EQ(unrun.size(), 7);
+    EXPECT_EQ(pool.get_statistics().pending_task_count, 0);
+
+    // The tasks can be moved to a successor pool as they are
+    ThreadPool successor(2);
+    auto ids = successor.resubmit(std::move(unrun));
+    EXPECT_EQ(std::count(ids.begin(), ids.end(), INVALID_TASK_ID), 0);
+    successor.shutdown_graceful();
+    EXPECT_EQ(executed, 17);
+}
+
+// F2P Test: A drain deadline bounds graceful shutdown
+TEST(ThreadPoolTest, Issue31_GracefulShutdownHonoursDrainTimeout) {
+    ThreadPool pool(1);
+    std::atomic<int> executed{0};
+
+    for (int i = 0; i < 10; ++i) {
+        pool.submit(std::make_unique<Task>([&executed]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            executed++;
+        }));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto unrun = pool.shutdown_graceful(std::chrono::milliseconds(30));
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_LT(elapsed, std::chrono::milliseconds(150));
+    EXPECT_FALSE(unrun.empty());
+    EXPECT_EQ(executed + unrun.size(), 10);
+    EXPECT_FALSE(pool.is_running());
+}
+
+TEST(ThreadPoolTest, Issue37_BlockingRegionSpawnsCompensatingWorker) {
+    ThreadPool pool(1);
+    std::atomic<bool> blocked{false};
+    std::atomic<bool> release{false};
+    std::atomic<bool> other_ran{false};
+
+    pool.submit(std::make_unique<Task>([&]() {
+        auto region = pool.blocking_region();
+        blocked = true;
+        while (!release) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }));
+    while (!blocked) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // The only regular worker is blocked, yet queued work still runs
+    pool.submit(std::make_unique<Task>([&other_ran]() { other_ran = true; }));
+    for (int i = 0; i < 5000 && !other_ran; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_TRUE(other_ran);
+
+    auto stats = pool.get_statistics();
+    EXPECT_EQ(stats.blocked_workers, 1);
+    EXPECT_EQ(stats.compensating_workers_spawned, 1);
+
+    release = true;
+    pool.shutdown_graceful();
+
+    stats = pool.get_statistics();
+    EXPECT_EQ(stats.blocked_workers, 0);
+    EXPECT_GT(stats.blocked_time_ms, 0.0);
+    EXPECT_EQ(pool.get_cumulative_statistics().compensating_workers_spawned, 1);
+}
+
+TEST(ThreadPoolTest, Issue37_CompensationRespectsCap) {
+    ThreadPool pool(1);
+    pool.set_max_compensating_workers(0);
+    std::atomic<bool> blocked{false};
+    std::atomic<bool> release{false};
+    std::atomic<bool> other_ran{false};
+
+    pool.submit(std::make_unique<Task>([&]() {
+        auto region = pool.blocking_region();
+        blocked = true;
+        while (!release) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }));
+    while (!blocked) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    pool.submit(std::make_unique<Task>([&other_ran]() { other_ran = true; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    EXPECT_FALSE(other_ran);
+    EXPECT_EQ(pool.get_statistics().compensating_workers_spawned, 0);
+
+    release = true;
+    pool.shutdown_graceful();
+    EXPECT_TRUE(other_ran);
+}
+
+TEST(ThreadPoolTest, Issue37_BlockingRegionOutsideWorkerIsNoOp) {
+    ThreadPool pool(1);
+    pool.start();
+    {
+        auto region = pool.blocking_region();
+        EXPECT_EQ(pool.get_statistics().blocked_workers, 0);
+    }
+    pool.shutdown_graceful();
+
+    auto stats = pool.get_statistics();
+    EXPECT_EQ(stats.compensating_workers_spawned, 0);
+    EXPECT_EQ(stats.blocked_time_ms, 0.0);
+}
+
+TEST(ThreadPoolTest, Issue38_LanesIsolateBlockingWork) {
+    constexpr TaskClassId IO_CLASS = 7;
+    ThreadPool pool(1);
+    ASSERT_TRUE(pool.add_lane("io", 1));
+    ASSERT_TRUE(pool.route_class(IO_CLASS, "io"));
+
+    std::atomic<bool> io_started{false};
+    std::atomic<bool> release{false};
+    std::atomic<bool> cpu_ran{false};
+
+    auto io_task = std::make_unique<Task>([&]() {
+        io_started = true;
+        while (!release) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    io_task->set_task_class(IO_CLASS);
+    pool.submit(std::move(io_task));
+    while (!io_started) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // The io lane's only worker is busy; the default lane is not
+    pool.submit(std::make_unique<Task>([&cpu_ran]() { cpu_ran = true; }));
+    for (int i = 0; i < 5000 && !cpu_ran; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_TRUE(cpu_ran);
+
+    release = true;
+    pool.shutdown_graceful();
+
+    EXPECT_EQ(pool.thread_count(), 0);
+    EXPECT_EQ(pool.get_statistics().completed_tasks, 2);
+    EXPECT_EQ(pool.get_lane_statistics("io")->completed_tasks, 1);
+    EXPECT_EQ(pool.get_lane_statistics("default")->completed_tasks, 1);
+    EXPECT_FALSE(pool.get_lane_statistics("gpu").has_value());
+}
+
+TEST(ThreadPoolTest, Issue38_DependenciesCrossLanes) {
+    ThreadPool pool(1);
+    ASSERT_TRUE(pool.add_lane("io", 1));
+
+    std::mutex mutex;
+    std::vector<std::string> order;
+    std::thread::id io_thread;
+    std::thread::id default_thread;
+
+    TaskId read = pool.submit_with_id("io", std::make_unique<Task>([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        std::lock_guard<std::mutex> lock(mutex);
+        io_thread = std::this_thread::get_id();
+        order.push_back("read");
+    }));
+    ASSERT_NE(read, INVALID_TASK_ID);
+
+    pool.submit(std::make_unique<Task>([&]() {
+        std::lock_guard<std::mutex> lock(mutex);
+        default_thread = std::this_thread::get_id();
+        order.push_back("parse");
+    }, Priority::NORMAL, std::vector<TaskId>{read}));
+
+    pool.shutdown_graceful();
+
+    EXPECT_EQ(order, (std::vector<std::string>{"read", "parse"}));
+    EXPECT_NE(io_thread, default_thread);
+}
+
+TEST(ThreadPoolTest, Issue38_LaneConfiguration) {
+    ThreadPool pool(1);
+    EXPECT_TRUE(pool.add_lane("io", 2));
+    EXPECT_FALSE(pool.add_lane("io", 1));
+    EXPECT_FALSE(pool.add_lane("empty", 0));
+    EXPECT_FALSE(pool.route_class(3, "gpu"));
+    EXPECT_EQ(pool.lane_names(), (std::vector<std::string>{"default", "io"}));
+
+    EXPECT_EQ(pool.submit_with_id("gpu", std::make_unique<Task>([]() {})), INVALID_TASK_ID);
+    pool.start();
+    EXPECT_EQ(pool.thread_count(), 3);
+    EXPECT_FALSE(pool.add_lane("late", 1));
+
+    pool.shutdown_graceful();
+}
+
+TEST(ThreadPoolTest, Issue42_KeyedSubmitsShareOneExecution) {
+    ThreadPool pool(2);
+    std::atomic<int> runs{0};
+    std::promise<void> gate;
+    std::shared_future<void> opened = gate.get_future().share();
+
+    auto compute = [&runs, opened]() {
+        opened.wait();
+        return ++runs * 10;
+    };
+    auto first = pool.submit_keyed("report", compute);
+    auto second = pool.submit_keyed("report", compute);
+    auto other = pool.submit_keyed("other", compute);
+    gate.set_value();
+
+    EXPECT_EQ(first.get(), second.get());
+    other.get();
+    EXPECT_EQ(runs.load(), 2);
+
+    auto stats = pool.get_statistics();
+    EXPECT_EQ(stats.deduplicated_submits, 1);
+    EXPECT_EQ(stats.result_cache_misses, 2);
+    EXPECT_EQ(stats.result_cache_hits, 0);
+
+    // Nothing is kept by default once the result is ready
+    pool.submit_keyed("report", compute).get();
+    EXPECT_EQ(runs.load(), 3);
+    pool.shutdown_graceful();
+}
+
+TEST(ThreadPoolTest, Issue42_ResultCacheHonoursSizeAndTtl) {
+    ThreadPool pool(2);
+    ResultCacheLimits limits;
+    limits.max_entries = 1;
+    limits.ttl = std::chrono::milliseconds(50);
+    pool.set_result_cache_limits(limits);
+
+    std::atomic<int> runs{0};
+    auto compute = [&runs](int value) {
+        ++runs;
+        return value;
+    };
+
+    EXPECT_EQ(pool.submit_keyed("a", compute, 1).get(), 1);
+    EXPECT_EQ(pool.submit_keyed("a", compute, 2).get(), 1);  // Cached
+    EXPECT_EQ(runs.load(), 1);
+    EXPECT_EQ(pool.get_statistics().result_cache_hits, 1);
+
+    EXPECT_EQ(pool.submit_keyed("b", compute, 3).get(), 3);  // Evicts "a"
+    EXPECT_EQ(pool.submit_keyed("a", compute, 4).get(), 4);
+    EXPECT_EQ(runs.load(), 3);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    EXPECT_EQ(pool.submit_keyed("a", compute, 5).get(), 5);  // Expired
+    EXPECT_EQ(runs.load(), 4);
+
+    pool.clear_result_cache();
+    EXPECT_EQ(pool.submit_keyed("a", compute, 6).get(), 6);
+    EXPECT_EQ(pool.get_cumulative_statistics().result_cache_misses, 5);
+    pool.shutdown_graceful();
+}
+
+TEST(ThreadPoolTest, Issue42_FailedResultsAreNotCached) {
+    ThreadPool pool(1);
+    ResultCacheLimits limits;
+    limits.max_entries = 8;
+    pool.set_result_cache_limits(limits);
+
+    std::atomic<int> runs{0};
+    auto flaky = [&runs]() -> int {
+        if (++runs == 1) {
+            throw std::runtime_error("transient");
+        }
+        return 7;
+    };
+
+    EXPECT_THROW(pool.submit_keyed("job", flaky).get(), std::runtime_error);
+    EXPECT_EQ(pool.submit_keyed("job", flaky).get(), 7);
+    EXPECT_EQ(pool.submit_keyed("job", flaky).get(), 7);
+    EXPECT_EQ(runs.load(), 2);
+    pool.shutdown_graceful();
+}
+
+TEST(ThreadPoolTest, Issue42_RejectedKeyedSubmitIsNotCounted) {
+    ThreadPool pool(1);
+    pool.set_admission_limits({1, 0, OverflowPolicy::REJECT});
+    std::promise<void> gate;
+    std::shared_future<void> opened = gate.get_future().share();
+    ASSERT_NE(pool.submit_with_id(std::make_unique<Task>([opened]() { opened.wait(); })), INVALID_TASK_ID);
+
+    auto compute = []() { return 5; };
+    auto rejected = pool.submit_keyed("key", compute);
+    EXPECT_THROW(rejected.get(), std::future_error);
+    EXPECT_EQ(pool.get_statistics().result_cache_misses, 0);
+
+    // The key was not left behind for later submits to join
+    pool.set_admission_limits({});
+    auto accepted = pool.submit_keyed("key", compute);
+    gate.set_value();
+    EXPECT_EQ(accepted.get(), 5);
+    EXPECT_EQ(pool.get_statistics().result_cache_misses, 1);
+    EXPECT_EQ(pool.get_statistics().deduplicated_submits, 0);
+    pool.shutdown_graceful();
+}
+
+TEST(ThreadPoolTest, Issue43_CoalescesItemsIntoBatches) {
+    ThreadPool pool(2);
+    std::mutex mutex;
+    std::vector<size_t> batch_sizes;
+
+    BatchOptions options;
+    options.max_items = 8;
+    options.max_delay = std::chrono::milliseconds(1);
+    ASSERT_TRUE((pool.register_batch_handler<int, int>(5, options, [&](std::vector<int>& items) {
+        std::lock_guard<std::mutex> lock(mutex);
+        batch_sizes.push_back(items.size());
+        std::vector<int> doubled;
+        for (int item : items) {
+            doubled.push_back(item * 2);
+        }
+        return doubled;
+    })));
+    EXPECT_FALSE((pool.register_batch_handler<int, int>(5, options, [](std::vector<int>& items) {
+        return items;
+    })));
+
+    std::vector<std::future<int>> results;
+    for (int i = 0; i < 20; ++i) {
+        results.push_back(pool.submit_batched<int>(5, i));
+    }
+    for (int i = 0; i < 20; ++i) {
+        EXPECT_EQ(results[i].get(), i * 2);
+    }
+    pool.shutdown_graceful();
+
+    size_t items = 0;
+    for (size_t size : batch_sizes) {
+        EXPECT_LE(size, 8);
+        items += size;
+    }
+    EXPECT_EQ(items, 20);
+    EXPECT_LT(batch_sizes.size(), 20);
+    EXPECT_EQ(pool.get_statistics().coalesced_items, 20);
+}
+
+TEST(ThreadPoolTest, Issue43_PartialBatchRunsAfterDelayOrShutdown) {
+    ThreadPool pool(1);
+    std::atomic<int> batches{0};
+
+    BatchOptions delayed;
+    delayed.max_items = 100;
+    delayed.max_delay = std::chrono::milliseconds(2);
+    ASSERT_TRUE((pool.register_batch_handler<std::string, void>(1, delayed, [&](std::vector<std::string>&) {
+        ++batches;
+    })));
+
+    BatchOptions never;
+    never.max_items = 100;
+    never.max_delay = std::chrono::hours(1);
+    ASSERT_TRUE((pool.register_batch_handler<int, size_t>(2, never, [](std::vector<int>& items) {
+        return std::vector<size_t>(items.size(), items.size());
+    })));
+
+    auto first = pool.submit_batched<void>(1, std::string("a"));
+    auto second = pool.submit_batched<void>(1, std::string("b"));
+    EXPECT_EQ(first.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    EXPECT_EQ(second.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    EXPECT_EQ(batches.load(), 1);
+
+    // Waiting an hour is cut short by the graceful shutdown
+    auto waiting = pool.submit_batched<size_t>(2, 7);
+    auto also_waiting = pool.submit_batched<size_t>(2, 8);
+    auto unrun = pool.shutdown_graceful(std::chrono::seconds(5));
+    EXPECT_TRUE(unrun.empty());
+    EXPECT_EQ(waiting.get(), 2);
+    EXPECT_EQ(also_waiting.get(), 2);
+}
+
+TEST(ThreadPoolTest, Issue43_BatchRunsInPlaceWithoutFlushTimer) {
+    ThreadPool pool(1);
+    BatchOptions options;
+    options.max_items = 2;
+    options.max_delay = std::chrono::hours(1);
+    ASSERT_TRUE((pool.register_batch_handler<int, int>(6, options, [](std::vector<int>& items) {
+        return items;
+    })));
+
+    // A full batch takes its flush timer with it, leaving nothing pending
+    auto first = pool.submit_batched<int>(6, 1);
+    auto second = pool.submit_batched<int>(6, 2);
+    EXPECT_EQ(first.get(), 1);
+    EXPECT_EQ(second.get(), 2);
+    EXPECT_TRUE(pool.wait_idle(std::chrono::seconds(5)));
+
+    // With no room for a flush timer the batch runs right away
+    std::promise<void> gate;
+    std::shared_future<void> opened = gate.get_future().share();
+    pool.submit([opened]() { opened.wait(); });
+    AdmissionLimits limits;
+    limits.max_pending_tasks = 1;
+    pool.set_admission_limits(limits);
+    auto alone = pool.submit_batched<int>(6, 3);
+    EXPECT_EQ(alone.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+    EXPECT_EQ(alone.get(), 3);
+
+    gate.set_value();
+    pool.shutdown_graceful();
+}
+
+TEST(ThreadPoolTest, Issue43_PostedItemsShareBatchesWithoutFutures) {
+    ThreadPool pool(1);
+    std::atomic<int> total{0};
+    BatchOptions options;
+    options.max_items = 4;
+    options.max_delay = std::chrono::hours(1);  // Only full batches run
+    ASSERT_TRUE((pool.register_batch_handler<int, int>(3, options, [&](std::vector<int>& items) {
+        for (int item : items) {
+            total += item;
+        }
+        return items;
+    })));
+
+    EXPECT_FALSE(pool.post_batched<int>(9, 1));
+    EXPECT_FALSE(pool.post_batched<long>(3, 1));
+
+    // Results still reach the items that asked for one, at their own index
+    EXPECT_TRUE(pool.post_batched<int>(3, 1));
+    auto second = pool.submit_batched<int>(3, 2);
+    EXPECT_TRUE(pool.post_batched<int>(3, 3));
+    auto fourth = pool.submit_batched<int>(3, 4);
+    EXPECT_EQ(second.get(), 2);
+    EXPECT_EQ(fourth.get(), 4);
+
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(pool.post_batched<int>(3, 10));
+    }
+    EXPECT_TRUE(pool.wait_idle(std::chrono::seconds(5)));
+    EXPECT_EQ(total.load(), 50);
+    pool.shutdown_graceful();
+}
+
+TEST(ThreadPoolTest, Issue43_BatchFailuresReachEveryItem) {
+    ThreadPool pool(1);
+    BatchOptions options;
+    options.max_items = 3;
+    options.max_delay = std::chrono::hours(1);  // Only full batches run
+    ASSERT_TRUE((pool.register_batch_handler<int, int>(4, options, [](std::vector<int>& items) -> std::vector<int> {
+        if (items.front() < 0) {
+            throw std::runtime_error("bad batch");
+        }
+        return {items.front()};  // Too few results
+    })));
+
+    EXPECT_FALSE(pool.submit_batched<int>(9, 1).valid());
+    EXPECT_FALSE(pool.submit_batched<long>(4, 1).valid());
+
+    std::vector<std::future<int>> failing;
+    for (int i = 0; i < 3; ++i) {
+        failing.push_back(pool.submit_batched<int>(4, -1));
+    }
+    for (auto& future : failing) {
+        EXPECT_THROW(future.get(), std::runtime_error);
+    }
+
+    std::vector<std::future<int>> short_results;
+    for (int i = 0; i < 3; ++i) {
+        short_results.push_back(pool.submit_batched<int>(4, 10 + i));
+    }
+    EXPECT_EQ(short_results[0].get(), 10);
+    EXPECT_THROW(short_results[1].get(), std::length_error);
+    EXPECT_THROW(short_results[2].get(), std::length_error);
+    pool.shutdown_graceful();
+}
+
+TEST(ThreadPoolTest, Issue46_LateDependentOfFinishedTaskRuns) {
+    ThreadPool pool(2);
+    pool.start();
+
+    std::promise<void> first_done;
+    TaskId first = pool.submit_with_id(std::make_unique<Task>([&first_done]() { first_done.set_value(); }));
+    first_done.get_future().wait();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));  // Let it leave the worker
+
+    std::promise<void> second_done;
+    auto second_future = second_done.get_future();
+    pool.submit_with_id(std::make_unique<Task>([&second_done]() { second_done.set_value(); },
+                                               Priority::NORMAL, std::vector<TaskId>{first}));
+    EXPECT_EQ(second_future.wait_for(std::chrono::seconds(2)), std::future_status::ready);
+    pool.shutdown_graceful();
+    EXPECT_EQ(pool.get_statistics().pending_dependencies, 0);
+}
+
+TEST(ThreadPoolTest, Issue47_UpdatePriorityOfQueuedAndWaitingTasks) {
+    ThreadPool pool(1);
+    pool.start();
+
+    std::promise<void> gate;
+    std::shared_future<void> opened = gate.get_future().share();
+    pool.submit([opened]() { opened.wait(); });
+
+    std::mutex order_mutex;
+    std::vector<std::string> order;
+    auto record = [&order, &order_mutex](std::string name) {
+        return [&order, &order_mutex, name]() {
+            std::lock_guard<std::mutex> lock(order_mutex);
+            order.push_back(name);
+        };
+    };
+
+    TaskId a = pool.submit_with_id(std::make_unique<Task>(record("a"), Priority::LOW));
+    TaskId b = pool.submit_with_id(std::make_unique<Task>(record("b"), Priority::NORMAL));
+    TaskId c = pool.submit_with_id(std::make_unique<Task>(record("c"), Priority::LOW, std::vector<TaskId>{a}));
+
+    // Escalating the waiting task pulls its prerequisite ahead of b too
+    EXPECT_TRUE(pool.update_priority(c, Priority::CRITICAL));
+    EXPECT_TRUE(pool.update_deadline(b, std::chrono::steady_clock::now() + std::chrono::hours(1)));
+    EXPECT_TRUE(pool.update_priority(b, Priority::LOW));
+    EXPECT_GT(pool.get_statistics().priority_inheritance_boosts, 0);
+
+    gate.set_value();
+    pool.shutdown_graceful();
+    EXPECT_EQ(order, (std::vector<std::string>{"b", "a", "c"}));
+    EXPECT_FALSE(pool.update_priority(a, Priority::HIGH));
+}
+
+TEST(ThreadPoolTest, Issue48_WaitIdleCoversRunningAndWaitingTasks) {
+    ThreadPool pool(2);
+    pool.start();
+
+    std::atomic<int> counter{0};
+    TaskId slow = pool.submit_with_id(std::make_unique<Task>([&counter]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        counter++;
+    }));
+    for (int i = 0; i < 5; ++i) {
+        pool.submit_with_id(std::make_unique<Task>([&counter]() { counter++; },
+                                                   Priority::NORMAL, std::vector<TaskId>{slow}));
+    }
+
+    EXPECT_TRUE(pool.wait_idle());
+    EXPECT_EQ(counter.load(), 6);
+    EXPECT_TRUE(pool.wait_idle(std::chrono::milliseconds(0)));
+    pool.shutdown_graceful();
+}
+
+TEST(ThreadPoolTest, Issue48_WaitForTaskAndTimeouts) {
+    ThreadPool pool(1);
+    pool.start();
+
+    std::promise<void> gate;
+    std::shared_future<void> opened = gate.get_future().share();
+    TaskId blocker = pool.submit_with_id(std::make_unique<Task>([opened]() { opened.wait(); }));
+    std::atomic<bool> ran{false};
+    TaskId dependent = pool.submit_with_id(std::make_unique<Task>([&ran]() { ran = true; },
+                                                                  Priority::NORMAL,
+                                                                  std::vector<TaskId>{blocker}));
+
+    EXPECT_FALSE(pool.wait_for(dependent, std::chrono::milliseconds(20)));
+    EXPECT_FALSE(pool.wait_idle(std::chrono::milliseconds(20)));
+    EXPECT_FALSE(pool.wait_for(dependent + 100));
+
+    gate.set_value();
+    EXPECT_TRUE(pool.wait_for(dependent));
+    EXPECT_TRUE(ran.load());
+    EXPECT_TRUE(pool.wait_for(blocker, std::chrono::milliseconds(0)));
+    pool.shutdown_graceful();
+}
+
+TEST(ThreadPoolTest, Issue48_WaitForReturnsWhenTaskIsCancelledOrDropped) {
+    ThreadPool pool(1);
+    pool.start();
+
+    std::promise<void> gate;
+    std::shared_future<void> opened = gate.get_future().share();
+    pool.submit_with_id(std::make_unique<Task>([opened]() { opened.wait(); }));
+    TaskId cancelled = pool.submit_with_id(std::make_unique<Task>([]() {}));
+    TaskId dropped = pool.submit_with_id(std::make_unique<Task>([]() {}));
+
+    std::thread waiter([&pool, cancelled]() { EXPECT_TRUE(pool.wait_for(cancelled)); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_TRUE(pool.cancel_task(cancelled));
+    waiter.join();
+
+    std::thread shutdown_waiter([&pool, dropped]() { EXPECT_TRUE(pool.wait_for(dropped)); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    gate.set_value();
+    auto unrun = pool.shutdown_immediate();
+    shutdown_waiter.join();
+}
+
+TEST(ThreadPoolTest, Issue50_WatchdogReportsHungTaskWhileItRuns) {
+    ThreadPool pool(1);
+    WatchdogOptions options;
+    options.interval = std::chrono::milliseconds(5);
+    options.default_threshold = std::chrono::milliseconds(20);
+    options.stall_timeout = std::chrono::milliseconds(20);
+
+    std::mutex events_mutex;
+    std::vector<WatchdogEvent> events;
+    ASSERT_TRUE(pool.set_watchdog(options, [&events, &events_mutex](const WatchdogEvent& event) {
+        std::lock_guard<std::mutex> lock(events_mutex);
+        events.push_back(event);
+    }));
+    pool.start();
+    EXPECT_FALSE(pool.set_watchdog(options));
+
+    std::promise<void> gate;
+    std::shared_future<void> opened = gate.get_future().share();
+    TaskId hung = pool.submit_with_id(std::make_unique<Task>([opened]() { opened.wait(); }));
+    pool.submit_with_id(std::make_unique<Task>([]() {}));
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (pool.get_statistics().stalled_workers == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    StatisticsSnapshot snapshot = pool.get_statistics();
+    EXPECT_EQ(snapshot.longest_running_task, hung);
+    EXPECT_GE(snapshot.longest_running_task_ms, 20.0);
+    EXPECT_EQ(snapshot.long_running_tasks, 1u);
+    EXPECT_EQ(snapshot.stalled_workers, 1u);
+
+    auto states = pool.get_worker_states();
+    ASSERT_EQ(states.size(), 1u);
+    EXPECT_EQ(states[0].lane, "default");
+    EXPECT_EQ(states[0].task, hung);
+    EXPECT_EQ(states[0].lane_queue_depth, 1u);
+
+    gate.set_value();
+    pool.shutdown_graceful();
+    {
+        std::lock_guard<std::mutex> lock(events_mutex);
+        ASSERT_EQ(events.size(), 2u);
+        EXPECT_EQ(events[0].worker.task, hung);
+        EXPECT_EQ(events[1].worker.task, hung);
+    }
+    EXPECT_EQ(pool.get_statistics().longest_running_task, INVALID_TASK_ID);
+    EXPECT_EQ(pool.get_cumulative_statistics().stalled_workers, 1u);
+}
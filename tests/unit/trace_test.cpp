@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include "taskscheduler/trace_replay.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+using namespace taskscheduler;
+
+TEST(TraceTest, Issue39_RecordsSubmitsAndCompletions) {
+    TraceRecorder recorder;
+    ThreadPool pool(2);
+    pool.set_trace_recorder(&recorder);
+
+    TaskId first = pool.submit_with_id(std::make_unique<Task>([]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }, Priority::HIGH));
+    auto second = std::make_unique<Task>([]() {}, Priority::LOW, std::vector<TaskId>{first});
+    second->set_task_class(9);
+    second->set_deadline(std::chrono::steady_clock::now() + std::chrono::seconds(1));
+    TaskId second_id = pool.submit_with_id(std::move(second));
+    pool.shutdown_graceful();
+
+    auto events = recorder.events();
+    ASSERT_EQ(events.size(), 4);
+    EXPECT_EQ(recorder.event_count(), 4);
+
+    size_t submits = 0;
+    for (const auto& event : events) {
+        if (event.type == TraceEventType::SUBMIT && event.task_id == second_id) {
+            ++submits;
+            EXPECT_EQ(event.priority, Priority::LOW);
+            EXPECT_EQ(event.task_class, 9);
+            EXPECT_EQ(event.dependencies, (std::vector<TaskId>{first}));
+            ASSERT_TRUE(event.deadline_ns.has_value());
+            EXPECT_GT(event.deadline_ns.value(), 0);
+        } else if (event.type == TraceEventType::SUBMIT) {
+            ++submits;
+            EXPECT_FALSE(event.deadline_ns.has_value());
+        } else if (event.task_id == first) {
+            EXPECT_GE(event.duration_ns, 5000000);
+        }
+    }
+    EXPECT_EQ(submits, 2);
+}
+
+TEST(TraceTest, Issue39_FileRoundTrip) {
+    TraceRecorder recorder;
+    Task task([]() {}, Priority::CRITICAL, {1, 2, 3, 4, 5});
+    task.set_id(6);
+    recorder.record_submit(task);
+    recorder.record_completion(task, std::chrono::microseconds(250));
+
+    std::string path = "/tmp/taskscheduler_trace_test_" + std::to_string(::getpid()) + ".bin";
+    ASSERT_TRUE(recorder.write(path));
+    auto events = TraceRecorder::read(path);
+    std::remove(path.c_str());
+
+    ASSERT_TRUE(events.has_value());
+    ASSERT_EQ(events->size(), 2);
+    EXPECT_EQ((*events)[0].type, TraceEventType::SUBMIT);
+    EXPECT_EQ((*events)[0].task_id, 6);
+    EXPECT_EQ((*events)[0].priority, Priority::CRITICAL);
+    EXPECT_EQ((*events)[0].dependencies, (std::vector<TaskId>{1, 2, 3, 4, 5}));
+    EXPECT_EQ((*events)[1].type, TraceEventType::COMPLETE);
+    EXPECT_EQ((*events)[1].duration_ns, 250000);
+
+    EXPECT_FALSE(TraceRecorder::read("/nonexistent/trace.bin").has_value());
+}
+
+TEST(TraceTest, Issue39_ReplayReportsMakespanAndLatency) {
+    // A chain of three 5ms tasks cannot finish in under 15ms
+    TraceRecorder recorder;
+    for (TaskId id = 1; id <= 3; ++id) {
+        std::vector<TaskId> dependencies;
+        if (id > 1) {
+            dependencies.push_back(id - 1);
+        }
+        Task task([]() {}, Priority::NORMAL, dependencies);
+        task.set_id(id);
+        recorder.record_submit(task);
+        recorder.record_completion(task, std::chrono::milliseconds(5));
+    }
+
+    ThreadPool pool(2);
+    ReplayOptions options;
+    options.time_scale = 0.0;
+    ReplayReport report = replay_trace(recorder.events(), pool, options);
+    pool.shutdown_graceful();
+
+    EXPECT_EQ(report.submitted_tasks, 3);
+    EXPECT_EQ(report.completed_tasks, 3);
+    EXPECT_GE(report.makespan_ms, 15.0);
+    EXPECT_GT(report.throughput_per_second, 0.0);
+    // Each task spins for its recorded duration after it is submitted
+    double longest_ms = 0.0;
+    for (const auto& event : recorder.events()) {
+        if (event.type == TraceEventType::COMPLETE) {
+            longest_ms = std::max(longest_ms, event.duration_ns / 1e6);
+        }
+    }
+    EXPECT_EQ(longest_ms, 5.0);
+    EXPECT_GE(report.latency_max_ms, longest_ms);
+    EXPECT_LE(report.latency_max_ms, report.makespan_ms);
+    EXPECT_LE(report.latency_p50_ms, report.latency_p99_ms);
+}
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include "taskscheduler/watchdog.hpp"
+
+using namespace taskscheduler;
+
+namespace {
+
+WorkerState busy_worker(size_t worker, TaskId task, TaskClassId task_class, double running_ms,
+                        uint64_t tasks_started, size_t lane_queue_depth = 0) {
+    WorkerState state;
+    state.lane = "default";
+    state.worker = worker;
+    state.task = task;
+    state.task_class = task_class;
+    state.running_ms = running_ms;
+    state.tasks_started = tasks_started;
+    state.lane_queue_depth = lane_queue_depth;
+    return state;
+}
+
+} // namespace
+
+TEST(WatchdogTest, Issue50_FlagsTasksOverTheirClassThresholdOnce) {
+    WatchdogOptions options;
+    options.default_threshold = std::chrono::milliseconds(100);
+    options.class_thresholds[7] = std::chrono::milliseconds(1000);
+    Watchdog watchdog(options);
+
+    auto events = watchdog.check({busy_worker(0, 1, 0, 150.0, 1), busy_worker(1, 2, 7, 150.0, 1)});
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_EQ(events[0].kind, WatchdogEvent::Kind::LONG_RUNNING_TASK);
+    EXPECT_EQ(events[0].worker.task, 1u);
+
+    // Same task again is not reported twice; the next task on that worker is
+    EXPECT_TRUE(watchdog.check({busy_worker(0, 1, 0, 250.0, 1)}).empty());
+    EXPECT_EQ(watchdog.check({busy_worker(0, 3, 0, 120.0, 2)}).size(), 1u);
+    EXPECT_EQ(watchdog.check({busy_worker(1, 2, 7, 1500.0, 1)}).size(), 1u);
+}
+
+TEST(WatchdogTest, Issue50_StalledWorkerNeedsQueuedWorkOutsideBlockingRegions) {
+    WatchdogOptions options;
+    options.stall_timeout = std::chrono::milliseconds(50);
+    Watchdog watchdog(options);
+
+    EXPECT_TRUE(watchdog.check({busy_worker(0, 1, 0, 80.0, 1, 0)}).empty());
+
+    WorkerState blocked = busy_worker(0, 1, 0, 80.0, 1, 5);
+    blocked.blocking = true;
+    EXPECT_TRUE(watchdog.check({blocked}).empty());
+
+    auto events = watchdog.check({busy_worker(0, 1, 0, 90.0, 1, 5)});
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_EQ(events[0].kind, WatchdogEvent::Kind::STALLED_WORKER);
+    EXPECT_EQ(events[0].worker.lane_queue_depth, 5u);
+}
+
+TEST(WatchdogTest, Issue50_WorkerActivityReadsConsistently) {
+    WorkerActivity activity;
+    EXPECT_EQ(activity.read().task, INVALID_TASK_ID);
+
+    auto started = std::chrono::steady_clock::now();
+    activity.begin(42, 3, started);
+    activity.set_blocking(true);
+    WorkerActivity::Reading reading = activity.read();
+    EXPECT_EQ(reading.task, 42u);
+    EXPECT_EQ(reading.task_class, 3u);
+    EXPECT_EQ(reading.started, std::chrono::time_point_cast<std::chrono::nanoseconds>(started));
+    EXPECT_EQ(reading.tasks_started, 1u);
+    EXPECT_TRUE(reading.blocking);
+
+    activity.end();
+    EXPECT_EQ(activity.read().task, INVALID_TASK_ID);
+    EXPECT_EQ(activity.read().tasks_started, 1u);
+}
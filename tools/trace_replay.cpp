@@ -0,0 +1,44 @@
+// Replays a trace written by TraceRecorder against a fresh ThreadPool and
+// prints makespan, throughput and latency percentiles.
+//
+//   trace_replay <trace-file> [threads] [time-scale]
+
+#include "taskscheduler/trace_replay.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+using namespace taskscheduler;
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s <trace-file> [threads] [time-scale]\n", argv[0]);
+        return 2;
+    }
+
+    auto events = TraceRecorder::read(argv[1]);
+    if (!events.has_value()) {
+        std::fprintf(stderr, "cannot read trace %s\n", argv[1]);
+        return 1;
+    }
+
+    size_t threads = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : std::thread::hardware_concurrency();
+    ReplayOptions options;
+    if (argc > 3) {
+        options.time_scale = std::strtod(argv[3], nullptr);
+    }
+
+    ThreadPool pool(threads);
+    ReplayReport report = replay_trace(events.value(), pool, options);
+    pool.shutdown_graceful();
+
+    std::printf("tasks        %zu submitted, %zu completed\n", report.submitted_tasks, report.completed_tasks);
+    std::printf("makespan     %.3f ms\n", report.makespan_ms);
+    std::printf("throughput   %.1f tasks/s\n", report.throughput_per_second);
+    std::printf("latency p50  %.3f ms\n", report.latency_p50_ms);
+    std::printf("latency p90  %.3f ms\n", report.latency_p90_ms);
+    std::printf("latency p99  %.3f ms\n", report.latency_p99_ms);
+    std::printf("latency max  %.3f ms\n", report.latency_max_ms);
+    return report.completed_tasks == report.submitted_tasks ? 0 : 1;
+}